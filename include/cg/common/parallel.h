@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+namespace cg {
+namespace common
+{
+   // number of worker threads to use when the caller passes 0
+   inline size_t default_threads()
+   {
+      return std::max<size_t>(1, std::thread::hardware_concurrency());
+   }
+
+   // calls f(l) for every l in [begin, end), split into contiguous blocks,
+   // one block per thread. runs inline for one thread or a short range.
+   template <class F>
+   void parallel_for(size_t begin, size_t end, F f, size_t threads = 0, size_t min_block = 1)
+   {
+      if (threads == 0)
+         threads = default_threads();
+
+      size_t n = end > begin ? end - begin : 0;
+      threads = std::min(threads, std::max<size_t>(1, n / std::max<size_t>(1, min_block)));
+
+      if (threads <= 1)
+      {
+         for (size_t l = begin; l < end; ++l)
+            f(l);
+         return;
+      }
+
+      std::vector<std::thread> workers;
+      workers.reserve(threads - 1);
+
+      size_t block = (n + threads - 1) / threads;
+      for (size_t t = 1; t < threads; ++t)
+      {
+         size_t lo = std::min(end, begin + t * block), hi = std::min(end, lo + block);
+         workers.push_back(std::thread([lo, hi, &f] { for (size_t l = lo; l < hi; ++l) f(l); }));
+      }
+
+      for (size_t l = begin; l < std::min(end, begin + block); ++l)
+         f(l);
+
+      for (size_t t = 0; t != workers.size(); ++t)
+         workers[t].join();
+   }
+
+   // sorts [begin, end) by sorting one block per thread, then merging
+   // neighbouring blocks pairwise, each round of merges in parallel
+   template <class Iter, class Less>
+   void parallel_sort(Iter begin, Iter end, Less less, size_t threads = 0, size_t min_block = 1 << 14)
+   {
+      if (threads == 0)
+         threads = default_threads();
+
+      size_t n = end - begin;
+      size_t blocks = std::min(threads, std::max<size_t>(1, n / std::max<size_t>(1, min_block)));
+      if (blocks <= 1)
+      {
+         std::sort(begin, end, less);
+         return;
+      }
+
+      size_t block = (n + blocks - 1) / blocks;
+      parallel_for(0, blocks, [&] (size_t b)
+      {
+         std::sort(begin + std::min(n, b * block), begin + std::min(n, (b + 1) * block), less);
+      }, blocks);
+
+      for (size_t width = block; width < n; width *= 2)
+      {
+         parallel_for(0, (n + 2 * width - 1) / (2 * width), [&] (size_t k)
+         {
+            size_t lo = 2 * k * width, mid = std::min(n, lo + width), hi = std::min(n, lo + 2 * width);
+            std::inplace_merge(begin + lo, begin + mid, begin + hi, less);
+         }, threads);
+      }
+   }
+}}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/segment.h>
+#include <cg/primitives/triangle.h>
+#include <cg/primitives/rectangle.h>
+#include <cg/primitives/contour.h>
+#include <cg/primitives/polygon.h>
+
+namespace cg
+{
+   template <class Scalar>
+   rectangle_2t<Scalar> bounding_box(point_2t<Scalar> const & p)
+   {
+      return rectangle_2t<Scalar>(range_t<Scalar>(p.x, p.x), range_t<Scalar>(p.y, p.y));
+   }
+
+   template <class Scalar>
+   rectangle_2t<Scalar> bounding_box(segment_2t<Scalar> const & s)
+   {
+      return rectangle_2t<Scalar>(range_t<Scalar>(std::min(s[0].x, s[1].x), std::max(s[0].x, s[1].x)),
+                                  range_t<Scalar>(std::min(s[0].y, s[1].y), std::max(s[0].y, s[1].y)));
+   }
+
+   template <class Scalar>
+   rectangle_2t<Scalar> bounding_box(triangle_2t<Scalar> const & t)
+   {
+      return rectangle_2t<Scalar>(range_t<Scalar>(std::min(t[0].x, std::min(t[1].x, t[2].x)),
+                                                  std::max(t[0].x, std::max(t[1].x, t[2].x))),
+                                  range_t<Scalar>(std::min(t[0].y, std::min(t[1].y, t[2].y)),
+                                                  std::max(t[0].y, std::max(t[1].y, t[2].y))));
+   }
+
+   template <class Scalar>
+   rectangle_2t<Scalar> const & bounding_box(rectangle_2t<Scalar> const & r)
+   {
+      return r;
+   }
+
+   // empty range for empty contour
+   template <class Scalar>
+   rectangle_2t<Scalar> bounding_box(contour_2t<Scalar> const & c)
+   {
+      rectangle_2t<Scalar> res;
+
+      if (c.size() == 0)
+         return res;
+
+      res.x = range_t<Scalar>(c[0].x, c[0].x);
+      res.y = range_t<Scalar>(c[0].y, c[0].y);
+
+      for (typename contour_2t<Scalar>::const_iterator it = c.begin(); it != c.end(); ++it)
+      {
+         res.x.inf = std::min(res.x.inf, it->x);
+         res.x.sup = std::max(res.x.sup, it->x);
+         res.y.inf = std::min(res.y.inf, it->y);
+         res.y.sup = std::max(res.y.sup, it->y);
+      }
+
+      return res;
+   }
+
+   // holes lie inside the outer contour
+   template <class Scalar>
+   rectangle_2t<Scalar> bounding_box(polygon_with_holes_2t<Scalar> const & p)
+   {
+      return bounding_box(p.outer);
+   }
+
+   template <class Scalar>
+   rectangle_2t<Scalar> const operator | (rectangle_2t<Scalar> const & a, rectangle_2t<Scalar> const & b)
+   {
+      if (a.x.is_empty() || a.y.is_empty())
+         return b;
+      if (b.x.is_empty() || b.y.is_empty())
+         return a;
+
+      return rectangle_2t<Scalar>(range_t<Scalar>(std::min(a.x.inf, b.x.inf), std::max(a.x.sup, b.x.sup)),
+                                  range_t<Scalar>(std::min(a.y.inf, b.y.inf), std::max(a.y.sup, b.y.sup)));
+   }
+
+   // closed non-empty rectangles, touching counts
+   template <class Scalar>
+   bool overlap(rectangle_2t<Scalar> const & a, rectangle_2t<Scalar> const & b)
+   {
+      return a.x.inf <= b.x.sup && b.x.inf <= a.x.sup
+          && a.y.inf <= b.y.sup && b.y.inf <= a.y.sup;
+   }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <boost/numeric/interval.hpp>
+#include <gmpxx.h>
+
+#include "cg/primitives/point.h"
+#include "cg/primitives/triangle.h"
+
+namespace cg
+{
+   // center of the circle through a, b, c (not collinear). each coordinate
+   // is within 64 * epsilon * s of the exact one, s the largest magnitude of
+   // the input coordinates and of that coordinate: the middle of an
+   // interval around it, computed exactly only when the interval is wider
+   // than that, which is rare outside nearly collinear triangles.
+   inline point_2 circumcenter(point_2 const & a, point_2 const & b, point_2 const & c)
+   {
+      {
+         typedef boost::numeric::interval_lib::unprotect<boost::numeric::interval<double> >::type interval;
+
+         boost::numeric::interval<double>::traits_type::rounding _;
+         interval bx = interval(b.x) - a.x, by = interval(b.y) - a.y;
+         interval cx = interval(c.x) - a.x, cy = interval(c.y) - a.y;
+         interval den = 2. * (bx * cy - by * cx);
+
+         if (!zero_in(den))
+         {
+            interval b2 = square(bx) + square(by), c2 = square(cx) + square(cy);
+            interval x = a.x + (cy * b2 - by * c2) / den;
+            interval y = a.y + (bx * c2 - cx * b2) / den;
+
+            double const eps = 64 * std::numeric_limits<double>::epsilon();
+            double s = std::max({std::fabs(a.x), std::fabs(a.y), std::fabs(b.x), std::fabs(b.y),
+                                 std::fabs(c.x), std::fabs(c.y)});
+            if (width(x) <= eps * std::max(s, norm(x)) && width(y) <= eps * std::max(s, norm(y)))
+               return point_2(median(x), median(y));
+         }
+      }
+
+      mpq_class bx = mpq_class(b.x) - a.x, by = mpq_class(b.y) - a.y;
+      mpq_class cx = mpq_class(c.x) - a.x, cy = mpq_class(c.y) - a.y;
+      mpq_class den = 2 * (bx * cy - by * cx);
+      mpq_class b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+
+      // get_d truncates, the exact value is within one ulp
+      mpq_class x = a.x + (cy * b2 - by * c2) / den, y = a.y + (bx * c2 - cx * b2) / den;
+      return point_2(x.get_d(), y.get_d());
+   }
+
+   inline point_2 circumcenter(triangle_2 const & t)
+   {
+      return circumcenter(t[0], t[1], t[2]);
+   }
+}
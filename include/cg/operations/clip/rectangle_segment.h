@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <cg/primitives/range.h>
+#include <cg/primitives/rectangle.h>
+#include <cg/primitives/segment.h>
+#include <cg/operations/has_intersection/rectangle_segment.h>
+
+namespace cg
+{
+   namespace detail
+   {
+      // liang-barsky slab test of s against both slabs of r at once, x and y
+      // in the lanes of a register. t0 > t1 if s misses r.
+      inline void clip_slabs(rectangle_2 const & r, segment_2 const & s, double & t0, double & t1)
+      {
+         double const inf = std::numeric_limits<double>::infinity();
+#if defined(__SSE2__)
+         __m128d p = _mm_loadu_pd(&s[0].x);
+         __m128d d = _mm_sub_pd(_mm_loadu_pd(&s[1].x), p);
+         __m128d lo = _mm_sub_pd(_mm_set_pd(r.y.inf, r.x.inf), p);
+         __m128d hi = _mm_sub_pd(_mm_set_pd(r.y.sup, r.x.sup), p);
+
+         __m128d ta = _mm_div_pd(lo, d), tb = _mm_div_pd(hi, d);
+         __m128d tmin = _mm_min_pd(ta, tb), tmax = _mm_max_pd(ta, tb);
+
+         // an axis without movement constrains nothing inside its slab and everything outside
+         __m128d zero = _mm_setzero_pd();
+         __m128d still = _mm_cmpeq_pd(d, zero);
+         __m128d inside = _mm_and_pd(_mm_cmple_pd(lo, zero), _mm_cmpge_pd(hi, zero));
+         __m128d vinf = _mm_set1_pd(inf);
+
+         __m128d still_min = _mm_or_pd(_mm_and_pd(inside, _mm_xor_pd(vinf, _mm_set1_pd(-0.))), _mm_andnot_pd(inside, vinf));
+         tmin = _mm_or_pd(_mm_and_pd(still, still_min), _mm_andnot_pd(still, tmin));
+         tmax = _mm_or_pd(_mm_and_pd(still, vinf), _mm_andnot_pd(still, tmax));
+
+         double vmin[2], vmax[2];
+         _mm_storeu_pd(vmin, tmin);
+         _mm_storeu_pd(vmax, tmax);
+
+         t0 = std::max(0., std::max(vmin[0], vmin[1]));
+         t1 = std::min(1., std::min(vmax[0], vmax[1]));
+#else
+         t0 = 0;
+         t1 = 1;
+
+         double p[2] = { s[0].x, s[0].y };
+         double d[2] = { s[1].x - s[0].x, s[1].y - s[0].y };
+         double lo[2] = { r.x.inf - p[0], r.y.inf - p[1] };
+         double hi[2] = { r.x.sup - p[0], r.y.sup - p[1] };
+
+         for (size_t k = 0; k != 2; ++k)
+         {
+            if (d[k] == 0)
+            {
+               if (lo[k] > 0 || hi[k] < 0)
+                  t0 = inf;
+               continue;
+            }
+
+            double ta = lo[k] / d[k], tb = hi[k] / d[k];
+            t0 = std::max(t0, std::min(ta, tb));
+            t1 = std::min(t1, std::max(ta, tb));
+         }
+#endif
+      }
+   }
+
+   // parameter range of the part of s inside the closed rectangle r,
+   // s(t) = s[0] + t (s[1] - s[0]). the range is empty iff s misses r,
+   // this decision is exact: slab tests too close to call fall back to
+   // has_intersection(r, s), grazing contacts get a single parameter.
+   inline range clip(rectangle_2 const & r, segment_2 const & s)
+   {
+      if (r.x.is_empty() || r.y.is_empty())
+         return range();
+
+      double t0, t1;
+      detail::clip_slabs(r, s, t0, t1);
+
+      double const tol = 16 * std::numeric_limits<double>::epsilon();
+      if (t1 - t0 > tol)
+         return range(t0, t1);
+
+      if (t0 - t1 > tol || !has_intersection(r, s))
+         return range();
+
+      double t = std::min(1., std::max(0., (t0 + t1) / 2));
+      return range(std::min(t0, t), std::max(t1, t));
+   }
+
+   // clips every segment of [first, last) by r, writes one range per segment
+   template <class InputIter, class OutputIter>
+   OutputIter clip(rectangle_2 const & r, InputIter first, InputIter last, OutputIter out)
+   {
+      for (; first != last; ++first)
+         *out++ = clip(r, *first);
+
+      return out;
+   }
+
+   // writes has_intersection(r, s) for every segment of [first, last)
+   template <class InputIter, class OutputIter>
+   OutputIter has_intersection(rectangle_2 const & r, InputIter first, InputIter last, OutputIter out)
+   {
+      for (; first != last; ++first)
+         *out++ = !clip(r, *first).is_empty();
+
+      return out;
+   }
+}
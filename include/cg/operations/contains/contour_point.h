@@ -65,4 +65,15 @@ namespace cg
 
       return num_intersections % 2;
    }
+
+   // q lies on one of the contour edges
+   template<typename Scalar>
+   bool on_boundary(contour_2t<Scalar> const & c, point_2t<Scalar> const & q)
+   {
+      for (size_t pr = c.vertices_num() - 1, cur = 0; cur != c.vertices_num(); pr = cur++)
+         if (contains(segment_2t<Scalar>(c[pr], c[cur]), q))
+            return true;
+
+      return false;
+   }
 }
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include <cg/primitives/contour.h>
+#include <cg/primitives/point.h>
+#include <cg/operations/orientation.h>
+#include <cg/operations/contains/contour_point.h>
+
+namespace cg
+{
+   // prebuilt convex_contains for one ccw convex contour.
+   // the fan around c[0] is bucketed by pseudo-angle, a query does a table lookup
+   // and a search over the few fan vertices of its bucket. buckets only narrow
+   // the search range, every decision is made by orientation, so the answer is
+   // exactly convex_contains(c, q).
+   struct convex_locator
+   {
+      explicit convex_locator(contour_2 const & c, size_t buckets = 0)
+         : c_(c)
+      {
+         size_t n = c_.size();
+         if (n < 3)
+            return;
+
+         ux_ = c_[1].x - c_[0].x;
+         uy_ = c_[1].y - c_[0].y;
+
+         // rounding may break monotonicity of nearly collinear rays, the table is only a hint
+         std::vector<double> angle(n);
+         for (size_t l = 1; l != n; ++l)
+            angle[l] = std::max(pseudo_angle(c_[l]), angle[l - 1]);
+
+         if (buckets == 0)
+            buckets = n;
+
+         amin_ = angle[1];
+         scale_ = (angle[n - 1] > amin_) ? buckets / (angle[n - 1] - amin_) : 0;
+         if (scale_ == 0)
+            buckets = 1;
+
+         lo_.resize(buckets);
+         hi_.resize(buckets);
+
+         double const slack = 1e-12;
+         for (size_t b = 0; b != buckets; ++b)
+         {
+            double t0 = (scale_ == 0) ? 0 : amin_ + b / scale_;
+            double t1 = (scale_ == 0) ? 2 : amin_ + (b + 1) / scale_;
+
+            lo_[b] = std::lower_bound(angle.begin() + 2, angle.end(), t0 - slack) - angle.begin();
+            hi_[b] = std::upper_bound(angle.begin() + 2, angle.end(), t1 + slack) - angle.begin();
+         }
+      }
+
+      bool contains(point_2 const & q) const
+      {
+         size_t n = c_.size();
+         if (n < 3)
+            return convex_contains(c_, q);
+
+         if (orientation(c_[0], c_[1], q) == CG_RIGHT)
+            return false;
+
+         left_of_ray pred(c_[0]);
+         contour_2::const_iterator it;
+
+         size_t b = bucket(q);
+         size_t lo = std::max<size_t>(lo_[b], 3) - 1;
+         size_t hi = std::min<size_t>(hi_[b] + 1, n);
+
+         it = std::lower_bound(c_.begin() + lo, c_.begin() + hi, q, pred);
+
+         bool certain = (lo == 2 || it != c_.begin() + lo)
+                     && (hi == n || it != c_.begin() + hi);
+         if (!certain)
+            it = std::lower_bound(c_.begin() + 2, c_.end(), q, pred);
+
+         if (it == c_.end()) // out
+            return false;
+
+         return orientation(*(it - 1), *it, q) != CG_RIGHT;
+      }
+
+      contour_2 const & contour() const { return c_; }
+
+   private:
+      struct left_of_ray
+      {
+         explicit left_of_ray(point_2 const & o) : o(o) {}
+
+         bool operator () (point_2 const & a, point_2 const & b) const
+         {
+            return orientation(o, a, b) == CG_LEFT;
+         }
+
+         point_2 const & o;
+      };
+
+      // monotone in the ccw angle from c[1] - c[0], maps [0, pi] to [0, 2]
+      double pseudo_angle(point_2 const & p) const
+      {
+         double wx = p.x - c_[0].x, wy = p.y - c_[0].y;
+         double a = wx * ux_ + wy * uy_;
+         double b = ux_ * wy - uy_ * wx;
+
+         double den = std::fabs(a) + std::fabs(b);
+         if (den == 0)
+            return 0;
+
+         if (b < 0)
+            return a > 0 ? 0 : 2;
+
+         return 1 - a / den;
+      }
+
+      size_t bucket(point_2 const & q) const
+      {
+         double t = (pseudo_angle(q) - amin_) * scale_;
+         if (!(t > 0))
+            return 0;
+
+         return std::min(size_t(t), lo_.size() - 1);
+      }
+
+      contour_2 c_;
+
+      double ux_, uy_;
+      double amin_, scale_;
+      std::vector<uint32_t> lo_, hi_;
+   };
+}
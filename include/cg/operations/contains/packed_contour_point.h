@@ -0,0 +1,256 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <cg/primitives/contour.h>
+#include <cg/primitives/point.h>
+#include <cg/operations/orientation.h>
+
+namespace cg
+{
+   // contour edges in structure-of-arrays layout for the crossing number kernel.
+   // every edge is stored bottom-up (y0 <= y1), horizontal edges keep contour order,
+   // exactly as contains(contour_2t, point_2t) normalizes them.
+   struct packed_contour_2
+   {
+      packed_contour_2()
+         : ymin_(std::numeric_limits<double>::max())
+         , ymax_(-std::numeric_limits<double>::max())
+      {}
+
+      explicit packed_contour_2(contour_2 const & c)
+      {
+         assign(c);
+      }
+
+      void assign(contour_2 const & c)
+      {
+         size_t n = c.size();
+
+         x0_.resize(n); y0_.resize(n);
+         x1_.resize(n); y1_.resize(n);
+
+         ymin_ = std::numeric_limits<double>::max();
+         ymax_ = -std::numeric_limits<double>::max();
+
+         for (size_t pr = n - 1, cur = 0; cur != n; pr = cur++)
+         {
+            point_2 lo = c[pr], hi = c[cur];
+            if (lo.y > hi.y)
+               std::swap(lo, hi);
+
+            x0_[cur] = lo.x; y0_[cur] = lo.y;
+            x1_[cur] = hi.x; y1_[cur] = hi.y;
+
+            ymin_ = std::min(ymin_, lo.y);
+            ymax_ = std::max(ymax_, hi.y);
+         }
+      }
+
+      size_t size() const { return x0_.size(); }
+
+      point_2 lower(size_t edge) const { return point_2(x0_[edge], y0_[edge]); }
+      point_2 upper(size_t edge) const { return point_2(x1_[edge], y1_[edge]); }
+
+      double const * x0() const { return x0_.data(); }
+      double const * y0() const { return y0_.data(); }
+      double const * x1() const { return x1_.data(); }
+      double const * y1() const { return y1_.data(); }
+
+      double ymin() const { return ymin_; }
+      double ymax() const { return ymax_; }
+
+   private:
+      std::vector<double> x0_, y0_, x1_, y1_;
+      double ymin_, ymax_;
+   };
+
+   namespace detail
+   {
+      // exact treatment of one edge, same logic as contains(contour_2t, point_2t).
+      // returns true if q is on the edge, adds crossing to num_intersections otherwise.
+      inline bool packed_edge_exact(packed_contour_2 const & c, size_t edge, point_2 const & q,
+                                    size_t & num_intersections)
+      {
+         point_2 min_point = c.lower(edge);
+         point_2 max_point = c.upper(edge);
+
+         orientation_t orient = orientation(min_point, max_point, q);
+         if (orient == CG_COLLINEAR && std::min(min_point, max_point) <= q && q <= std::max(min_point, max_point))
+            return true;
+
+         if (max_point.y <= q.y || min_point.y > q.y)
+            return false;
+
+         if (orient == CG_LEFT)
+            num_intersections++;
+
+         return false;
+      }
+
+      // orientation_d filter of q against all edges. crossings counts certain left
+      // turns of spanning edges, uncertain counts spanning edges the filter can not decide.
+      inline void packed_edges_filter(packed_contour_2 const & c, point_2 const & q,
+                                      size_t & crossings, size_t & uncertain)
+      {
+         double const * x0 = c.x0();
+         double const * y0 = c.y0();
+         double const * x1 = c.x1();
+         double const * y1 = c.y1();
+
+         size_t l = 0, n = c.size();
+         double const k = 8 * std::numeric_limits<double>::epsilon();
+
+#if defined(__AVX__)
+         __m256d const qx = _mm256_set1_pd(q.x), qy = _mm256_set1_pd(q.y), vk = _mm256_set1_pd(k);
+         __m256d const sign = _mm256_set1_pd(-0.), one = _mm256_set1_pd(1.);
+         __m256d cr = _mm256_setzero_pd(), un = _mm256_setzero_pd();
+
+         for (; l + 4 <= n; l += 4)
+         {
+            __m256d a0 = _mm256_loadu_pd(x0 + l), b0 = _mm256_loadu_pd(y0 + l);
+            __m256d a1 = _mm256_loadu_pd(x1 + l), b1 = _mm256_loadu_pd(y1 + l);
+
+            __m256d lhs = _mm256_mul_pd(_mm256_sub_pd(a1, a0), _mm256_sub_pd(qy, b0));
+            __m256d rhs = _mm256_mul_pd(_mm256_sub_pd(b1, b0), _mm256_sub_pd(qx, a0));
+            __m256d res = _mm256_sub_pd(lhs, rhs);
+            __m256d eps = _mm256_mul_pd(_mm256_add_pd(_mm256_andnot_pd(sign, lhs), _mm256_andnot_pd(sign, rhs)), vk);
+
+            __m256d left    = _mm256_cmp_pd(res, eps, _CMP_GT_OQ);
+            __m256d decided = _mm256_or_pd(left, _mm256_cmp_pd(res, _mm256_xor_pd(eps, sign), _CMP_LT_OQ));
+            __m256d in_span = _mm256_and_pd(_mm256_cmp_pd(b0, qy, _CMP_LE_OQ), _mm256_cmp_pd(qy, b1, _CMP_LE_OQ));
+            __m256d below   = _mm256_cmp_pd(qy, b1, _CMP_LT_OQ);
+
+            cr = _mm256_add_pd(cr, _mm256_and_pd(_mm256_and_pd(in_span, below), _mm256_and_pd(left, one)));
+            un = _mm256_add_pd(un, _mm256_and_pd(_mm256_andnot_pd(decided, in_span), one));
+         }
+
+         double vcr[4], vun[4];
+         _mm256_storeu_pd(vcr, cr);
+         _mm256_storeu_pd(vun, un);
+         crossings += size_t(vcr[0] + vcr[1] + vcr[2] + vcr[3]);
+         uncertain += size_t(vun[0] + vun[1] + vun[2] + vun[3]);
+#elif defined(__SSE2__)
+         __m128d const qx = _mm_set1_pd(q.x), qy = _mm_set1_pd(q.y), vk = _mm_set1_pd(k);
+         __m128d const sign = _mm_set1_pd(-0.), one = _mm_set1_pd(1.);
+         __m128d cr = _mm_setzero_pd(), un = _mm_setzero_pd();
+
+         for (; l + 2 <= n; l += 2)
+         {
+            __m128d a0 = _mm_loadu_pd(x0 + l), b0 = _mm_loadu_pd(y0 + l);
+            __m128d a1 = _mm_loadu_pd(x1 + l), b1 = _mm_loadu_pd(y1 + l);
+
+            __m128d lhs = _mm_mul_pd(_mm_sub_pd(a1, a0), _mm_sub_pd(qy, b0));
+            __m128d rhs = _mm_mul_pd(_mm_sub_pd(b1, b0), _mm_sub_pd(qx, a0));
+            __m128d res = _mm_sub_pd(lhs, rhs);
+            __m128d eps = _mm_mul_pd(_mm_add_pd(_mm_andnot_pd(sign, lhs), _mm_andnot_pd(sign, rhs)), vk);
+
+            __m128d left    = _mm_cmpgt_pd(res, eps);
+            __m128d decided = _mm_or_pd(left, _mm_cmplt_pd(res, _mm_xor_pd(eps, sign)));
+            __m128d in_span = _mm_and_pd(_mm_cmple_pd(b0, qy), _mm_cmple_pd(qy, b1));
+            __m128d below   = _mm_cmplt_pd(qy, b1);
+
+            cr = _mm_add_pd(cr, _mm_and_pd(_mm_and_pd(in_span, below), _mm_and_pd(left, one)));
+            un = _mm_add_pd(un, _mm_and_pd(_mm_andnot_pd(decided, in_span), one));
+         }
+
+         double vcr[2], vun[2];
+         _mm_storeu_pd(vcr, cr);
+         _mm_storeu_pd(vun, un);
+         crossings += size_t(vcr[0] + vcr[1]);
+         uncertain += size_t(vun[0] + vun[1]);
+#endif
+         for (; l < n; ++l)
+         {
+            double lhs = (x1[l] - x0[l]) * (q.y - y0[l]);
+            double rhs = (y1[l] - y0[l]) * (q.x - x0[l]);
+            double res = lhs - rhs;
+            double eps = (std::fabs(lhs) + std::fabs(rhs)) * k;
+
+            int in_span = (y0[l] <= q.y) & (q.y <= y1[l]);
+            int left    = res > eps;
+            int decided = left | (res < -eps);
+
+            crossings += in_span & (q.y < y1[l]) & left;
+            uncertain += in_span & (decided ^ 1);
+         }
+      }
+   }
+
+   // crossing number test with the orientation_d filter evaluated for several
+   // edges per simd lane. only edges whose filter is inconclusive are passed
+   // to the staged orientation predicate, so the answer is the same as
+   // contains(contour_2t, point_2t) for the source contour.
+   inline bool contains(packed_contour_2 const & c, point_2 const & q)
+   {
+      size_t n = c.size();
+
+      if (n == 0 || q.y < c.ymin() || q.y > c.ymax())
+         return false;
+
+      size_t crossings = 0, uncertain = 0;
+      detail::packed_edges_filter(c, q, crossings, uncertain);
+
+      if (uncertain == 0)
+         return crossings % 2;
+
+      double const k = 8 * std::numeric_limits<double>::epsilon();
+
+      for (size_t l = 0; l != n; ++l)
+      {
+         point_2 lo = c.lower(l), hi = c.upper(l);
+         if (lo.y > q.y || q.y > hi.y)
+            continue;
+
+         double lhs = (hi.x - lo.x) * (q.y - lo.y);
+         double rhs = (hi.y - lo.y) * (q.x - lo.x);
+         double res = lhs - rhs;
+         double eps = (std::fabs(lhs) + std::fabs(rhs)) * k;
+
+         if (res > eps || res < -eps)
+            continue;
+
+         if (detail::packed_edge_exact(c, l, q, crossings))
+            return true;
+      }
+
+      return crossings % 2;
+   }
+
+   // many points against one contour, writes one bool per point
+   template <class InputIter, class OutputIter>
+   OutputIter contains(packed_contour_2 const & c, InputIter p, InputIter q, OutputIter out)
+   {
+      for (; p != q; ++p)
+         *out++ = contains(c, *p);
+
+      return out;
+   }
+
+   inline bool on_boundary(packed_contour_2 const & c, point_2 const & q)
+   {
+      if (c.size() == 0 || q.y < c.ymin() || q.y > c.ymax())
+         return false;
+
+      for (size_t l = 0; l != c.size(); ++l)
+      {
+         if (c.y0()[l] > q.y || q.y > c.y1()[l])
+            continue;
+
+         point_2 lo = c.lower(l), hi = c.upper(l);
+         if (orientation(lo, hi, q) == CG_COLLINEAR && collinear_are_ordered_along_line(lo, q, hi))
+            return true;
+      }
+
+      return false;
+   }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cg/primitives/polygon.h>
+#include <cg/primitives/point.h>
+#include <cg/operations/contains/contour_point.h>
+
+namespace cg
+{
+   // closed polygon: points on the outer contour and on hole contours are inside
+   template<typename Scalar>
+   bool contains(polygon_with_holes_2t<Scalar> const & p, point_2t<Scalar> const & q)
+   {
+      if (!contains(p.outer, q))
+         return false;
+
+      for (size_t l = 0; l != p.holes.size(); ++l)
+         if (contains(p.holes[l], q) && !on_boundary(p.holes[l], q))
+            return false;
+
+      return true;
+   }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <cg/primitives/segment.h>
+#include <cg/primitives/triangle.h>
+#include <cg/primitives/rectangle.h>
+#include <cg/operations/bounding_box.h>
+#include <cg/operations/has_intersection/segment_segment.h>
+#include <cg/operations/has_intersection/triangle_segment.h>
+#include <cg/operations/has_intersection/rectangle_segment.h>
+
+namespace cg
+{
+   namespace detail
+   {
+#if defined(__SSE2__)
+      // bounding box with x and y in the two lanes of a register
+      struct lane_box
+      {
+         __m128d lo, hi;
+      };
+
+      inline __m128d lanes(point_2 const & p)
+      {
+         return _mm_loadu_pd(&p.x);
+      }
+
+      inline lane_box lane_bounding_box(segment_2 const & s)
+      {
+         __m128d a = lanes(s[0]), b = lanes(s[1]);
+         lane_box res = { _mm_min_pd(a, b), _mm_max_pd(a, b) };
+         return res;
+      }
+
+      inline lane_box lane_bounding_box(triangle_2 const & t)
+      {
+         __m128d a = lanes(t[0]), b = lanes(t[1]), c = lanes(t[2]);
+         lane_box res = { _mm_min_pd(_mm_min_pd(a, b), c), _mm_max_pd(_mm_max_pd(a, b), c) };
+         return res;
+      }
+
+      inline lane_box lane_bounding_box(rectangle_2 const & r)
+      {
+         __m128d x = _mm_set_pd(r.x.sup, r.x.inf), y = _mm_set_pd(r.y.sup, r.y.inf);
+         lane_box res = { _mm_unpacklo_pd(x, y), _mm_unpackhi_pd(x, y) };
+         return res;
+      }
+
+      inline bool lane_disjoint(lane_box const & a, lane_box const & b)
+      {
+         return _mm_movemask_pd(_mm_or_pd(_mm_cmplt_pd(a.hi, b.lo), _mm_cmplt_pd(b.hi, a.lo))) != 0;
+      }
+#else
+      typedef rectangle_2 lane_box;
+
+      template <class Primitive>
+      lane_box lane_bounding_box(Primitive const & p)
+      {
+         return bounding_box(p);
+      }
+
+      inline bool lane_disjoint(lane_box const & a, lane_box const & b)
+      {
+         return !overlap(a, b);
+      }
+#endif
+   }
+
+   // one segment against a range of segments, triangles or rectangles,
+   // writes has_intersection(item, s) for every item. boxes are compared
+   // in simd lanes first, only items with an overlapping box reach the exact predicate.
+   template <class InputIter, class OutputIter>
+   OutputIter has_intersection(segment_2 const & s, InputIter first, InputIter last, OutputIter out)
+   {
+      detail::lane_box box = detail::lane_bounding_box(s);
+
+      for (; first != last; ++first)
+         *out++ = !detail::lane_disjoint(box, detail::lane_bounding_box(*first)) && has_intersection(*first, s);
+
+      return out;
+   }
+
+   // positions in [first, last) of the items intersecting s, in ascending order
+   template <class InputIter, class OutputIter>
+   OutputIter intersecting(segment_2 const & s, InputIter first, InputIter last, OutputIter out)
+   {
+      detail::lane_box box = detail::lane_bounding_box(s);
+
+      for (size_t idx = 0; first != last; ++first, ++idx)
+         if (!detail::lane_disjoint(box, detail::lane_bounding_box(*first)) && has_intersection(*first, s))
+            *out++ = idx;
+
+      return out;
+   }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cg/primitives/rectangle.h>
+#include <cg/operations/bounding_box.h>
+
+namespace cg
+{
+   // closed rectangles, an empty rectangle intersects nothing
+   template <class Scalar>
+   bool has_intersection(rectangle_2t<Scalar> const & a, rectangle_2t<Scalar> const & b)
+   {
+      if (a.x.is_empty() || a.y.is_empty() || b.x.is_empty() || b.y.is_empty())
+         return false;
+
+      return overlap(a, b);
+   }
+}
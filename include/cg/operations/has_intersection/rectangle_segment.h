@@ -4,12 +4,15 @@
 #include <cg/primitives/segment.h>
 
 #include <cg/operations/has_intersection/segment_segment.h>
+#include <cg/operations/bounding_box.h>
 
 namespace cg
 {
 	template<class Scalar>
 	bool has_intersection(rectangle_2t<Scalar> const& r, segment_2t<Scalar> const& s)
 	{
+		if (r.x.is_empty() || r.y.is_empty() || !overlap(r, bounding_box(s)))
+			return false;
 		if (r.contains(s[0]) || r.contains(s[1]))
 			return true;
 		point_2t<Scalar> max_point = s[0];
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cg/primitives/rectangle.h>
+#include <cg/primitives/triangle.h>
+
+#include <cg/operations/bounding_box.h>
+#include <cg/operations/contains/triangle_point.h>
+#include <cg/operations/has_intersection/rectangle_segment.h>
+
+namespace cg
+{
+   template <class Scalar>
+   bool has_intersection(rectangle_2t<Scalar> const & r, triangle_2t<Scalar> const & t)
+   {
+      if (r.x.is_empty() || r.y.is_empty() || !overlap(r, bounding_box(t)))
+         return false;
+
+      for (size_t l = 0; l != 3; ++l)
+         if (has_intersection(r, t.side(l)))
+            return true;
+
+      // no side meets the rectangle, so it is either inside the triangle or apart
+      return contains(t, r.corner(0, 0));
+   }
+}
@@ -3,12 +3,17 @@
 #include <cg/primitives/segment.h>
 #include <cg/operations/contains/segment_point.h>
 #include <cg/operations/orientation.h>
+#include <cg/operations/bounding_box.h>
 
 namespace cg
 {
    template<class Scalar>
    bool has_intersection(segment_2t<Scalar> const & a, segment_2t<Scalar> const & b)
    {
+      // most pairs are far apart, comparing boxes is exact and much cheaper than orientation
+      if (!overlap(bounding_box(a), bounding_box(b)))
+         return false;
+
       if (a[0] == a[1])
          return contains(b, a[0]);
 
@@ -5,12 +5,16 @@
 
 #include <cg/operations/contains/triangle_point.h>
 #include <cg/operations/has_intersection/segment_segment.h>
+#include <cg/operations/bounding_box.h>
 
 namespace cg
 {
    template<class Scalar>
    bool has_intersection(triangle_2t<Scalar> const & t, segment_2t<Scalar> const & s)
    {
+      if (!overlap(bounding_box(t), bounding_box(s)))
+         return false;
+
       if (contains(t, s[0]))
          return true;
 
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+#include <boost/numeric/interval.hpp>
+#include <boost/optional.hpp>
+#include <gmpxx.h>
+
+#include "cg/primitives/point.h"
+
+namespace cg
+{
+   enum in_circle_t
+   {
+      CG_OUTSIDE = -1,
+      CG_COCIRCULAR = 0,
+      CG_INSIDE = 1
+   };
+
+   // position of d with respect to the circle through a, b, c (ccw),
+   // the sign of
+   //    | ax - dx   ay - dy   (ax - dx)^2 + (ay - dy)^2 |
+   //    | bx - dx   by - dy   (bx - dx)^2 + (by - dy)^2 |
+   //    | cx - dx   cy - dy   (cx - dx)^2 + (cy - dy)^2 |
+   struct in_circle_d
+   {
+      boost::optional<in_circle_t> operator() (point_2 const & a, point_2 const & b, point_2 const & c, point_2 const & d) const
+      {
+         double adx = a.x - d.x, ady = a.y - d.y;
+         double bdx = b.x - d.x, bdy = b.y - d.y;
+         double cdx = c.x - d.x, cdy = c.y - d.y;
+
+         double bc = bdx * cdy, cb = cdx * bdy;
+         double ca = cdx * ady, ac = adx * cdy;
+         double ab = adx * bdy, ba = bdx * ady;
+
+         double alift = adx * adx + ady * ady;
+         double blift = bdx * bdx + bdy * bdy;
+         double clift = cdx * cdx + cdy * cdy;
+
+         double res = alift * (bc - cb) + blift * (ca - ac) + clift * (ab - ba);
+         double permanent = (fabs(bc) + fabs(cb)) * alift + (fabs(ca) + fabs(ac)) * blift + (fabs(ab) + fabs(ba)) * clift;
+         double eps = permanent * 16 * std::numeric_limits<double>::epsilon();
+
+         if (res > eps)
+            return CG_INSIDE;
+
+         if (res < -eps)
+            return CG_OUTSIDE;
+
+         return boost::none;
+      }
+   };
+
+   struct in_circle_i
+   {
+      boost::optional<in_circle_t> operator() (point_2 const & a, point_2 const & b, point_2 const & c, point_2 const & d) const
+      {
+         typedef boost::numeric::interval_lib::unprotect<boost::numeric::interval<double> >::type interval;
+
+         boost::numeric::interval<double>::traits_type::rounding _;
+         interval adx = interval(a.x) - d.x, ady = interval(a.y) - d.y;
+         interval bdx = interval(b.x) - d.x, bdy = interval(b.y) - d.y;
+         interval cdx = interval(c.x) - d.x, cdy = interval(c.y) - d.y;
+
+         interval res =   (square(adx) + square(ady)) * (bdx * cdy - cdx * bdy)
+                        + (square(bdx) + square(bdy)) * (cdx * ady - adx * cdy)
+                        + (square(cdx) + square(cdy)) * (adx * bdy - bdx * ady);
+
+         if (res.lower() > 0)
+            return CG_INSIDE;
+
+         if (res.upper() < 0)
+            return CG_OUTSIDE;
+
+         if (res.upper() == res.lower())
+            return CG_COCIRCULAR;
+
+         return boost::none;
+      }
+   };
+
+   struct in_circle_r
+   {
+      boost::optional<in_circle_t> operator() (point_2 const & a, point_2 const & b, point_2 const & c, point_2 const & d) const
+      {
+         mpq_class adx = mpq_class(a.x) - d.x, ady = mpq_class(a.y) - d.y;
+         mpq_class bdx = mpq_class(b.x) - d.x, bdy = mpq_class(b.y) - d.y;
+         mpq_class cdx = mpq_class(c.x) - d.x, cdy = mpq_class(c.y) - d.y;
+
+         mpq_class res =   (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy)
+                         + (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy)
+                         + (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+
+         int cres = sgn(res);
+
+         if (cres > 0)
+            return CG_INSIDE;
+
+         if (cres < 0)
+            return CG_OUTSIDE;
+
+         return CG_COCIRCULAR;
+      }
+   };
+
+   inline in_circle_t in_circle(point_2 const & a, point_2 const & b, point_2 const & c, point_2 const & d)
+   {
+      if (boost::optional<in_circle_t> v = in_circle_d()(a, b, c, d))
+         return *v;
+
+      if (boost::optional<in_circle_t> v = in_circle_i()(a, b, c, d))
+         return *v;
+
+      return *in_circle_r()(a, b, c, d);
+   }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+
+#include <boost/optional.hpp>
+#include <boost/variant.hpp>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/segment.h>
+#include <cg/primitives/lazy_point.h>
+#include <cg/operations/orientation.h>
+#include <cg/operations/has_intersection/segment_segment.h>
+
+namespace cg
+{
+   namespace detail
+   {
+      inline point_2 crossing_point(segment_2 const & a, segment_2 const & b, point_2 *)
+      {
+         return lazy_point_2(a, b).rounded();
+      }
+
+      inline lazy_point_2 crossing_point(segment_2 const & a, segment_2 const & b, lazy_point_2 *)
+      {
+         return lazy_point_2(a, b);
+      }
+
+      template <class Point>
+      boost::optional<boost::variant<Point, segment_2> > intersection(segment_2 const & a, segment_2 const & b)
+      {
+         typedef boost::variant<Point, segment_2> result_t;
+
+         if (!has_intersection(a, b))
+            return boost::none;
+
+         if (a[0] == a[1])
+            return result_t(Point(a[0]));
+
+         if (b[0] == b[1])
+            return result_t(Point(b[0]));
+
+         orientation_t b0 = orientation(a[0], a[1], b[0]);
+         orientation_t b1 = orientation(a[0], a[1], b[1]);
+
+         // overlap of collinear segments, from the larger minimum to the smaller maximum
+         if (b0 == CG_COLLINEAR && b1 == CG_COLLINEAR)
+         {
+            point_2 lo = std::max(min(a), min(b));
+            point_2 hi = std::min(max(a), max(b));
+
+            if (lo == hi)
+               return result_t(Point(lo));
+
+            return result_t(segment_2(lo, hi));
+         }
+
+         // a single common point, which is an input point if any endpoint is on the other line
+         if (b0 == CG_COLLINEAR)
+            return result_t(Point(b[0]));
+         if (b1 == CG_COLLINEAR)
+            return result_t(Point(b[1]));
+
+         for (size_t l = 0; l != 2; ++l)
+            if (orientation(b[0], b[1], a[l]) == CG_COLLINEAR)
+               return result_t(Point(a[l]));
+
+         return result_t(crossing_point(a, b, static_cast<Point *>(0)));
+      }
+   }
+
+   // common part of two segments: none, a point or the overlap of collinear segments.
+   // the result of has_intersection is exact, as are all points taken from the input,
+   // a constructed crossing point has coordinates within one ulp of the exact ones
+   // (interval arithmetic first, rational arithmetic only if the interval is wider).
+   inline boost::optional<boost::variant<point_2, segment_2> > intersection(segment_2 const & a, segment_2 const & b)
+   {
+      return detail::intersection<point_2>(a, b);
+   }
+
+   // the same with the crossing point kept as a lazy exact number, so that
+   // predicates on it (orientation, compare) stay consistent with each other
+   inline boost::optional<boost::variant<lazy_point_2, segment_2> > lazy_intersection(segment_2 const & a, segment_2 const & b)
+   {
+      return detail::intersection<lazy_point_2>(a, b);
+   }
+}
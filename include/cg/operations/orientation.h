@@ -2,6 +2,7 @@
 
 #include "cg/primitives/point.h"
 #include "cg/primitives/contour.h"
+#include "cg/primitives/lazy_point.h"
 #include <boost/numeric/interval.hpp>
 #include <gmpxx.h>
 
@@ -96,6 +97,44 @@ namespace cg
       return *orientation_r()(a, b, c);
    }
 
+   // filtered on the box of c, exact coordinates of c only if the box is not enough
+   inline orientation_t orientation(point_2 const & a, point_2 const & b, lazy_point_2 const & c)
+   {
+      if (!c.constructed())
+      {
+         if (c.approx == a || c.approx == b)
+            return CG_COLLINEAR;
+
+         return orientation(a, b, c.approx);
+      }
+
+      if (c.on_source(a, b))
+         return CG_COLLINEAR;
+
+      typedef boost::numeric::interval_lib::unprotect<boost::numeric::interval<double> >::type interval;
+
+      {
+         boost::numeric::interval<double>::traits_type::rounding _;
+
+         interval cx(c.box.x.inf, c.box.x.sup), cy(c.box.y.inf, c.box.y.sup);
+         interval res =   (interval(b.x) - a.x) * (cy - a.y)
+                        - (interval(b.y) - a.y) * (cx - a.x);
+
+         if (res.lower() > 0)
+            return CG_LEFT;
+
+         if (res.upper() < 0)
+            return CG_RIGHT;
+      }
+
+      lazy_point_2::exact_t const & e = c.exact();
+      mpq_class res =   (mpq_class(b.x) - a.x) * (e.second - a.y)
+                      - (mpq_class(b.y) - a.y) * (e.first - a.x);
+
+      int cres = sgn(res);
+      return cres > 0 ? CG_LEFT : (cres < 0 ? CG_RIGHT : CG_COLLINEAR);
+   }
+
    inline bool counterclockwise(contour_2 const & c)
    {
       if (c.size() < 3) return true;
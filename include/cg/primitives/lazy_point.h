@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include <boost/numeric/interval.hpp>
+#include <gmpxx.h>
+
+#include "point.h"
+#include "segment.h"
+#include "rectangle.h"
+
+namespace cg
+{
+   // constructed point: an input point, or the crossing point of two segments.
+   // known as a box of doubles around approx, the exact rational coordinates
+   // are computed only when the box is not enough and shared between copies,
+   // so predicates on the same point pay for gmp at most once.
+   struct lazy_point_2
+   {
+      typedef std::pair<mpq_class, mpq_class> exact_t;
+
+      point_2 approx;
+      rectangle_2 box;
+
+      lazy_point_2()
+         : box(range(0, 0), range(0, 0))
+         , constructed_(false)
+      {}
+
+      explicit lazy_point_2(point_2 const & p)
+         : approx(p)
+         , box(range(p.x, p.x), range(p.y, p.y))
+         , constructed_(false)
+      {}
+
+      // crossing point of two non-parallel segments
+      lazy_point_2(segment_2 const & a, segment_2 const & b)
+         : a_(a)
+         , b_(b)
+         , constructed_(true)
+      {
+         typedef boost::numeric::interval_lib::unprotect<boost::numeric::interval<double> >::type interval;
+
+         {
+            boost::numeric::interval<double>::traits_type::rounding _;
+
+            interval dax = interval(a[1].x) - a[0].x, day = interval(a[1].y) - a[0].y;
+            interval dbx = interval(b[1].x) - b[0].x, dby = interval(b[1].y) - b[0].y;
+            interval den = dax * dby - day * dbx;
+
+            if (!zero_in(den))
+            {
+               interval t = ((interval(b[0].x) - a[0].x) * dby - (interval(b[0].y) - a[0].y) * dbx) / den;
+               interval x = a[0].x + t * dax, y = a[0].y + t * day;
+
+               approx = point_2(median(x), median(y));
+               box = rectangle_2(range(x.lower(), x.upper()), range(y.lower(), y.upper()));
+               return;
+            }
+         }
+
+         // get_d truncates, the exact value is within one ulp
+         double const inf = std::numeric_limits<double>::infinity();
+         approx = point_2(exact().first.get_d(), exact().second.get_d());
+         box = rectangle_2(range(std::nextafter(approx.x, -inf), std::nextafter(approx.x, inf)),
+                           range(std::nextafter(approx.y, -inf), std::nextafter(approx.y, inf)));
+      }
+
+      bool constructed() const { return constructed_; }
+
+      // the crossing lies on both of its source segments by construction
+      bool on_source(point_2 const & a, point_2 const & b) const
+      {
+         return constructed_ && ((a == a_[0] && b == a_[1]) || (a == b_[0] && b == b_[1]));
+      }
+
+      exact_t const & exact() const
+      {
+         if (!exact_)
+         {
+            if (!constructed_)
+               exact_ = std::make_shared<exact_t>(mpq_class(approx.x), mpq_class(approx.y));
+            else
+            {
+               mpq_class ax(a_[0].x), ay(a_[0].y);
+               mpq_class dax = mpq_class(a_[1].x) - ax, day = mpq_class(a_[1].y) - ay;
+               mpq_class dbx = mpq_class(b_[1].x) - b_[0].x, dby = mpq_class(b_[1].y) - b_[0].y;
+
+               mpq_class t = ((b_[0].x - ax) * dby - (b_[0].y - ay) * dbx) / (dax * dby - day * dbx);
+               exact_ = std::make_shared<exact_t>(ax + t * dax, ay + t * day);
+            }
+         }
+
+         return *exact_;
+      }
+
+      // coordinates within one ulp of the exact ones
+      point_2 rounded() const
+      {
+         double const inf = std::numeric_limits<double>::infinity();
+         if (box.x.sup <= std::nextafter(box.x.inf, inf) && box.y.sup <= std::nextafter(box.y.inf, inf))
+            return approx;
+
+         return point_2(exact().first.get_d(), exact().second.get_d());
+      }
+
+   private:
+      segment_2 a_, b_;
+      bool constructed_;
+      mutable std::shared_ptr<exact_t> exact_;
+   };
+
+   namespace detail
+   {
+      inline int compare_boxes(range const & a, range const & b)
+      {
+         if (a.sup < b.inf)
+            return -1;
+         if (a.inf > b.sup)
+            return 1;
+         return 0;
+      }
+   }
+
+   // lexicographic order, boxes first, exact coordinates when they overlap
+   inline int compare(lazy_point_2 const & a, lazy_point_2 const & b)
+   {
+      if (!a.constructed() && !b.constructed())
+         return a.approx < b.approx ? -1 : (b.approx < a.approx ? 1 : 0);
+
+      if (int res = detail::compare_boxes(a.box.x, b.box.x))
+         return res;
+
+      if (int res = cmp(a.exact().first, b.exact().first))
+         return res;
+
+      if (int res = detail::compare_boxes(a.box.y, b.box.y))
+         return res;
+
+      return cmp(a.exact().second, b.exact().second);
+   }
+
+   inline bool operator < (lazy_point_2 const & a, lazy_point_2 const & b)
+   {
+      return compare(a, b) < 0;
+   }
+
+   inline bool operator == (lazy_point_2 const & a, lazy_point_2 const & b)
+   {
+      return compare(a, b) == 0;
+   }
+
+   inline bool operator != (lazy_point_2 const & a, lazy_point_2 const & b)
+   {
+      return compare(a, b) != 0;
+   }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+
+#include "contour.h"
+
+namespace cg
+{
+   template <class Scalar>
+   struct polygon_with_holes_2t;
+
+   typedef polygon_with_holes_2t<double> polygon_with_holes_2;
+   typedef polygon_with_holes_2t<float>  polygon_with_holes_2f;
+   typedef polygon_with_holes_2t<int>    polygon_with_holes_2i;
+
+   // outer contour is ccw, holes are cw (the layout triangulate expects)
+   template <class Scalar>
+   struct polygon_with_holes_2t
+   {
+      contour_2t<Scalar> outer;
+      std::vector<contour_2t<Scalar> > holes;
+
+      polygon_with_holes_2t() {}
+
+      explicit polygon_with_holes_2t(contour_2t<Scalar> const & outer)
+         : outer(outer)
+      {}
+
+      polygon_with_holes_2t(contour_2t<Scalar> const & outer, std::vector<contour_2t<Scalar> > const & holes)
+         : outer(outer)
+         , holes(holes)
+      {}
+
+      // first contour is outer, the rest are holes
+      explicit polygon_with_holes_2t(std::vector<contour_2t<Scalar> > const & contours)
+      {
+         if (contours.empty())
+            return;
+
+         outer = contours.front();
+         holes.assign(contours.begin() + 1, contours.end());
+      }
+
+      size_t contours_num() const
+      {
+         return outer.size() == 0 && holes.empty() ? 0 : holes.size() + 1;
+      }
+
+      contour_2t<Scalar> const & contour(size_t idx) const
+      {
+         return idx == 0 ? outer : holes[idx - 1];
+      }
+
+      // outer followed by holes, the input of triangulate
+      std::vector<contour_2t<Scalar> > contours() const
+      {
+         std::vector<contour_2t<Scalar> > res;
+         res.reserve(holes.size() + 1);
+         res.push_back(outer);
+         res.insert(res.end(), holes.begin(), holes.end());
+         return res;
+      }
+   };
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <utility>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/segment.h>
+#include <cg/operations/orientation.h>
+#include <cg/segment_intersection/sweep_status.h>
+
+namespace cg
+{
+   // reports every pair of intersecting segments as std::pair<size_t, size_t>
+   // of indices (first < second), each pair once, in O((n + k) log n).
+   // touching at endpoints, degenerate (point) segments and collinear overlaps
+   // count as intersections. crossing points are ordered by interval boxes with
+   // an exact rational fallback, so the event order never depends on rounding.
+   template <class Segments, class OutIter>
+   OutIter intersect_all(Segments const & segments, OutIter out)
+   {
+      typedef detail::sweep_status status_t;
+
+      size_t n = segments.size();
+
+      // segments are relabeled in sweep order, so the active ones form a
+      // sliding window of the array instead of being scattered over it
+      std::vector<segment_2> sorted(n);
+      std::vector<size_t> id(n);
+      for (size_t l = 0; l != n; ++l)
+      {
+         sorted[l] = segments[l];
+         if (sorted[l][1] < sorted[l][0])
+            std::swap(sorted[l][0], sorted[l][1]);
+         id[l] = l;
+      }
+
+      std::sort(id.begin(), id.end(), [&sorted] (size_t a, size_t b)
+                                      { return sorted[a][0] < sorted[b][0]; });
+
+      std::vector<segment_2> by_sweep(n);
+      for (size_t l = 0; l != n; ++l)
+         by_sweep[l] = sorted[id[l]];
+
+      status_t status(by_sweep);
+
+      std::vector<point_2> ends;
+      ends.reserve(2 * n);
+      for (size_t l = 0; l != n; ++l)
+      {
+         ends.push_back(status.segment(l)[0]);
+         ends.push_back(status.segment(l)[1]);
+      }
+
+      std::sort(ends.begin(), ends.end());
+      ends.erase(std::unique(ends.begin(), ends.end()), ends.end());
+
+      std::set<detail::sweep_point, detail::sweep_point_less> crossings;
+
+      auto check = [&status, &crossings] (size_t a, size_t b)
+      {
+         if (a == detail::sweep_point_key || b == detail::sweep_point_key)
+            return;
+
+         segment_2 const & s = status.segment(a);
+         segment_2 const & t = status.segment(b);
+
+         if (!detail::properly_cross(s, t))
+            return;
+
+         detail::sweep_point q(s, t);
+         if (detail::sweep_compare(q, status.point()) > 0)
+            crossings.insert(q);
+      };
+
+      std::vector<size_t> at, inserted;
+      std::vector<char> starting;
+
+      size_t next_end = 0, next_start = 0;
+      while (next_end != ends.size() || !crossings.empty())
+      {
+         bool is_end = next_end != ends.size();
+         if (is_end && !crossings.empty())
+         {
+            int c = detail::sweep_compare(*crossings.begin(), detail::sweep_point(ends[next_end]));
+            if (c == 0)
+               crossings.erase(crossings.begin());
+            is_end = c >= 0;
+         }
+
+         if (is_end)
+         {
+            status.set_point(detail::sweep_point(ends[next_end++]));
+         }
+         else
+         {
+            status.set_point(*crossings.begin());
+            crossings.erase(crossings.begin());
+         }
+
+         at.clear();
+         starting.clear();
+
+         if (is_end)
+         {
+            for (; next_start != n && status.segment(next_start)[0] == status.point().approx; ++next_start)
+            {
+               at.push_back(next_start);
+               starting.push_back(1);
+            }
+         }
+
+         size_t cnt_starting = at.size();
+         status.through_point(std::back_inserter(at));
+         starting.resize(at.size(), 0);
+
+         // report, collinear overlaps only at the first common point
+         for (size_t i = 0; i != at.size(); ++i)
+            for (size_t j = i + 1; j != at.size(); ++j)
+            {
+               if (!starting[i] && !starting[j] && detail::collinear(status.segment(at[i]), status.segment(at[j])))
+                  continue;
+
+               *out++ = std::make_pair(std::min(id[at[i]], id[at[j]]), std::max(id[at[i]], id[at[j]]));
+            }
+
+         inserted.clear();
+         for (size_t l = cnt_starting; l != at.size(); ++l)
+         {
+            status.erase(at[l]);
+            if (status.point().constructed() || status.segment(at[l])[1] != status.point().approx)
+               inserted.push_back(at[l]);
+         }
+
+         for (size_t l = 0; l != cnt_starting; ++l)
+            if (status.segment(at[l])[0] != status.segment(at[l])[1])
+               inserted.push_back(at[l]);
+
+         for (size_t l = 0; l != inserted.size(); ++l)
+            status.insert(inserted[l]);
+
+         if (inserted.empty())
+         {
+            check(status.below(), status.above());
+         }
+         else
+         {
+            check(status.below(), status.lowest_through());
+            check(status.highest_through(), status.above());
+         }
+      }
+
+      return out;
+   }
+}
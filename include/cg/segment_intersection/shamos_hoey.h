@@ -0,0 +1,257 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include <boost/optional.hpp>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/segment.h>
+#include <cg/primitives/contour.h>
+#include <cg/primitives/polygon.h>
+#include <cg/operations/orientation.h>
+#include <cg/operations/has_intersection/segment_segment.h>
+#include <cg/segment_intersection/sweep_status.h>
+
+namespace cg {
+namespace detail
+{
+   // edges of several rings as one sweep input, edge i of a ring joins
+   // its points i and i + 1
+   struct ring_edges
+   {
+      template <class Rings>
+      explicit ring_edges(Rings const & rings)
+      {
+         for (size_t r = 0; r != rings.size(); ++r)
+         {
+            size_t n = rings[r].size();
+
+            first.push_back(segments.size());
+            for (size_t l = 0; l != n; ++l)
+            {
+               segments.push_back(segment_2(rings[r][l], rings[r][(l + 1) % n]));
+               ring.push_back(r);
+            }
+         }
+         first.push_back(segments.size());
+      }
+
+      size_t size() const { return segments.size(); }
+
+      size_t next(size_t e) const
+      {
+         return e + 1 == first[ring[e] + 1] ? first[ring[e]] : e + 1;
+      }
+
+      std::vector<segment_2> segments;
+      std::vector<size_t> ring, first;
+   };
+
+   // neighbouring edges of a ring may share their common vertex and nothing else
+   inline bool allowed_touch(ring_edges const & edges, size_t a, size_t b)
+   {
+      if (edges.next(b) == a)
+         std::swap(a, b);
+
+      if (edges.next(a) != b)
+         return false;
+
+      point_2 const & u = edges.segments[a][0];
+      point_2 const & v = edges.segments[a][1];
+      point_2 const & w = edges.segments[b][1];
+
+      if (u == v || v == w)
+         return false;
+
+      return orientation(u, v, w) != CG_COLLINEAR || collinear_are_ordered_along_line(u, v, w);
+   }
+
+   // shamos-hoey sweep, stops at the first pair of edges touching anywhere
+   // but at the common vertex of neighbours. while the rings are disjoint,
+   // parent[r] receives the innermost ring enclosing ring r (size_t(-1) if none),
+   // found from the edge below the leftmost vertex of r.
+   inline boost::optional<std::pair<size_t, size_t> > first_intersection(ring_edges const & edges,
+                                                                         std::vector<size_t> * parent = 0)
+   {
+      typedef boost::optional<std::pair<size_t, size_t> > result_t;
+
+      size_t n = edges.size();
+      size_t rings = edges.first.size() - 1;
+
+      sweep_status status(edges.segments);
+
+      std::vector<char> ccw;
+      if (parent)
+      {
+         parent->assign(rings, sweep_point_key);
+         ccw.resize(rings);
+         for (size_t r = 0; r != rings; ++r)
+         {
+            contour_2 c;
+            for (size_t e = edges.first[r]; e != edges.first[r + 1]; ++e)
+               c.add_point(edges.segments[e][0]);
+            ccw[r] = counterclockwise(c);
+         }
+      }
+      std::vector<char> seen(rings, 0);
+
+      std::vector<point_2> ends;
+      ends.reserve(2 * n);
+      std::vector<size_t> starts(n);
+      for (size_t l = 0; l != n; ++l)
+      {
+         ends.push_back(status.segment(l)[0]);
+         ends.push_back(status.segment(l)[1]);
+         starts[l] = l;
+      }
+
+      std::sort(ends.begin(), ends.end());
+      ends.erase(std::unique(ends.begin(), ends.end()), ends.end());
+
+      std::sort(starts.begin(), starts.end(), [&status] (size_t a, size_t b)
+                                              { return status.segment(a)[0] < status.segment(b)[0]; });
+
+      auto offending = [] (size_t a, size_t b)
+      {
+         return result_t(std::make_pair(std::min(a, b), std::max(a, b)));
+      };
+
+      std::vector<size_t> at;
+      size_t next_start = 0;
+
+      for (size_t ev = 0; ev != ends.size(); ++ev)
+      {
+         point_2 const & p = ends[ev];
+         status.set_point(sweep_point(p));
+
+         at.clear();
+         for (; next_start != n && status.segment(starts[next_start])[0] == p; ++next_start)
+            at.push_back(starts[next_start]);
+
+         size_t cnt_starting = at.size();
+         status.through_point(std::back_inserter(at));
+
+         // everything meeting at p, only neighbours sharing the vertex p are allowed
+         for (size_t i = 0; i != at.size(); ++i)
+            for (size_t j = i + 1; j != at.size(); ++j)
+               if (!allowed_touch(edges, at[i], at[j]))
+                  return offending(at[i], at[j]);
+
+         for (size_t l = cnt_starting; l != at.size(); ++l)
+            status.erase(at[l]);
+
+         if (parent)
+         {
+            for (size_t l = 0; l != cnt_starting; ++l)
+            {
+               size_t r = edges.ring[at[l]];
+               if (seen[r])
+                  continue;
+
+               seen[r] = 1;
+
+               size_t e = status.below();
+               if (e == sweep_point_key)
+                  continue;
+
+               // p is above e, that is inside its ring iff e runs along the ring
+               // orientation from left to right
+               size_t s = edges.ring[e];
+               bool forward = edges.segments[e][0] == status.segment(e)[0];
+               (*parent)[r] = (bool(ccw[s]) == forward) ? s : (*parent)[s];
+            }
+         }
+
+         for (size_t l = 0; l != cnt_starting; ++l)
+            status.insert(at[l]);
+
+         auto check = [&status, &edges] (size_t a, size_t b)
+         {
+            if (a == sweep_point_key || b == sweep_point_key || allowed_touch(edges, a, b))
+               return false;
+
+            return has_intersection(status.segment(a), status.segment(b));
+         };
+
+         size_t below = status.below(), above = status.above();
+         if (cnt_starting == 0)
+         {
+            if (check(below, above))
+               return offending(below, above);
+         }
+         else
+         {
+            size_t lowest = status.lowest_through(), highest = status.highest_through();
+            if (check(below, lowest))
+               return offending(below, lowest);
+            if (check(highest, above))
+               return offending(highest, above);
+         }
+      }
+
+      return boost::none;
+   }
+}
+
+   // some pair of edges of c intersecting anywhere but at the common vertex
+   // of neighbours (including zero length edges and overlapping neighbours),
+   // edge i joins c[i] and c[i + 1]. O(n log n), stops at the first such pair.
+   inline boost::optional<std::pair<size_t, size_t> > find_self_intersection(contour_2 const & c)
+   {
+      std::vector<contour_2> rings(1, c);
+      return detail::first_intersection(detail::ring_edges(rings));
+   }
+
+   inline bool is_simple(contour_2 const & c)
+   {
+      return c.size() >= 3 && !find_self_intersection(c);
+   }
+
+   // edge of a polygon with holes: (contour index as in polygon_with_holes_2t::contour, edge index)
+   typedef std::pair<size_t, size_t> polygon_edge;
+
+   // some pair of edges of p intersecting anywhere but at the common vertex of neighbours
+   inline boost::optional<std::pair<polygon_edge, polygon_edge> > find_intersection(polygon_with_holes_2 const & p)
+   {
+      detail::ring_edges edges(p.contours());
+
+      boost::optional<std::pair<size_t, size_t> > res = detail::first_intersection(edges);
+      if (!res)
+         return boost::none;
+
+      auto edge = [&edges] (size_t e) { return polygon_edge(edges.ring[e], e - edges.first[edges.ring[e]]); };
+      return std::make_pair(edge(res->first), edge(res->second));
+   }
+
+   // simple disjoint rings, ccw outer contour and cw holes lying inside it and
+   // not inside each other. O(n log n) in the total number of vertices.
+   inline bool is_valid(polygon_with_holes_2 const & p)
+   {
+      std::vector<contour_2> rings = p.contours();
+      for (size_t r = 0; r != rings.size(); ++r)
+         if (rings[r].size() < 3)
+            return false;
+
+      if (!counterclockwise(p.outer))
+         return false;
+
+      for (size_t h = 0; h != p.holes.size(); ++h)
+         if (counterclockwise(p.holes[h]))
+            return false;
+
+      std::vector<size_t> parent;
+      if (detail::first_intersection(detail::ring_edges(rings), &parent))
+         return false;
+
+      if (parent[0] != detail::sweep_point_key)
+         return false;
+
+      for (size_t r = 1; r != rings.size(); ++r)
+         if (parent[r] != 0)
+            return false;
+
+      return true;
+   }
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <vector>
+#include <set>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/segment.h>
+#include <cg/primitives/lazy_point.h>
+#include <cg/operations/orientation.h>
+
+namespace cg {
+namespace detail
+{
+   // event point of a segment sweep: an input endpoint, or the crossing point of two segments
+   typedef lazy_point_2 sweep_point;
+
+   inline int sweep_compare(sweep_point const & a, sweep_point const & b)
+   {
+      return compare(a, b);
+   }
+
+   struct sweep_point_less
+   {
+      bool operator () (sweep_point const & a, sweep_point const & b) const
+      {
+         return compare(a, b) < 0;
+      }
+   };
+
+   inline bool properly_cross(segment_2 const & a, segment_2 const & b)
+   {
+      return opposite(orientation(a[0], a[1], b[0]), orientation(a[0], a[1], b[1]))
+          && opposite(orientation(b[0], b[1], a[0]), orientation(b[0], b[1], a[1]));
+   }
+
+   inline bool collinear(segment_2 const & a, segment_2 const & b)
+   {
+      return orientation(a[0], a[1], b[0]) == CG_COLLINEAR
+          && orientation(a[0], a[1], b[1]) == CG_COLLINEAR;
+   }
+
+   // sweep line status: segments crossing the sweep line, ordered bottom-up
+   // just after the current event point. segments are stored with [0] < [1].
+   // comparisons always involve a segment passing through the current point
+   // (or the point itself), so they are decided by orientation with the segment
+   // endpoints, ties are broken by direction and then by index.
+   // key of the current point in status searches, also means "no segment"
+   size_t const sweep_point_key = size_t(-1);
+
+   struct sweep_status
+   {
+      struct status_less
+      {
+         explicit status_less(sweep_status const * s)
+            : s(s)
+         {}
+
+         bool operator () (size_t a, size_t b) const
+         {
+            return s->less(a, b);
+         }
+
+         sweep_status const * s;
+      };
+
+      typedef std::set<size_t, status_less> set_t;
+
+      template <class Segments>
+      explicit sweep_status(Segments const & segments)
+         : status_(status_less(this))
+      {
+         size_t n = segments.size();
+
+         segments_.resize(n);
+         handles_.resize(n, status_.end());
+
+         for (size_t l = 0; l != n; ++l)
+         {
+            segment_2 s = segments[l];
+            if (s[1] < s[0])
+               std::swap(s[0], s[1]);
+            segments_[l] = s;
+         }
+      }
+
+      sweep_status(sweep_status const &) = delete;
+      sweep_status & operator = (sweep_status const &) = delete;
+
+      size_t size() const { return segments_.size(); }
+
+      segment_2 const & segment(size_t idx) const { return segments_[idx]; }
+
+      void set_point(sweep_point const & p) { p_ = p; }
+      sweep_point const & point() const { return p_; }
+
+      // orientation of the current point to the segment
+      orientation_t side(size_t idx) const
+      {
+         return orientation(segments_[idx][0], segments_[idx][1], p_);
+      }
+
+      // segments of the status passing through the current point
+      template <class OutIter>
+      OutIter through_point(OutIter out) const
+      {
+         for (set_t::const_iterator it = status_.lower_bound(sweep_point_key); it != status_.end() && side(*it) == CG_COLLINEAR; ++it)
+            *out++ = *it;
+
+         return out;
+      }
+
+      void insert(size_t idx)
+      {
+         handles_[idx] = status_.insert(idx).first;
+      }
+
+      void erase(size_t idx)
+      {
+         status_.erase(handles_[idx]);
+         handles_[idx] = status_.end();
+      }
+
+      bool active(size_t idx) const { return handles_[idx] != status_.end(); }
+
+      // neighbours of the block of segments through the current point,
+      // sweep_point_key when there is none. without such segments both are
+      // neighbours of the point itself.
+      size_t below() const
+      {
+         set_t::const_iterator it = status_.lower_bound(sweep_point_key);
+         return it == status_.begin() ? sweep_point_key : *--it;
+      }
+
+      size_t above() const
+      {
+         set_t::const_iterator it = status_.upper_bound(sweep_point_key);
+         return it == status_.end() ? sweep_point_key : *it;
+      }
+
+      // lowest and highest segment through the current point
+      size_t lowest_through() const
+      {
+         set_t::const_iterator it = status_.lower_bound(sweep_point_key);
+         return (it == status_.end() || side(*it) != CG_COLLINEAR) ? sweep_point_key : *it;
+      }
+
+      size_t highest_through() const
+      {
+         set_t::const_iterator it = status_.upper_bound(sweep_point_key);
+         if (it == status_.begin())
+            return sweep_point_key;
+
+         --it;
+         return side(*it) == CG_COLLINEAR ? *it : sweep_point_key;
+      }
+
+   private:
+      bool less(size_t a, size_t b) const
+      {
+         if (a == b)
+            return false;
+
+         if (a == sweep_point_key)
+            return side(b) == CG_RIGHT;
+
+         if (b == sweep_point_key)
+            return side(a) == CG_LEFT;
+
+         orientation_t sa = side(a);
+         if (sa != CG_COLLINEAR)
+            return sa == CG_LEFT;
+
+         orientation_t sb = side(b);
+         if (sb != CG_COLLINEAR)
+            return sb == CG_RIGHT;
+
+         orientation_t o = orientation(segments_[b][0], segments_[b][1], segments_[a][1]);
+         if (o != CG_COLLINEAR)
+            return o == CG_RIGHT;
+
+         return a < b;
+      }
+
+      std::vector<segment_2> segments_;
+      sweep_point p_;
+      set_t status_;
+      std::vector<set_t::iterator> handles_;
+   };
+}}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/rectangle.h>
+#include <cg/operations/bounding_box.h>
+
+namespace cg
+{
+   namespace detail
+   {
+      // spreads the low 16 bits of x to the even bits
+      inline uint32_t spread_bits(uint32_t x)
+      {
+         x = (x | (x << 8)) & 0x00ff00ff;
+         x = (x | (x << 4)) & 0x0f0f0f0f;
+         x = (x | (x << 2)) & 0x33333333;
+         x = (x | (x << 1)) & 0x55555555;
+         return x;
+      }
+
+      // position of the cell (x, y) along the hilbert curve through a
+      // 2^16 x 2^16 grid. the rotations of the quadrants are composed by a
+      // parallel prefix scan over the bits instead of a loop with a branch
+      // per level, which mispredicts on scattered points.
+      inline uint32_t hilbert_index(uint32_t x, uint32_t y)
+      {
+         uint32_t A, B, C, D;
+         {
+            uint32_t a = x ^ y, b = 0xffff ^ a, c = 0xffff ^ (x | y), d = x & (y ^ 0xffff);
+            A = a | (b >> 1);
+            B = (a >> 1) ^ a;
+            C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+            D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+         }
+
+         for (uint32_t shift = 2; shift != 16; shift *= 2)
+         {
+            uint32_t a = A, b = B, c = C, d = D;
+            A = (a & (a >> shift)) ^ (b & (b >> shift));
+            B = (a & (b >> shift)) ^ (b & ((a ^ b) >> shift));
+            C ^= (a & (c >> shift)) ^ (b & (d >> shift));
+            D ^= (b & (c >> shift)) ^ ((a ^ b) & (d >> shift));
+         }
+
+         uint32_t a = C ^ (C >> 1), b = D ^ (D >> 1);
+         uint32_t i0 = x ^ y, i1 = b | (0xffff ^ (i0 | a));
+         return (spread_bits(i1) << 1) | spread_bits(i0);
+      }
+
+      inline uint32_t hilbert_cell(double v, range const & r)
+      {
+         if (!(r.sup > r.inf))
+            return 0;
+
+         return uint32_t((v - r.inf) / (r.sup - r.inf) * 65535.);
+      }
+   }
+
+   // indices of pts in the order of a hilbert curve over their bounding box,
+   // points in the same cell in index order. consecutive points are close,
+   // which makes it a good insertion order for incremental constructions.
+   inline void hilbert_sort(std::vector<point_2> const & pts, std::vector<uint32_t> & order)
+   {
+      size_t n = pts.size();
+      rectangle_2 box;
+      for (size_t l = 0; l != n; ++l)
+         box = box | bounding_box(pts[l]);
+
+      std::vector<uint32_t> keys(n), tmp_keys(n), tmp(n);
+      order.resize(n);
+      for (size_t l = 0; l != n; ++l)
+      {
+         keys[l] = detail::hilbert_index(detail::hilbert_cell(pts[l].x, box.x), detail::hilbert_cell(pts[l].y, box.y));
+         order[l] = uint32_t(l);
+      }
+
+      // lsd radix sort, three stable passes over 11 bit digits of the key
+      for (uint32_t shift = 0; shift < 32; shift += 11)
+      {
+         uint32_t count[2049] = {};
+         for (size_t l = 0; l != n; ++l)
+            ++count[((keys[l] >> shift) & 0x7ff) + 1];
+         for (size_t l = 0; l != 2048; ++l)
+            count[l + 1] += count[l];
+
+         for (size_t l = 0; l != n; ++l)
+         {
+            uint32_t & pos = count[(keys[l] >> shift) & 0x7ff];
+            tmp_keys[pos] = keys[l];
+            tmp[pos++] = order[l];
+         }
+
+         keys.swap(tmp_keys);
+         order.swap(tmp);
+      }
+   }
+}
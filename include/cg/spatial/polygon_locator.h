@@ -0,0 +1,193 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include <boost/optional.hpp>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/rectangle.h>
+#include <cg/primitives/polygon.h>
+#include <cg/operations/bounding_box.h>
+#include <cg/operations/contains/packed_contour_point.h>
+
+namespace cg
+{
+   // point location over a layer of polygons with holes.
+   // a uniform grid over the outer contour bounding boxes gives candidate polygons,
+   // which are tested ring by ring with the packed crossing number kernel.
+   // the answer for one polygon is the same as contains(polygon_with_holes_2, point_2).
+   struct polygon_locator
+   {
+      explicit polygon_locator(std::vector<polygon_with_holes_2> const & layer, double cells_per_polygon = 2)
+         : nx_(0)
+         , ny_(0)
+      {
+         ring_start_.reserve(layer.size() + 1);
+         for (size_t l = 0; l != layer.size(); ++l)
+         {
+            ring_start_.push_back(rings_.size());
+            add_ring(layer[l].outer);
+            for (size_t h = 0; h != layer[l].holes.size(); ++h)
+               add_ring(layer[l].holes[h]);
+
+            if (layer[l].outer.size() != 0)
+               extent_ = extent_ | rings_[ring_start_.back()].box;
+         }
+         ring_start_.push_back(rings_.size());
+
+         if (extent_.x.is_empty() || extent_.y.is_empty())
+            return;
+
+         build_grid(std::max<double>(1., cells_per_polygon * layer.size()));
+      }
+
+      size_t size() const { return ring_start_.size() - 1; }
+
+      // smallest index of a polygon containing q
+      boost::optional<size_t> locate(point_2 const & q) const
+      {
+         size_t cell;
+         if (!find_cell(q, cell))
+            return boost::none;
+
+         for (size_t l = cell_start_[cell]; l != cell_start_[cell + 1]; ++l)
+            if (polygon_contains(cell_items_[l], q))
+               return size_t(cell_items_[l]);
+
+         return boost::none;
+      }
+
+      // indices of all polygons containing q in ascending order
+      template <class OutIter>
+      OutIter locate_all(point_2 const & q, OutIter out) const
+      {
+         size_t cell;
+         if (!find_cell(q, cell))
+            return out;
+
+         for (size_t l = cell_start_[cell]; l != cell_start_[cell + 1]; ++l)
+            if (polygon_contains(cell_items_[l], q))
+               *out++ = size_t(cell_items_[l]);
+
+         return out;
+      }
+
+      bool polygon_contains(size_t idx, point_2 const & q) const
+      {
+         size_t r = ring_start_[idx], rend = ring_start_[idx + 1];
+         if (r == rend || !rings_[r].box.contains(q) || !contains(rings_[r].edges, q))
+            return false;
+
+         for (++r; r != rend; ++r)
+         {
+            ring const & hole = rings_[r];
+            if (hole.box.contains(q) && contains(hole.edges, q) && !on_boundary(hole.edges, q))
+               return false;
+         }
+
+         return true;
+      }
+
+   private:
+      struct ring
+      {
+         packed_contour_2 edges;
+         rectangle_2 box;
+      };
+
+      void add_ring(contour_2 const & c)
+      {
+         rings_.push_back(ring());
+         rings_.back().edges.assign(c);
+         rings_.back().box = bounding_box(c);
+      }
+
+      void build_grid(double cells)
+      {
+         double w = cg::size(extent_.x), h = cg::size(extent_.y);
+
+         if (w == 0 || h == 0)
+         {
+            nx_ = (w == 0) ? 1 : size_t(cells);
+            ny_ = (h == 0) ? 1 : size_t(cells);
+         }
+         else
+         {
+            nx_ = std::max<size_t>(1, size_t(std::ceil(std::sqrt(cells * w / h))));
+            ny_ = std::max<size_t>(1, size_t(std::ceil(cells / nx_)));
+         }
+
+         cell_w_ = (w == 0) ? 1 : w / nx_;
+         cell_h_ = (h == 0) ? 1 : h / ny_;
+
+         // counting pass, then fill in polygon order so every cell list is sorted
+         cell_start_.assign(nx_ * ny_ + 1, 0);
+         for (int pass = 0; pass != 2; ++pass)
+         {
+            std::vector<uint32_t> fill;
+            if (pass == 1)
+            {
+               for (size_t c = 0; c != nx_ * ny_; ++c)
+                  cell_start_[c + 1] += cell_start_[c];
+               cell_items_.resize(cell_start_.back());
+               fill.assign(cell_start_.begin(), cell_start_.end() - 1);
+            }
+
+            for (size_t l = 0; l != size(); ++l)
+            {
+               if (ring_start_[l] == ring_start_[l + 1])
+                  continue;
+
+               rectangle_2 const & box = rings_[ring_start_[l]].box;
+               if (box.x.is_empty())
+                  continue;
+
+               size_t x0 = column(box.x.inf), x1 = column(box.x.sup);
+               size_t y0 = row(box.y.inf), y1 = row(box.y.sup);
+
+               for (size_t y = y0; y <= y1; ++y)
+                  for (size_t x = x0; x <= x1; ++x)
+                  {
+                     size_t c = y * nx_ + x;
+                     if (pass == 0)
+                        cell_start_[c + 1]++;
+                     else
+                        cell_items_[fill[c]++] = uint32_t(l);
+                  }
+            }
+         }
+      }
+
+      size_t column(double x) const
+      {
+         double t = (x - extent_.x.inf) / cell_w_;
+         return t > 0 ? (t < nx_ ? size_t(t) : nx_ - 1) : 0;
+      }
+
+      size_t row(double y) const
+      {
+         double t = (y - extent_.y.inf) / cell_h_;
+         return t > 0 ? (t < ny_ ? size_t(t) : ny_ - 1) : 0;
+      }
+
+      bool find_cell(point_2 const & q, size_t & cell) const
+      {
+         if (nx_ == 0 || !extent_.contains(q))
+            return false;
+
+         cell = row(q.y) * nx_ + column(q.x);
+         return true;
+      }
+
+      std::vector<ring> rings_;
+      std::vector<size_t> ring_start_;
+
+      rectangle_2 extent_;
+      double cell_w_, cell_h_;
+      size_t nx_, ny_;
+      std::vector<uint32_t> cell_start_, cell_items_;
+   };
+}
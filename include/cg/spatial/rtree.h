@@ -0,0 +1,377 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/segment.h>
+#include <cg/primitives/triangle.h>
+#include <cg/primitives/rectangle.h>
+#include <cg/operations/bounding_box.h>
+#include <cg/operations/contains/segment_point.h>
+#include <cg/operations/contains/triangle_point.h>
+#include <cg/operations/has_intersection/segment_segment.h>
+#include <cg/operations/has_intersection/triangle_segment.h>
+#include <cg/operations/has_intersection/rectangle_segment.h>
+#include <cg/operations/has_intersection/rectangle_triangle.h>
+#include <cg/operations/has_intersection/rectangle_rectangle.h>
+#include <cg/common/parallel.h>
+
+namespace cg
+{
+   namespace detail
+   {
+      inline bool rtree_stabs(segment_2 const & s, point_2 const & p)   { return contains(s, p); }
+      inline bool rtree_stabs(triangle_2 const & t, point_2 const & p)  { return contains(t, p); }
+      inline bool rtree_stabs(rectangle_2 const & r, point_2 const & p) { return r.contains(p); }
+   }
+
+   // static r-tree over segments, triangles or rectangles.
+   // bulk loaded by sort-tile-recursive packing into a flat node array:
+   // root first, then every level in turn, leaves last, children of a node
+   // contiguous. items are stored in leaf order. queries report indices of
+   // the input vector, decided by the exact predicates, in tree order.
+   // const members may be called concurrently.
+   template <class Primitive>
+   struct packed_rtree
+   {
+      typedef Primitive value_type;
+
+      packed_rtree()
+         : leaves_(0)
+      {}
+
+      // threads == 0 means one per hardware thread
+      explicit packed_rtree(std::vector<Primitive> const & items, size_t node_size = 16, size_t threads = 0)
+         : leaves_(0)
+      {
+         build(items, std::max<size_t>(2, node_size), threads);
+      }
+
+      size_t size() const { return items_.size(); }
+
+      rectangle_2 bounds() const
+      {
+         return nodes_.empty() ? rectangle_2() : nodes_[0].box;
+      }
+
+      // items intersecting the closed rectangle r
+      template <class OutIter>
+      OutIter window(rectangle_2 const & r, OutIter out) const
+      {
+         if (r.x.is_empty() || r.y.is_empty())
+            return out;
+
+         search([&r] (rectangle_2 const & box) { return overlap(box, r); },
+                [&r, &out] (Primitive const & item, size_t id)
+                {
+                   if (has_intersection(r, item))
+                      *out++ = id;
+                   return true;
+                });
+
+         return out;
+      }
+
+      // items containing p
+      template <class OutIter>
+      OutIter stabbing(point_2 const & p, OutIter out) const
+      {
+         search([&p] (rectangle_2 const & box) { return box.contains(p); },
+                [&p, &out] (Primitive const & item, size_t id)
+                {
+                   if (detail::rtree_stabs(item, p))
+                      *out++ = id;
+                   return true;
+                });
+
+         return out;
+      }
+
+      // items intersecting s
+      template <class OutIter>
+      OutIter intersecting(segment_2 const & s, OutIter out) const
+      {
+         search([&s] (rectangle_2 const & box) { return has_intersection(box, s); },
+                [&s, &out] (Primitive const & item, size_t id)
+                {
+                   if (has_intersection(item, s))
+                      *out++ = id;
+                   return true;
+                });
+
+         return out;
+      }
+
+      // does any item intersect s, stops at the first one
+      bool intersects(segment_2 const & s) const
+      {
+         bool res = false;
+         search([&s] (rectangle_2 const & box) { return has_intersection(box, s); },
+                [&s, &res] (Primitive const & item, size_t)
+                {
+                   res = has_intersection(item, s);
+                   return !res;
+                });
+
+         return res;
+      }
+
+      // binary image for the same platform, read back by load
+      void save(std::ostream & out) const
+      {
+         uint64_t header[5] = { magic, sizeof(Primitive), nodes_.size(), leaves_, items_.size() };
+         out.write(reinterpret_cast<char const *>(header), sizeof(header));
+
+         write(out, nodes_);
+         write(out, items_);
+         write(out, ids_);
+      }
+
+      // false (and an empty tree) if the stream does not hold a saved tree of this type
+      bool load(std::istream & in)
+      {
+         nodes_.clear();
+         items_.clear();
+         ids_.clear();
+         leaves_ = 0;
+
+         uint64_t header[5];
+         if (!in.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] != magic || header[1] != sizeof(Primitive))
+            return false;
+
+         // counts are checked against what the stream holds before anything
+         // is allocated for them
+         uint64_t const max_count = uint32_t(-1);
+         if (header[3] > header[2] || header[2] > max_count || header[4] > max_count
+             || header[2] * sizeof(node) + header[4] * (sizeof(Primitive) + sizeof(uint32_t)) > remaining(in))
+            return false;
+
+         if (!read(in, nodes_, header[2]) || !read(in, items_, header[4]) || !read(in, ids_, header[4]))
+            return clear();
+
+         // every node but the root is the child of one inner node before it
+         // and every item is in one leaf, so searches end and report each
+         // item once
+         leaves_ = header[3];
+         std::vector<uint8_t> node_seen(nodes_.size()), item_seen(items_.size());
+         for (size_t l = 0; l != nodes_.size(); ++l)
+         {
+            bool inner = l < leaves_;
+            std::vector<uint8_t> & seen = inner ? node_seen : item_seen;
+            size_t first = nodes_[l].first, count = nodes_[l].count;
+            if (first > seen.size() || count > seen.size() - first || (inner && first <= l))
+               return clear();
+
+            for (size_t k = first; k != first + count; ++k)
+            {
+               if (seen[k])
+                  return clear();
+               seen[k] = 1;
+            }
+         }
+
+         if (std::count(node_seen.begin(), node_seen.end(), 0) > (nodes_.empty() ? 0 : 1)
+          || std::count(item_seen.begin(), item_seen.end(), 0) != 0)
+            return clear();
+
+         for (size_t l = 0; l != ids_.size(); ++l)
+            if (ids_[l] >= items_.size())
+               return clear();
+
+         return true;
+      }
+
+   private:
+      static uint64_t const magic = 0x3165657274726763ull; // "cgrtree1"
+
+      struct node
+      {
+         rectangle_2 box;
+         uint32_t first, count;
+      };
+
+      bool clear()
+      {
+         *this = packed_rtree();
+         return false;
+      }
+
+      template <class T>
+      static void write(std::ostream & out, std::vector<T> const & v)
+      {
+         if (!v.empty())
+            out.write(reinterpret_cast<char const *>(v.data()), v.size() * sizeof(T));
+      }
+
+      // bytes left in the stream, uint64_t(-1) if it cannot seek
+      static uint64_t remaining(std::istream & in)
+      {
+         std::istream::pos_type here = in.tellg();
+         if (here == std::istream::pos_type(-1))
+            return uint64_t(-1);
+
+         in.seekg(0, std::ios::end);
+         std::istream::pos_type end = in.tellg();
+         in.clear();
+         in.seekg(here);
+         return end == std::istream::pos_type(-1) ? uint64_t(-1) : uint64_t(end - here);
+      }
+
+      // grows v a chunk at a time, so a stream that cannot seek still does
+      // not make it allocate more than the stream holds
+      template <class T>
+      static bool read(std::istream & in, std::vector<T> & v, uint64_t count)
+      {
+         size_t const chunk = (size_t(1) << 20) / sizeof(T) + 1;
+         v.clear();
+         while (v.size() != count)
+         {
+            size_t size = v.size(), k = size_t(std::min<uint64_t>(count - size, chunk));
+            v.resize(size + k);
+            if (!in.read(reinterpret_cast<char *>(v.data() + size), k * sizeof(T)))
+               return false;
+         }
+         return true;
+      }
+
+      template <class BoxPred, class Visit>
+      void search(BoxPred box_pred, Visit visit) const
+      {
+         if (nodes_.empty())
+            return;
+
+         std::vector<uint32_t> stack(1, 0);
+         while (!stack.empty())
+         {
+            node const & nd = nodes_[stack.back()];
+            bool leaf = stack.back() >= leaves_;
+            stack.pop_back();
+
+            if (!box_pred(nd.box))
+               continue;
+
+            for (uint32_t l = nd.first + nd.count; l-- != nd.first; )
+            {
+               if (!leaf)
+                  stack.push_back(l);
+               else if (!visit(items_[l], ids_[l]))
+                  return;
+            }
+         }
+      }
+
+      static double center(range const & r)
+      {
+         return r.inf / 2 + r.sup / 2;
+      }
+
+      // sort-tile-recursive order of boxes: vertical slices by x, each sorted by y
+      static void str_order(std::vector<rectangle_2> const & boxes, std::vector<uint32_t> & order,
+                            size_t node_size, size_t threads)
+      {
+         size_t n = boxes.size();
+         order.resize(n);
+         for (size_t l = 0; l != n; ++l)
+            order[l] = uint32_t(l);
+
+         std::sort(order.begin(), order.end(), [&boxes] (uint32_t a, uint32_t b)
+                                               { return center(boxes[a].x) < center(boxes[b].x); });
+
+         size_t nodes = (n + node_size - 1) / node_size;
+         size_t slices = size_t(std::ceil(std::sqrt(double(nodes))));
+         size_t slice = ((nodes + slices - 1) / slices) * node_size;
+
+         common::parallel_for(0, (n + slice - 1) / slice, [&] (size_t s)
+         {
+            std::sort(order.begin() + s * slice, order.begin() + std::min(n, (s + 1) * slice),
+                      [&boxes] (uint32_t a, uint32_t b) { return center(boxes[a].y) < center(boxes[b].y); });
+         }, threads);
+      }
+
+      // groups of node_size consecutive boxes
+      static std::vector<node> pack(std::vector<rectangle_2> const & boxes, std::vector<uint32_t> const & order,
+                                    size_t node_size, size_t threads)
+      {
+         size_t n = order.size();
+         std::vector<node> res((n + node_size - 1) / node_size);
+
+         common::parallel_for(0, res.size(), [&] (size_t k)
+         {
+            res[k].first = uint32_t(k * node_size);
+            res[k].count = uint32_t(std::min(n, (k + 1) * node_size) - k * node_size);
+            for (size_t l = res[k].first; l != res[k].first + res[k].count; ++l)
+               res[k].box = res[k].box | boxes[order[l]];
+         }, threads, 256);
+
+         return res;
+      }
+
+      void build(std::vector<Primitive> const & items, size_t node_size, size_t threads)
+      {
+         size_t n = items.size();
+         if (n == 0)
+            return;
+
+         std::vector<rectangle_2> boxes(n);
+         common::parallel_for(0, n, [&] (size_t l) { boxes[l] = bounding_box(items[l]); }, threads, 4096);
+
+         str_order(boxes, ids_, node_size, threads);
+
+         items_.resize(n);
+         for (size_t l = 0; l != n; ++l)
+            items_[l] = items[ids_[l]];
+
+         // levels bottom-up, children ranges relative to the level below
+         std::vector<std::vector<node> > levels(1, pack(boxes, ids_, node_size, threads));
+         while (levels.back().size() > 1)
+         {
+            std::vector<node> & lower = levels.back();
+
+            std::vector<rectangle_2> lower_boxes(lower.size());
+            for (size_t l = 0; l != lower.size(); ++l)
+               lower_boxes[l] = lower[l].box;
+
+            std::vector<uint32_t> order;
+            str_order(lower_boxes, order, node_size, threads);
+
+            std::vector<node> sorted(lower.size());
+            for (size_t l = 0; l != order.size(); ++l)
+               sorted[l] = lower[order[l]];
+            lower.swap(sorted);
+
+            std::vector<node> upper = pack(lower_boxes, order, node_size, threads);
+            levels.push_back(upper);
+         }
+
+         // flatten, root first
+         size_t start = 0;
+         for (size_t k = levels.size(); k-- != 0; )
+         {
+            size_t below = start + levels[k].size();
+            for (size_t l = 0; l != levels[k].size(); ++l)
+            {
+               node nd = levels[k][l];
+               if (k != 0)
+                  nd.first += uint32_t(below);
+               nodes_.push_back(nd);
+            }
+
+            if (k == 0)
+               leaves_ = start;
+            start = below;
+         }
+      }
+
+      std::vector<node> nodes_;
+      size_t leaves_;
+
+      std::vector<Primitive> items_;
+      std::vector<uint32_t> ids_;
+   };
+}
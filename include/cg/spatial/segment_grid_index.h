@@ -0,0 +1,326 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/segment.h>
+#include <cg/primitives/rectangle.h>
+#include <cg/operations/has_intersection/segment_segment.h>
+#include <cg/operations/has_intersection/rectangle_segment.h>
+
+namespace cg
+{
+   // dynamic set of segments hashed into a uniform grid.
+   // a segment is registered in every cell it may pass through, queries gather
+   // the candidates of their own cells and run the exact has_intersection on them.
+   // the cell size follows the mean segment extent, the grid is rebuilt when
+   // the number of segments changes twice since the last build. segments
+   // spanning more than large_cells cells are kept in a list of their own
+   // that every query checks, and a query spanning more cells than the grid
+   // holds scans all segments.
+   // const members do not modify the index and may be called concurrently.
+   struct segment_grid_index
+   {
+      segment_grid_index()
+         : cell_(1)
+         , count_(0)
+         , built_count_(0)
+         , extent_sum_(0)
+      {}
+
+      template <class Segments>
+      explicit segment_grid_index(Segments const & segments)
+         : cell_(1)
+         , count_(0)
+         , built_count_(0)
+         , extent_sum_(0)
+      {
+         for (size_t l = 0; l != segments.size(); ++l)
+         {
+            segments_.push_back(segments[l]);
+            alive_.push_back(1);
+            extent_sum_ += extent(segments[l]);
+         }
+
+         count_ = segments_.size();
+         rebuild();
+      }
+
+      // id of the inserted segment, ids of erased segments are reused
+      size_t insert(segment_2 const & s)
+      {
+         size_t id;
+         if (free_.empty())
+         {
+            id = segments_.size();
+            segments_.push_back(s);
+            alive_.push_back(1);
+         }
+         else
+         {
+            id = free_.back();
+            free_.pop_back();
+            segments_[id] = s;
+            alive_[id] = 1;
+         }
+
+         ++count_;
+         extent_sum_ += extent(s);
+
+         if (count_ >= 2 * built_count_ + 16)
+            rebuild();
+         else
+            register_segment(id);
+
+         return id;
+      }
+
+      void erase(size_t id)
+      {
+         if (id >= alive_.size() || !alive_[id])
+            return;
+
+         unregister_segment(id);
+         alive_[id] = 0;
+         free_.push_back(id);
+
+         --count_;
+         extent_sum_ -= extent(segments_[id]);
+
+         if (2 * count_ + 16 <= built_count_)
+            rebuild();
+      }
+
+      size_t size() const { return count_; }
+
+      bool contains(size_t id) const { return id < alive_.size() && alive_[id]; }
+
+      segment_2 const & segment(size_t id) const { return segments_[id]; }
+
+      double cell_size() const { return cell_; }
+
+      // ids of all segments intersecting s in ascending order
+      template <class OutIter>
+      OutIter query(segment_2 const & s, OutIter out) const
+      {
+         std::vector<uint32_t> ids;
+         candidates(s, ids);
+
+         for (size_t l = 0; l != ids.size(); ++l)
+            if (has_intersection(segments_[ids[l]], s))
+               *out++ = size_t(ids[l]);
+
+         return out;
+      }
+
+      // ids of all segments intersecting r in ascending order
+      template <class OutIter>
+      OutIter query(rectangle_2 const & r, OutIter out) const
+      {
+         if (r.x.is_empty() || r.y.is_empty())
+            return out;
+
+         std::vector<uint32_t> ids;
+         double cells = (std::floor(r.x.sup / cell_) - std::floor(r.x.inf / cell_) + 1)
+                      * (std::floor(r.y.sup / cell_) - std::floor(r.y.inf / cell_) + 1);
+
+         // a rectangle larger than the occupied grid just scans the segments
+         if (cells > cells_.size())
+            all_ids(ids);
+         else
+         {
+            for_cells(r, [this, &ids] (cell_t const & c) { ids.insert(ids.end(), c.begin(), c.end()); });
+            ids.insert(ids.end(), large_.begin(), large_.end());
+            unique_ids(ids);
+         }
+
+         for (size_t l = 0; l != ids.size(); ++l)
+            if (has_intersection(r, segments_[ids[l]]))
+               *out++ = size_t(ids[l]);
+
+         return out;
+      }
+
+      // does s intersect any segment of the index
+      bool intersects(segment_2 const & s) const
+      {
+         std::vector<uint32_t> ids;
+         candidates(s, ids);
+
+         for (size_t l = 0; l != ids.size(); ++l)
+            if (has_intersection(segments_[ids[l]], s))
+               return true;
+
+         return false;
+      }
+
+      // recomputes the cell size from the current segments
+      void rebuild()
+      {
+         cells_.clear();
+         large_.clear();
+         built_count_ = count_;
+
+         if (count_ != 0 && extent_sum_ > 0)
+            cell_ = extent_sum_ / count_;
+
+         cells_.reserve(2 * count_);
+         for (size_t id = 0; id != segments_.size(); ++id)
+            if (alive_[id])
+               register_segment(id);
+      }
+
+   private:
+      typedef std::vector<uint32_t> cell_t;
+
+      // segments spanning more cells go to large_
+      static size_t const large_cells = 64;
+
+      static double extent(segment_2 const & s)
+      {
+         return std::max(std::fabs(s[1].x - s[0].x), std::fabs(s[1].y - s[0].y));
+      }
+
+      int64_t coord(double v) const
+      {
+         return int64_t(std::floor(v / cell_));
+      }
+
+      // about the number of cells for_cells visits for s
+      double span(segment_2 const & s) const
+      {
+         return std::fabs(std::floor(s[1].x / cell_) - std::floor(s[0].x / cell_))
+              + std::fabs(std::floor(s[1].y / cell_) - std::floor(s[0].y / cell_)) + 1;
+      }
+
+      static uint64_t key(int64_t cx, int64_t cy)
+      {
+         return (uint64_t(cx) << 32) ^ (uint64_t(cy) & 0xffffffffu);
+      }
+
+      // cells a segment may pass through: per column, rows between the
+      // segment heights at the column borders, widened by the rounding error
+      template <class F>
+      void for_cells(segment_2 const & s, F f) const
+      {
+         point_2 a = s[0], b = s[1];
+         if (b.x < a.x)
+            std::swap(a, b);
+
+         int64_t c0 = coord(a.x), c1 = coord(b.x);
+         int64_t rmin = coord(std::min(a.y, b.y)), rmax = coord(std::max(a.y, b.y));
+
+         double slope = (c0 == c1) ? 0 : (b.y - a.y) / (b.x - a.x);
+         double ex = (std::max(std::fabs(a.x), std::fabs(b.x)) + cell_) * 1e-12;
+         double ey = (std::max(std::fabs(a.y), std::fabs(b.y)) + cell_) * 1e-12;
+
+         for (int64_t cx = c0; cx <= c1; ++cx)
+         {
+            int64_t r0 = rmin, r1 = rmax;
+            if (c0 != c1)
+            {
+               double xl = std::max(a.x, cx * cell_ - ex), xr = std::min(b.x, (cx + 1) * cell_ + ex);
+               double yl = a.y + (xl - a.x) * slope, yr = a.y + (xr - a.x) * slope;
+
+               r0 = std::max(rmin, coord(std::min(yl, yr) - ey));
+               r1 = std::min(rmax, coord(std::max(yl, yr) + ey));
+            }
+
+            for (int64_t cy = r0; cy <= r1; ++cy)
+               f(cx, cy);
+         }
+      }
+
+      template <class F>
+      void for_cells(rectangle_2 const & r, F f) const
+      {
+         for (int64_t cx = coord(r.x.inf); cx <= coord(r.x.sup); ++cx)
+            for (int64_t cy = coord(r.y.inf); cy <= coord(r.y.sup); ++cy)
+            {
+               auto it = cells_.find(key(cx, cy));
+               if (it != cells_.end())
+                  f(it->second);
+            }
+      }
+
+      void register_segment(size_t id)
+      {
+         if (span(segments_[id]) > large_cells)
+         {
+            large_.push_back(uint32_t(id));
+            return;
+         }
+
+         for_cells(segments_[id], [this, id] (int64_t cx, int64_t cy) { cells_[key(cx, cy)].push_back(uint32_t(id)); });
+      }
+
+      void unregister_segment(size_t id)
+      {
+         if (span(segments_[id]) > large_cells)
+         {
+            large_.erase(std::find(large_.begin(), large_.end(), uint32_t(id)));
+            return;
+         }
+
+         for_cells(segments_[id], [this, id] (int64_t cx, int64_t cy)
+         {
+            auto it = cells_.find(key(cx, cy));
+            if (it == cells_.end())
+               return;
+
+            cell_t & c = it->second;
+            c.erase(std::find(c.begin(), c.end(), uint32_t(id)));
+            if (c.empty())
+               cells_.erase(it);
+         });
+      }
+
+      void candidates(segment_2 const & s, std::vector<uint32_t> & ids) const
+      {
+         // a segment crossing more cells than the grid holds scans the segments
+         if (span(s) > cells_.size())
+         {
+            all_ids(ids);
+            return;
+         }
+
+         for_cells(s, [this, &ids] (int64_t cx, int64_t cy)
+         {
+            auto it = cells_.find(key(cx, cy));
+            if (it != cells_.end())
+               ids.insert(ids.end(), it->second.begin(), it->second.end());
+         });
+
+         ids.insert(ids.end(), large_.begin(), large_.end());
+         unique_ids(ids);
+      }
+
+      void all_ids(std::vector<uint32_t> & ids) const
+      {
+         for (size_t id = 0; id != segments_.size(); ++id)
+            if (alive_[id])
+               ids.push_back(uint32_t(id));
+      }
+
+      static void unique_ids(std::vector<uint32_t> & ids)
+      {
+         std::sort(ids.begin(), ids.end());
+         ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+      }
+
+      std::vector<segment_2> segments_;
+      std::vector<char> alive_;
+      std::vector<size_t> free_;
+
+      std::unordered_map<uint64_t, cell_t> cells_;
+      cell_t large_;
+
+      double cell_;
+      size_t count_, built_count_;
+      double extent_sum_;
+   };
+}
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+
+#include <boost/optional.hpp>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/segment.h>
+#include <cg/primitives/triangle.h>
+#include <cg/primitives/rectangle.h>
+#include <cg/operations/bounding_box.h>
+#include <cg/operations/contains/triangle_point.h>
+#include <cg/operations/has_intersection/segment_segment.h>
+#include <cg/operations/has_intersection/triangle_segment.h>
+#include <cg/operations/clip/rectangle_segment.h>
+
+namespace cg
+{
+   namespace detail
+   {
+      // parameter of s(t) = s[0] + t (s[1] - s[0]) where s enters t, s must intersect t.
+      // rounded, only used to order hits along s.
+      inline double entry_parameter(triangle_2 const & t, segment_2 const & s)
+      {
+         if (contains(t, s[0]) || s[0] == s[1])
+            return 0;
+
+         double dx = s[1].x - s[0].x, dy = s[1].y - s[0].y;
+         double res = 1;
+
+         for (size_t l = 0; l != 3; ++l)
+         {
+            segment_2 side = t.side(l);
+            if (!has_intersection(side, s))
+               continue;
+
+            double ex = side[1].x - side[0].x, ey = side[1].y - side[0].y;
+            double wx = side[0].x - s[0].x, wy = side[0].y - s[0].y;
+            double den = dx * ey - dy * ex;
+
+            double p;
+            if (den != 0)
+               p = (wx * ey - wy * ex) / den;
+            else
+            {
+               // collinear, the nearer end of the side
+               double len = dx * dx + dy * dy;
+               double p0 = (wx * dx + wy * dy) / len;
+               double p1 = ((side[1].x - s[0].x) * dx + (side[1].y - s[0].y) * dy) / len;
+               p = std::min(p0, p1);
+            }
+
+            res = std::min(res, std::max(0., p));
+         }
+
+         return std::min(1., res);
+      }
+   }
+
+   // bounding volume hierarchy over a triangle list, e.g. the output of triangulate.
+   // binary tree split at the median of the triangle centers along the longer
+   // axis, flattened in depth first order: the left child follows its parent.
+   // const members may be called concurrently.
+   struct triangle_bvh
+   {
+      explicit triangle_bvh(std::vector<triangle_2> const & triangles, size_t leaf_size = 4)
+         : leaf_size_(std::max<size_t>(1, leaf_size))
+      {
+         size_t n = triangles.size();
+         if (n == 0)
+            return;
+
+         std::vector<item> items(n);
+         for (size_t l = 0; l != n; ++l)
+         {
+            items[l].box = bounding_box(triangles[l]);
+            items[l].cx = items[l].box.x.inf / 2 + items[l].box.x.sup / 2;
+            items[l].cy = items[l].box.y.inf / 2 + items[l].box.y.sup / 2;
+            items[l].id = uint32_t(l);
+         }
+
+         nodes_.reserve(2 * (n / leaf_size_ + 1));
+         split(items, 0, n);
+
+         triangles_.resize(n);
+         ids_.resize(n);
+         for (size_t l = 0; l != n; ++l)
+         {
+            ids_[l] = items[l].id;
+            triangles_[l] = triangles[items[l].id];
+         }
+      }
+
+      size_t size() const { return triangles_.size(); }
+
+      // smallest index of a triangle containing q
+      boost::optional<size_t> locate(point_2 const & q) const
+      {
+         locate_cursor c(q);
+         while (c.step(*this)) {}
+         return c.result();
+      }
+
+      // index of the triangle s enters first going from s[0] to s[1],
+      // the smallest index among ties. hit tests are exact, the order of
+      // hits is decided by rounded parameters.
+      boost::optional<size_t> first_hit(segment_2 const & s) const
+      {
+         hit_cursor c(s);
+         while (c.step(*this)) {}
+         return c.result();
+      }
+
+      // batched forms write one boost::optional<size_t> per query. groups
+      // of queries are traversed in lock step, one node each in turn, so
+      // the memory latency of one query overlaps the work of the others.
+      template <class InputIter, class OutputIter>
+      OutputIter locate(InputIter first, InputIter last, OutputIter out) const
+      {
+         return batch<locate_cursor>(first, last, out);
+      }
+
+      template <class InputIter, class OutputIter>
+      OutputIter first_hit(InputIter first, InputIter last, OutputIter out) const
+      {
+         return batch<hit_cursor>(first, last, out);
+      }
+
+   private:
+      static size_t const group_size = 8;
+
+      struct item
+      {
+         rectangle_2 box;
+         double cx, cy;
+         uint32_t id;
+      };
+
+      // leaf if count != 0: triangles [first, first + count).
+      // inner otherwise: children at this + 1 and first.
+      struct node
+      {
+         rectangle_2 box;
+         uint32_t first, count;
+      };
+
+      size_t split(std::vector<item> & items, size_t lo, size_t hi)
+      {
+         size_t idx = nodes_.size();
+         nodes_.push_back(node());
+
+         rectangle_2 box, centers;
+         for (size_t l = lo; l != hi; ++l)
+         {
+            box = box | items[l].box;
+            centers = centers | rectangle_2(range(items[l].cx, items[l].cx), range(items[l].cy, items[l].cy));
+         }
+         nodes_[idx].box = box;
+
+         if (hi - lo <= leaf_size_)
+         {
+            nodes_[idx].first = uint32_t(lo);
+            nodes_[idx].count = uint32_t(hi - lo);
+            return idx;
+         }
+
+         size_t mid = lo + (hi - lo) / 2;
+         bool by_x = cg::size(centers.x) >= cg::size(centers.y);
+         std::nth_element(items.begin() + lo, items.begin() + mid, items.begin() + hi,
+                          [by_x] (item const & a, item const & b)
+                          { return by_x ? a.cx < b.cx : a.cy < b.cy; });
+
+         split(items, lo, mid);
+         size_t right = split(items, mid, hi);
+
+         nodes_[idx].first = uint32_t(right);
+         nodes_[idx].count = 0;
+         return idx;
+      }
+
+      static void prefetch(node const * nd)
+      {
+#if defined(__GNUC__)
+         __builtin_prefetch(nd);
+#else
+         (void)nd;
+#endif
+      }
+
+      // resumable traversals, step processes one node and returns false when done
+      struct locate_cursor
+      {
+         explicit locate_cursor(point_2 const & q = point_2())
+         {
+            reset(q);
+         }
+
+         // keeps the stack storage
+         void reset(point_2 const & query)
+         {
+            q = query;
+            best = std::numeric_limits<uint32_t>::max();
+            started = false;
+            stack.clear();
+         }
+
+         bool step(triangle_bvh const & t)
+         {
+            if (!started)
+            {
+               started = true;
+               if (!t.nodes_.empty())
+                  stack.push_back(0);
+            }
+
+            if (stack.empty())
+               return false;
+
+            uint32_t idx = stack.back();
+            stack.pop_back();
+
+            node const & nd = t.nodes_[idx];
+            if (!nd.box.contains(q))
+               return !stack.empty();
+
+            if (nd.count == 0)
+            {
+               stack.push_back(nd.first);
+               stack.push_back(idx + 1);
+               prefetch(&t.nodes_[idx + 1]);
+               prefetch(&t.nodes_[nd.first]);
+               return true;
+            }
+
+            for (uint32_t l = nd.first; l != nd.first + nd.count; ++l)
+               if (t.ids_[l] < best && contains(t.triangles_[l], q))
+                  best = t.ids_[l];
+
+            return !stack.empty();
+         }
+
+         boost::optional<size_t> result() const
+         {
+            if (best == std::numeric_limits<uint32_t>::max())
+               return boost::none;
+            return size_t(best);
+         }
+
+         point_2 q;
+         uint32_t best;
+         bool started;
+         std::vector<uint32_t> stack;
+      };
+
+      struct hit_cursor
+      {
+         explicit hit_cursor(segment_2 const & s = segment_2())
+         {
+            reset(s);
+         }
+
+         void reset(segment_2 const & query)
+         {
+            s = query;
+            best_t = 2;
+            best = std::numeric_limits<uint32_t>::max();
+            started = false;
+            stack.clear();
+         }
+
+         bool step(triangle_bvh const & t)
+         {
+            if (!started)
+            {
+               started = true;
+               if (!t.nodes_.empty())
+               {
+                  range r = clip(t.nodes_[0].box, s);
+                  if (!r.is_empty())
+                     stack.push_back(std::make_pair(0u, r.inf));
+               }
+            }
+
+            if (stack.empty())
+               return false;
+
+            uint32_t idx = stack.back().first;
+            double entry = stack.back().second;
+            stack.pop_back();
+
+            if (entry > best_t)
+               return !stack.empty();
+
+            node const & nd = t.nodes_[idx];
+            if (nd.count == 0)
+            {
+               std::pair<uint32_t, double> near(idx + 1, 0), far(nd.first, 0);
+               range a = clip(t.nodes_[near.first].box, s), b = clip(t.nodes_[far.first].box, s);
+               near.second = a.inf;
+               far.second = b.inf;
+
+               bool has_near = !a.is_empty(), has_far = !b.is_empty();
+               if (!has_near || (has_far && b.inf < a.inf))
+               {
+                  std::swap(near, far);
+                  std::swap(has_near, has_far);
+               }
+
+               // the nearer child goes on top of the stack
+               if (has_far)
+                  stack.push_back(far);
+               if (has_near)
+               {
+                  stack.push_back(near);
+                  prefetch(&t.nodes_[near.first]);
+               }
+
+               return !stack.empty();
+            }
+
+            for (uint32_t l = nd.first; l != nd.first + nd.count; ++l)
+            {
+               if (!has_intersection(t.triangles_[l], s))
+                  continue;
+
+               double p = detail::entry_parameter(t.triangles_[l], s);
+               if (p < best_t || (p == best_t && t.ids_[l] < best))
+               {
+                  best_t = p;
+                  best = t.ids_[l];
+               }
+            }
+
+            return !stack.empty();
+         }
+
+         boost::optional<size_t> result() const
+         {
+            if (best == std::numeric_limits<uint32_t>::max())
+               return boost::none;
+            return size_t(best);
+         }
+
+         segment_2 s;
+         double best_t;
+         uint32_t best;
+         bool started;
+         std::vector<std::pair<uint32_t, double> > stack;
+      };
+
+      template <class Cursor, class InputIter, class OutputIter>
+      OutputIter batch(InputIter first, InputIter last, OutputIter out) const
+      {
+         Cursor group[group_size];
+
+         while (first != last)
+         {
+            size_t cnt = 0;
+            for (; cnt != group_size && first != last; ++cnt, ++first)
+               group[cnt].reset(*first);
+
+            for (bool active = true; active; )
+            {
+               active = false;
+               for (size_t l = 0; l != cnt; ++l)
+                  active |= group[l].step(*this);
+            }
+
+            for (size_t l = 0; l != cnt; ++l)
+               *out++ = group[l].result();
+         }
+
+         return out;
+      }
+
+      size_t leaf_size_;
+      std::vector<node> nodes_;
+      std::vector<triangle_2> triangles_;
+      std::vector<uint32_t> ids_;
+   };
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include <cg/primitives/contour.h>
+#include <cg/primitives/triangle.h>
+#include <cg/triangulation/delaunay.h>
+#include <cg/triangulation/indexed_mesh.h>
+
+namespace cg
+{
+   namespace detail
+   {
+      // delaunay triangulation of the polygon vertices with the contour
+      // edges inserted as constraints. vertex ids are the contours
+      // concatenated, as in triangulate.
+      inline void constrain_polygon(std::vector<contour_2> const & polygon, delaunay_triangulation & dt)
+      {
+         std::vector<point_2> pts;
+         for (contour_2 const & c : polygon)
+            pts.insert(pts.end(), c.begin(), c.end());
+
+         dt = delaunay_triangulation(pts);
+
+         uint32_t first = 0;
+         for (contour_2 const & c : polygon)
+         {
+            uint32_t n = uint32_t(c.size());
+            for (uint32_t i = 0; i != n; ++i)
+               dt.insert_constraint(first + i, first + (i + 1) % n);
+            first += n;
+         }
+      }
+
+      // triangles inside the polygon: crossing a contour flips between the
+      // outside, where the ghost triangles are, and the inside
+      inline std::vector<uint32_t> interior_triangles(delaunay_triangulation const & dt)
+      {
+         uint32_t const unknown = uint32_t(-1);
+         size_t n = dt.half_edges_num() / 3;
+
+         std::vector<uint32_t> depth(n, unknown), stack;
+         for (uint32_t t = 0; t != n; ++t)
+            if (dt.is_ghost(t))
+            {
+               depth[t] = 0;
+               stack.push_back(t);
+            }
+
+         while (!stack.empty())
+         {
+            uint32_t t = stack.back();
+            stack.pop_back();
+
+            for (uint32_t e = 3 * t; e != 3 * t + 3; ++e)
+            {
+               uint32_t s = dt.twin(e) / 3;
+               if (depth[s] == unknown)
+               {
+                  depth[s] = depth[t] + dt.constrained(e);
+                  stack.push_back(s);
+               }
+            }
+         }
+
+         std::vector<uint32_t> res;
+         for (uint32_t t = 0; t != n; ++t)
+            if (depth[t] % 2 == 1 && !dt.is_ghost(t))
+               res.push_back(t);
+         return res;
+      }
+   }
+
+   // constrained delaunay triangulation of the polygon (outer contour ccw,
+   // holes cw): the contour edges are kept and no other triangle has a
+   // vertex it sees inside its circumcircle, so there are no needless
+   // slivers. replaces the contents of mesh, same layout as triangulate.
+   inline void constrained_delaunay(std::vector<contour_2> const & polygon, indexed_mesh & mesh, bool contour_ids = false)
+   {
+      delaunay_triangulation dt;
+      detail::constrain_polygon(polygon, dt);
+      std::vector<uint32_t> tris = detail::interior_triangles(dt);
+
+      mesh.clear();
+      mesh.contour_offsets.push_back(0);
+      for (contour_2 const & c : polygon)
+         mesh.contour_offsets.push_back(uint32_t(mesh.contour_offsets.back() + c.size()));
+
+      mesh.vertices = dt.points();
+      mesh.indices.reserve(3 * tris.size());
+      for (uint32_t t : tris)
+         for (uint32_t e = 3 * t; e != 3 * t + 3; ++e)
+            mesh.indices.push_back(dt.origin(e));
+
+      if (contour_ids)
+      {
+         mesh.triangle_contours.resize(mesh.triangles_num());
+         for (size_t t = 0; t != mesh.triangles_num(); ++t)
+         {
+            uint32_t const * i = &mesh.indices[3 * t];
+            mesh.triangle_contours[t] = uint32_t(mesh.contour(*std::min_element(i, i + 3)));
+         }
+      }
+   }
+
+   inline indexed_mesh constrained_delaunay_indexed(std::vector<contour_2> const & polygon, bool contour_ids = false)
+   {
+      indexed_mesh mesh;
+      constrained_delaunay(polygon, mesh, contour_ids);
+      return mesh;
+   }
+
+   inline std::vector<triangle_2> constrained_delaunay(std::vector<contour_2> const & polygon)
+   {
+      delaunay_triangulation dt;
+      detail::constrain_polygon(polygon, dt);
+      std::vector<uint32_t> tris = detail::interior_triangles(dt);
+
+      std::vector<triangle_2> res;
+      res.reserve(tris.size());
+      for (uint32_t t : tris)
+         res.push_back(dt.triangle(t));
+      return res;
+   }
+}
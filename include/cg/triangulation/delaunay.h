@@ -0,0 +1,674 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+
+#include <boost/optional.hpp>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/triangle.h>
+#include <cg/operations/orientation.h>
+#include <cg/operations/in_circle.h>
+#include <cg/spatial/hilbert_sort.h>
+#include <cg/triangulation/indexed_mesh.h>
+
+namespace cg
+{
+   namespace detail
+   {
+      // the vertex at infinity shared by all ghost triangles
+      uint32_t const infinite_vertex = uint32_t(-1);
+   }
+
+   // delaunay triangulation of a point set by incremental insertion with
+   // lawson flips. triangles are stored in flat arrays: half-edge e = 3 t + i
+   // of triangle t goes from origin(e) to origin(next(e)), twin(e) is the
+   // half-edge across it. every hull edge carries a ghost triangle with the
+   // infinite vertex, so every half-edge has a twin and points outside the
+   // hull are inserted like the ones inside. vertex ids are indices into
+   // points(): the input of the constructor followed by the inserted points.
+   struct delaunay_triangulation
+   {
+      delaunay_triangulation()
+         : hint_(0)
+      {}
+
+      // inserts pts in hilbert curve order, vertex l is pts[l]
+      explicit delaunay_triangulation(std::vector<point_2> const & pts)
+         : points_(pts)
+         , hint_(0)
+      {
+         hilbert_sort(points_, ids_);
+
+         pts_.resize(pts.size());
+         ranks_.resize(pts.size());
+         for (size_t l = 0; l != pts.size(); ++l)
+         {
+            pts_[l] = pts[ids_[l]];
+            ranks_[ids_[l]] = uint32_t(l);
+         }
+         out_.assign(pts.size(), detail::infinite_vertex);
+
+         vertices_.reserve(6 * pts.size() + 16);
+         twins_.reserve(6 * pts.size() + 16);
+         constrained_.reserve(6 * pts.size() + 16);
+
+         for (size_t l = 0; l != pts.size(); ++l)
+            insert_vertex(uint32_t(l));
+      }
+
+      // equal points get their own id but only the first one is used,
+      // returns false for such a point
+      bool insert(point_2 const & p)
+      {
+         return insert_vertex(add_point(p));
+      }
+
+      // the same with the search for p started at triangle t, e.g. one
+      // known to be near p
+      bool insert(point_2 const & p, uint32_t t)
+      {
+         hint_ = t;
+         return insert(p);
+      }
+
+      // inserts p as a vertex splitting the finite edge e even where
+      // rounding put p beside it, e.g. the midpoint of a constrained edge,
+      // whose halves stay constrained
+      void split(uint32_t e, point_2 const & p)
+      {
+         uint32_t v = add_point(p);
+         split_edge(e, v);
+         legalize(v);
+      }
+
+      std::vector<point_2> const & points() const { return points_; }
+      point_2 const & point(uint32_t v) const     { return points_[v]; }
+
+      // half-edges of finite and ghost triangles
+      size_t half_edges_num() const { return vertices_.size(); }
+
+      // infinite_vertex for the apex of a ghost triangle
+      uint32_t origin(uint32_t e) const
+      {
+         return vertices_[e] == detail::infinite_vertex ? detail::infinite_vertex : ids_[vertices_[e]];
+      }
+
+      uint32_t twin(uint32_t e) const   { return twins_[e]; }
+
+      // a half-edge out of vertex v, infinite_vertex if v is skipped as
+      // equal to another one. turning it ccw passes every triangle around v.
+      uint32_t out(uint32_t v) const { return out_[ranks_[v]]; }
+
+      // e is a constrained edge, never flipped
+      bool constrained(uint32_t e) const { return constrained_[e] != 0; }
+
+      static uint32_t next(uint32_t e) { return e % 3 == 2 ? e - 2 : e + 1; }
+      static uint32_t prev(uint32_t e) { return e % 3 == 0 ? e + 2 : e - 1; }
+
+      bool is_ghost(uint32_t t) const
+      {
+         return vertices_[3 * t] == detail::infinite_vertex
+             || vertices_[3 * t + 1] == detail::infinite_vertex
+             || vertices_[3 * t + 2] == detail::infinite_vertex;
+      }
+
+      // finite triangles
+      size_t triangles_num() const
+      {
+         size_t res = 0;
+         for (uint32_t t = 0; t != vertices_.size() / 3; ++t)
+            res += !is_ghost(t);
+         return res;
+      }
+
+      triangle_2 triangle(uint32_t t) const
+      {
+         return triangle_2(pts_[vertices_[3 * t]], pts_[vertices_[3 * t + 1]], pts_[vertices_[3 * t + 2]]);
+      }
+
+      // finite triangles, ccw
+      template <class OutIter>
+      OutIter triangles(OutIter out) const
+      {
+         for (uint32_t t = 0; t != vertices_.size() / 3; ++t)
+            if (!is_ghost(t))
+               *out++ = triangle(t);
+         return out;
+      }
+
+      // finite triangles over all inserted points, without contours
+      void mesh(indexed_mesh & res) const
+      {
+         res.clear();
+         res.vertices = points_;
+         for (uint32_t t = 0; t != vertices_.size() / 3; ++t)
+            if (!is_ghost(t))
+               for (uint32_t e = 3 * t; e != 3 * t + 3; ++e)
+                  res.indices.push_back(ids_[vertices_[e]]);
+      }
+
+      // makes the segment between vertices a and b an edge of the
+      // triangulation and keeps it through later insertions, the result is
+      // the constrained delaunay triangulation. vertices on the segment split
+      // it, segments must not cross each other.
+      void insert_constraint(uint32_t a, uint32_t b)
+      {
+         if (vertices_.empty())
+            return;
+
+         insert_segment(vertex(a), vertex(b));
+      }
+
+      // a finite triangle containing p, none outside the hull
+      boost::optional<uint32_t> locate(point_2 const & p) const
+      {
+         if (vertices_.empty())
+            return boost::none;
+
+         location loc = walk(p);
+         if (loc.type == OUTSIDE)
+            return boost::none;
+
+         return loc.edge / 3;
+      }
+
+   private:
+      enum location_t { INSIDE, ON_EDGE, ON_VERTEX, OUTSIDE };
+
+      struct location
+      {
+         location_t type;
+         uint32_t edge;
+      };
+
+      uint32_t add_point(point_2 const & p)
+      {
+         ids_.push_back(uint32_t(points_.size()));
+         points_.push_back(p);
+         pts_.push_back(p);
+         ranks_.push_back(uint32_t(pts_.size() - 1));
+         out_.push_back(detail::infinite_vertex);
+         return uint32_t(pts_.size() - 1);
+      }
+
+      uint32_t new_triangle(uint32_t a, uint32_t b, uint32_t c)
+      {
+         vertices_.push_back(a);
+         vertices_.push_back(b);
+         vertices_.push_back(c);
+         twins_.push_back(detail::infinite_vertex);
+         twins_.push_back(detail::infinite_vertex);
+         twins_.push_back(detail::infinite_vertex);
+         constrained_.resize(vertices_.size());
+
+         uint32_t t = uint32_t(vertices_.size() / 3 - 1);
+         set_out(t);
+         return t;
+      }
+
+      void set_triangle(uint32_t t, uint32_t a, uint32_t b, uint32_t c)
+      {
+         vertices_[3 * t] = a;
+         vertices_[3 * t + 1] = b;
+         vertices_[3 * t + 2] = c;
+         set_out(t);
+      }
+
+      // every vertex of a changed triangle is in one of the new ones, so
+      // out_ stays valid if each new triangle claims its vertices
+      void set_out(uint32_t t)
+      {
+         for (uint32_t e = 3 * t; e != 3 * t + 3; ++e)
+            if (vertices_[e] != detail::infinite_vertex)
+               out_[vertices_[e]] = e;
+      }
+
+      // a new edge between modified triangles
+      void link(uint32_t e, uint32_t f)
+      {
+         twins_[e] = f;
+         twins_[f] = e;
+         constrained_[e] = constrained_[f] = 0;
+      }
+
+      // e takes the place of the twin of the untouched half-edge f
+      void attach(uint32_t e, uint32_t f)
+      {
+         twins_[e] = f;
+         twins_[f] = e;
+         constrained_[e] = constrained_[f];
+      }
+
+      // a finite triangle next to the last insertion
+      uint32_t start_triangle() const
+      {
+         uint32_t t = hint_;
+         if (!is_ghost(t))
+            return t;
+
+         for (uint32_t e = 3 * t; e != 3 * t + 3; ++e)
+            if (vertices_[e] != detail::infinite_vertex && vertices_[next(e)] != detail::infinite_vertex)
+               return twins_[e] / 3;
+
+         return t;
+      }
+
+      // visibility walk that tries the sides of each triangle from a
+      // pseudo-random one, so it terminates in constrained triangulations
+      // as well. ends in the finite triangle containing p or in a ghost
+      // triangle seeing it.
+      location walk(point_2 const & p) const
+      {
+         uint32_t t = start_triangle();
+         uint32_t from = detail::infinite_vertex;
+         uint32_t random = t;
+
+         for (;;)
+         {
+            if (is_ghost(t))
+            {
+               location res = {OUTSIDE, 3 * t};
+               return res;
+            }
+
+            random = random * 1664525 + 1013904223;
+            uint32_t first = (random >> 16) % 3;
+
+            uint32_t on[3], on_count = 0;
+            bool moved = false;
+            for (uint32_t k = first; k != first + 3; ++k)
+            {
+               uint32_t e = 3 * t + k % 3;
+               if (e == from)
+                  continue;
+
+               orientation_t o = orientation(pts_[vertices_[e]], pts_[vertices_[next(e)]], p);
+               if (o == CG_RIGHT)
+               {
+                  from = twins_[e];
+                  t = from / 3;
+                  moved = true;
+                  break;
+               }
+
+               if (o == CG_COLLINEAR)
+                  on[on_count++] = e;
+            }
+
+            if (moved)
+               continue;
+
+            if (on_count == 0)
+            {
+               location res = {INSIDE, 3 * t};
+               return res;
+            }
+
+            if (on_count == 1)
+            {
+               location res = {ON_EDGE, on[0]};
+               return res;
+            }
+
+            // on two sides, at their common vertex
+            location res = {ON_VERTEX, next(on[0]) == on[1] ? on[1] : on[0]};
+            return res;
+         }
+      }
+
+      // would p be inside the circumcircle of t. for a ghost triangle
+      // (x, y, infinite) the circle degenerates to the open half-plane
+      // left of x -> y, beyond the hull edge y -> x.
+      bool conflict(uint32_t t, point_2 const & p) const
+      {
+         uint32_t a = vertices_[3 * t], b = vertices_[3 * t + 1], c = vertices_[3 * t + 2];
+         if (a == detail::infinite_vertex)
+            return orientation(pts_[b], pts_[c], p) == CG_LEFT;
+         if (b == detail::infinite_vertex)
+            return orientation(pts_[c], pts_[a], p) == CG_LEFT;
+         if (c == detail::infinite_vertex)
+            return orientation(pts_[a], pts_[b], p) == CG_LEFT;
+
+         return in_circle(pts_[a], pts_[b], pts_[c], p) == CG_INSIDE;
+      }
+
+      bool insert_vertex(uint32_t v)
+      {
+         if (vertices_.empty())
+            return start(v);
+
+         location loc = walk(pts_[v]);
+         if (loc.type == ON_VERTEX)
+            return false;
+
+         if (loc.type == ON_EDGE)
+            split_edge(loc.edge, v);
+         else
+            split_triangle(loc.edge / 3, v);
+
+         legalize(v);
+         return true;
+      }
+
+      // collects points until three of them are not collinear
+      bool start(uint32_t v)
+      {
+         point_2 const & p = pts_[v];
+         for (uint32_t u : pending_)
+            if (pts_[u] == p)
+               return false;
+
+         if (pending_.size() < 2)
+         {
+            pending_.push_back(v);
+            return true;
+         }
+
+         orientation_t o = orientation(pts_[pending_[0]], pts_[pending_[1]], p);
+         if (o == CG_COLLINEAR)
+         {
+            pending_.push_back(v);
+            return true;
+         }
+
+         uint32_t a = pending_[0], b = pending_[1];
+         if (o == CG_RIGHT)
+            std::swap(a, b);
+
+         uint32_t const inf = detail::infinite_vertex;
+         uint32_t t = new_triangle(a, b, v);
+         uint32_t g0 = new_triangle(b, a, inf), g1 = new_triangle(v, b, inf), g2 = new_triangle(a, v, inf);
+         link(3 * t, 3 * g0);
+         link(3 * t + 1, 3 * g1);
+         link(3 * t + 2, 3 * g2);
+         link(3 * g0 + 1, 3 * g2 + 2);
+         link(3 * g1 + 1, 3 * g0 + 2);
+         link(3 * g2 + 1, 3 * g1 + 2);
+         hint_ = t;
+
+         std::vector<uint32_t> rest(pending_.begin() + 2, pending_.end());
+         pending_.clear();
+         for (size_t l = 0; l != rest.size(); ++l)
+            insert_vertex(rest[l]);
+         return true;
+      }
+
+      // (a, b, c) -> (a, b, v), (b, c, v), (c, a, v)
+      void split_triangle(uint32_t t, uint32_t v)
+      {
+         uint32_t a = vertices_[3 * t], b = vertices_[3 * t + 1], c = vertices_[3 * t + 2];
+         uint32_t tb = twins_[3 * t + 1], tc = twins_[3 * t + 2];
+
+         set_triangle(t, a, b, v);
+         uint32_t t1 = new_triangle(b, c, v), t2 = new_triangle(c, a, v);
+
+         attach(3 * t1, tb);
+         attach(3 * t2, tc);
+         link(3 * t + 1, 3 * t1 + 2);
+         link(3 * t1 + 1, 3 * t2 + 2);
+         link(3 * t2 + 1, 3 * t + 2);
+
+         stack_.push_back(3 * t);
+         stack_.push_back(3 * t1);
+         stack_.push_back(3 * t2);
+         hint_ = t;
+      }
+
+      // e = a -> b in (a, b, c), twin in (b, a, d):
+      // (v, b, c), (a, v, c), (v, a, d), (b, v, d)
+      void split_edge(uint32_t e, uint32_t v)
+      {
+         uint32_t f = twins_[e];
+         uint32_t t = e / 3, s = f / 3;
+         uint32_t a = vertices_[e], b = vertices_[next(e)], c = vertices_[prev(e)];
+         uint32_t d = vertices_[prev(f)];
+         uint32_t bc = twins_[next(e)], ca = twins_[prev(e)];
+         uint32_t ad = twins_[next(f)], db = twins_[prev(f)];
+         uint8_t split = constrained_[e];
+
+         set_triangle(t, v, b, c);
+         set_triangle(s, v, a, d);
+         uint32_t t1 = new_triangle(a, v, c), s1 = new_triangle(b, v, d);
+
+         attach(3 * t + 1, bc);
+         attach(3 * t1 + 2, ca);
+         attach(3 * s + 1, ad);
+         attach(3 * s1 + 2, db);
+
+         link(3 * t, 3 * s1);
+         link(3 * t1, 3 * s);
+         link(3 * t + 2, 3 * t1 + 1);
+         link(3 * s + 2, 3 * s1 + 1);
+
+         // both halves of a split constraint stay constrained
+         constrained_[3 * t] = constrained_[3 * s1] = split;
+         constrained_[3 * t1] = constrained_[3 * s] = split;
+
+         stack_.push_back(3 * t + 1);
+         stack_.push_back(3 * t1 + 2);
+         stack_.push_back(3 * s + 1);
+         stack_.push_back(3 * s1 + 2);
+         hint_ = t;
+      }
+
+      // (a, b, v) and (b, a, q) across e = a -> b become (v, a, q) and
+      // (v, q, b) in the same triangles, returns the half-edge v -> q
+      uint32_t flip(uint32_t e)
+      {
+         uint32_t f = twins_[e];
+         uint32_t t = e / 3, s = f / 3;
+         uint32_t a = vertices_[e], b = vertices_[next(e)], v = vertices_[prev(e)], q = vertices_[prev(f)];
+         uint32_t bv = twins_[next(e)], va = twins_[prev(e)];
+         uint32_t aq = twins_[next(f)], qb = twins_[prev(f)];
+
+         set_triangle(t, v, a, q);
+         set_triangle(s, v, q, b);
+         attach(3 * t, va);
+         attach(3 * t + 1, aq);
+         link(3 * t + 2, 3 * s);
+         attach(3 * s + 1, qb);
+         attach(3 * s + 2, bv);
+         return 3 * s;
+      }
+
+      // stack_ holds half-edges opposite v in triangles around v
+      void legalize(uint32_t v)
+      {
+         point_2 const & p = pts_[v];
+         while (!stack_.empty())
+         {
+            uint32_t e = stack_.back();
+            stack_.pop_back();
+
+            uint32_t f = twins_[e];
+            if (constrained_[e] || !conflict(f / 3, p))
+               continue;
+
+            uint32_t t = e / 3, s = f / 3;
+            flip(e);
+            stack_.push_back(3 * t + 1);
+            stack_.push_back(3 * s + 1);
+         }
+
+         if (is_ghost(hint_))
+            for (uint32_t e = 3 * hint_; e != 3 * hint_ + 3; ++e)
+               if (!is_ghost(twins_[e] / 3))
+               {
+                  hint_ = twins_[e] / 3;
+                  break;
+               }
+      }
+
+      void constrain(uint32_t e)
+      {
+         constrained_[e] = constrained_[twins_[e]] = 1;
+      }
+
+      // the vertex in the triangulation at the point with id v, which is
+      // the first one inserted of equal points
+      uint32_t vertex(uint32_t v) const
+      {
+         uint32_t u = ranks_[v];
+         if (out_[u] != detail::infinite_vertex)
+            return u;
+
+         return vertices_[walk(points_[v]).edge];
+      }
+
+      // the half-edge u -> w, infinite_vertex if there is none
+      uint32_t find_edge(uint32_t u, uint32_t w) const
+      {
+         uint32_t e = out_[u], first = e;
+         do
+         {
+            if (vertices_[next(e)] == w)
+               return e;
+            e = twins_[prev(e)];
+         }
+         while (e != first);
+
+         return detail::infinite_vertex;
+      }
+
+      // makes a -> b a constrained edge: the edges crossing the segment are
+      // flipped away (sloan), each one as soon as its quadrilateral is
+      // convex, then the edges made by the flips are flipped back to
+      // delaunay. a vertex on the segment ends it and the rest is inserted
+      // from there.
+      void insert_segment(uint32_t a, uint32_t b)
+      {
+         uint32_t const inf = detail::infinite_vertex;
+
+         while (a != b)
+         {
+            point_2 const & pa = pts_[a], & pb = pts_[b];
+
+            // the triangle at a the segment goes into, or an edge along it
+            uint32_t e = out_[a], first = e, cross = inf;
+            for (;;)
+            {
+               uint32_t c = vertices_[next(e)], d = vertices_[prev(e)];
+               if (c == b)
+                  break;
+
+               if (c != inf)
+               {
+                  orientation_t o = orientation(pa, pb, pts_[c]);
+                  if (o == CG_COLLINEAR && (pa < pts_[c]) == (pa < pb))
+                     break;
+
+                  if (d != inf && o == CG_RIGHT && orientation(pa, pb, pts_[d]) == CG_LEFT)
+                  {
+                     cross = next(e);
+                     break;
+                  }
+               }
+
+               e = twins_[prev(e)];
+               if (e == first)
+                  return;
+            }
+
+            if (cross == inf)
+            {
+               constrain(e);
+               a = vertices_[next(e)];
+               continue;
+            }
+
+            // the crossed edges up to b or the first vertex on the segment
+            crossing_.clear();
+            uint32_t end;
+            for (;;)
+            {
+               crossing_.push_back(std::make_pair(vertices_[cross], vertices_[next(cross)]));
+
+               uint32_t f = twins_[cross];
+               uint32_t q = vertices_[prev(f)];
+               orientation_t o = q == b ? CG_COLLINEAR : orientation(pa, pb, pts_[q]);
+               if (o == CG_COLLINEAR)
+               {
+                  end = q;
+                  break;
+               }
+
+               cross = o == CG_LEFT ? next(f) : prev(f);
+            }
+
+            point_2 const & pe = pts_[end];
+            created_.clear();
+            for (size_t l = 0; l != crossing_.size(); ++l)
+            {
+               uint32_t u = crossing_[l].first, w = crossing_[l].second;
+               uint32_t h = find_edge(u, w);
+               uint32_t p = vertices_[prev(h)], q = vertices_[prev(twins_[h])];
+
+               if (orientation(pts_[p], pts_[u], pts_[q]) != CG_LEFT || orientation(pts_[p], pts_[q], pts_[w]) != CG_LEFT)
+               {
+                  crossing_.push_back(crossing_[l]);
+                  continue;
+               }
+
+               flip(h);
+               hint_ = h / 3;
+
+               orientation_t op = orientation(pa, pe, pts_[p]), oq = orientation(pa, pe, pts_[q]);
+               if (opposite(op, oq) && opposite(orientation(pts_[p], pts_[q], pa), orientation(pts_[p], pts_[q], pe)))
+                  crossing_.push_back(op == CG_RIGHT ? std::make_pair(p, q) : std::make_pair(q, p));
+               else
+                  created_.push_back(std::make_pair(p, q));
+            }
+
+            constrain(find_edge(a, end));
+
+            while (!created_.empty())
+            {
+               uint32_t u = created_.back().first, w = created_.back().second;
+               created_.pop_back();
+
+               uint32_t h = find_edge(u, w);
+               if (h == inf || constrained_[h] || is_ghost(h / 3) || is_ghost(twins_[h] / 3))
+                  continue;
+
+               uint32_t p = vertices_[prev(h)], q = vertices_[prev(twins_[h])];
+               if (in_circle(pts_[u], pts_[w], pts_[p], pts_[q]) != CG_INSIDE)
+                  continue;
+
+               flip(h);
+               created_.push_back(std::make_pair(p, u));
+               created_.push_back(std::make_pair(u, q));
+               created_.push_back(std::make_pair(q, w));
+               created_.push_back(std::make_pair(w, p));
+            }
+
+            a = end;
+         }
+      }
+
+      // points_ in input order, pts_ in insertion order with ids_[l] the
+      // input index of pts_[l] and ranks_ the inverse. triangles refer to
+      // pts_, so the predicates of consecutive insertions read nearby memory.
+      std::vector<point_2> points_, pts_;
+      std::vector<uint32_t> ids_, ranks_;
+
+      std::vector<uint32_t> vertices_;
+      std::vector<uint32_t> twins_;
+      std::vector<uint8_t> constrained_;
+
+      // a half-edge out of every vertex of the triangulation, infinite_vertex
+      // for points skipped as equal to a vertex
+      std::vector<uint32_t> out_;
+
+      // collinear points waiting for the first triangle
+      std::vector<uint32_t> pending_;
+
+      std::vector<uint32_t> stack_;
+      uint32_t hint_;
+
+      // buffers of insert_segment
+      std::vector<std::pair<uint32_t, uint32_t> > crossing_, created_;
+   };
+}
@@ -0,0 +1,456 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <cstdint>
+
+#include <cg/primitives/point.h>
+#include <cg/operations/orientation.h>
+#include <cg/operations/in_circle.h>
+#include <cg/triangulation/indexed_mesh.h>
+#include <cg/triangulation/half_edge_mesh.h>
+#include <cg/common/parallel.h>
+
+namespace cg
+{
+   namespace detail
+   {
+      // org of a deleted or unused half-edge
+      uint32_t const dc_dead = uint32_t(-1);
+
+      // ranges at least this long are split between two threads
+      uint32_t const dc_min_parallel = 1 << 14;
+
+      // guibas-stolfi divide and conquer with alternating cuts: the points
+      // are split at the median of x, then of y on the next level and so on,
+      // which keeps the subproblems square and the merges short. a split
+      // by y is a split by x in the frame rotated by 90 degrees, where the
+      // order of points is (y, -x); the predicates do not depend on the
+      // frame, only the extreme points of the hulls do.
+      //
+      // edge q is the pair of half-edges 2 q, 2 q + 1, onext_ and oprev_
+      // link the half-edges leaving a vertex into a ccw ring, which is the
+      // primal half of a quad-edge.
+      //
+      // the range [lo, hi) of partitioned points owns the edges [3 lo, 3 hi).
+      // a planar graph on m vertices has fewer than 3 m edges, so the halves
+      // built by different threads never share an edge, and deleted edges
+      // are reused through the free list of the pool of their range.
+      struct delaunay_dc
+      {
+         struct edge_pool
+         {
+            std::vector<uint32_t> free;
+            std::vector<std::pair<uint32_t, uint32_t> > spans;
+
+            uint32_t alloc()
+            {
+               if (!free.empty())
+               {
+                  uint32_t q = free.back();
+                  free.pop_back();
+                  return q;
+               }
+
+               while (spans.back().first == spans.back().second)
+                  spans.pop_back();
+
+               return spans.back().first++;
+            }
+
+            void splice(edge_pool & other)
+            {
+               free.insert(free.end(), other.free.begin(), other.free.end());
+               spans.insert(spans.end(), other.spans.begin(), other.spans.end());
+            }
+         };
+
+         struct input_point
+         {
+            point_2 p;
+            uint32_t id;
+         };
+
+         delaunay_dc(std::vector<point_2> const & pts, size_t threads)
+         {
+            std::vector<input_point> sorted(pts.size());
+            common::parallel_for(0, pts.size(), [&] (size_t l)
+            {
+               sorted[l].p = pts[l];
+               sorted[l].id = uint32_t(l);
+            }, threads, 1 << 16);
+
+            common::parallel_sort(sorted.begin(), sorted.end(), [] (input_point const & a, input_point const & b)
+            {
+               return a.p < b.p || (a.p == b.p && a.id < b.id);
+            }, threads);
+
+            // equal points keep the smallest id
+            sorted.erase(std::unique(sorted.begin(), sorted.end(), [] (input_point const & a, input_point const & b)
+            {
+               return a.p == b.p;
+            }), sorted.end());
+
+            uint32_t n = uint32_t(sorted.size());
+            size_t depth = 0;
+            while ((size_t(1) << depth) < threads)
+               ++depth;
+
+            partition(sorted, 0, n, 0, depth);
+
+            points_.resize(n);
+            ids_.resize(n);
+            for (size_t l = 0; l != n; ++l)
+            {
+               points_[l] = sorted[l].p;
+               ids_[l] = sorted[l].id;
+            }
+
+            org_.assign(6 * size_t(n), dc_dead);
+            onext_.resize(6 * size_t(n));
+            oprev_.resize(6 * size_t(n));
+
+            if (n < 2)
+               return;
+
+            edge_pool pool;
+            build(0, n, 0, depth, pool);
+         }
+
+         // finite triangles as ccw triples of input ids. with twins, also
+         // the half-edge across each side of them, numbered like res, or
+         // no_twin on the hull.
+         void triangles(std::vector<uint32_t> & res, size_t threads, std::vector<uint32_t> * twins = 0) const
+         {
+            size_t m = org_.size();
+            size_t blocks = std::max<size_t>(1, std::min(4 * threads, m / 4096));
+            size_t block = (m + blocks - 1) / blocks;
+
+            // the first half-edge of every triangle, by block
+            std::vector<std::vector<uint32_t> > parts(blocks);
+            common::parallel_for(0, blocks, [&] (size_t b)
+            {
+               for (size_t e = b * block; e < std::min(m, (b + 1) * block); ++e)
+                  if (is_triangle(uint32_t(e)))
+                     parts[b].push_back(uint32_t(e));
+            }, threads);
+
+            std::vector<size_t> first(blocks + 1);
+            for (size_t b = 0; b != blocks; ++b)
+               first[b + 1] = first[b] + parts[b].size();
+
+            res.resize(3 * first.back());
+            common::parallel_for(0, blocks, [&] (size_t b)
+            {
+               uint32_t * out = res.data() + 3 * first[b];
+               for (size_t l = 0; l != parts[b].size(); ++l)
+               {
+                  uint32_t e = parts[b][l], f = lnext(e);
+                  *out++ = ids_[org_[e]];
+                  *out++ = ids_[org_[f]];
+                  *out++ = ids_[org_[lnext(f)]];
+               }
+            }, threads);
+
+            if (!twins)
+               return;
+
+            // mesh half-edge of every quad-edge half-edge, then across
+            std::vector<uint32_t> sides(m, no_twin);
+            common::parallel_for(0, blocks, [&] (size_t b)
+            {
+               for (size_t l = 0; l != parts[b].size(); ++l)
+               {
+                  uint32_t e = parts[b][l], t = uint32_t(3 * (first[b] + l));
+                  sides[e] = t;
+                  sides[lnext(e)] = t + 1;
+                  sides[lnext(lnext(e))] = t + 2;
+               }
+            }, threads);
+
+            twins->resize(res.size());
+            common::parallel_for(0, blocks, [&] (size_t b)
+            {
+               for (size_t l = 0; l != parts[b].size(); ++l)
+               {
+                  uint32_t e = parts[b][l], t = uint32_t(3 * (first[b] + l));
+                  for (uint32_t i = 0; i != 3; ++i, e = lnext(e))
+                     (*twins)[t + i] = sides[sym(e)];
+               }
+            }, threads);
+         }
+
+      private:
+         // lexicographic order of the frame of the cut
+         static bool less(point_2 const & a, point_2 const & b, int axis)
+         {
+            if (axis == 0)
+               return a < b;
+
+            return a.y < b.y || (a.y == b.y && a.x > b.x);
+         }
+
+         // splits [lo, hi) at the median, recursively, the way build does
+         static void partition(std::vector<input_point> & pts, uint32_t lo, uint32_t hi, int axis, size_t depth)
+         {
+            auto cmp = [axis] (input_point const & a, input_point const & b) { return less(a.p, b.p, axis); };
+
+            if (hi - lo <= 3)
+            {
+               std::sort(pts.begin() + lo, pts.begin() + hi, cmp);
+               return;
+            }
+
+            uint32_t mid = lo + (hi - lo) / 2;
+            std::nth_element(pts.begin() + lo, pts.begin() + mid, pts.begin() + hi, cmp);
+
+            if (depth == 0 || hi - lo < dc_min_parallel)
+            {
+               partition(pts, lo, mid, 1 - axis, 0);
+               partition(pts, mid, hi, 1 - axis, 0);
+               return;
+            }
+
+            std::thread worker([&] { partition(pts, mid, hi, 1 - axis, depth - 1); });
+            partition(pts, lo, mid, 1 - axis, depth - 1);
+            worker.join();
+         }
+
+         static uint32_t sym(uint32_t e) { return e ^ 1; }
+
+         uint32_t dest(uint32_t e)  const { return org_[sym(e)]; }
+         uint32_t lnext(uint32_t e) const { return oprev_[sym(e)]; }
+         uint32_t rprev(uint32_t e) const { return onext_[sym(e)]; }
+
+         point_2 const & org_point(uint32_t e)  const { return points_[org_[e]]; }
+         point_2 const & dest_point(uint32_t e) const { return points_[dest(e)]; }
+
+         bool right_of(point_2 const & p, uint32_t e) const
+         {
+            return orientation(p, dest_point(e), org_point(e)) == CG_LEFT;
+         }
+
+         bool left_of(point_2 const & p, uint32_t e) const
+         {
+            return orientation(p, org_point(e), dest_point(e)) == CG_LEFT;
+         }
+
+         // e is reported once, by its smallest half-edge, the outer face of
+         // a triangular hull is cw and skipped
+         bool is_triangle(uint32_t e) const
+         {
+            if (org_[e] == dc_dead)
+               return false;
+
+            uint32_t f = lnext(e), g = lnext(f);
+            return lnext(g) == e && e < f && e < g
+                && orientation(org_point(e), org_point(f), org_point(g)) == CG_LEFT;
+         }
+
+         uint32_t make_edge(uint32_t a, uint32_t b, edge_pool & pool)
+         {
+            uint32_t e = 2 * pool.alloc();
+            org_[e] = a;
+            org_[sym(e)] = b;
+            onext_[e] = oprev_[e] = e;
+            onext_[sym(e)] = oprev_[sym(e)] = sym(e);
+            return e;
+         }
+
+         // joins the rings of a and b or splits them if they are the same
+         void splice(uint32_t a, uint32_t b)
+         {
+            uint32_t an = onext_[a], bn = onext_[b];
+            onext_[a] = bn;
+            oprev_[bn] = a;
+            onext_[b] = an;
+            oprev_[an] = b;
+         }
+
+         // new edge from dest(a) to org(b) in the face left of both
+         uint32_t connect(uint32_t a, uint32_t b, edge_pool & pool)
+         {
+            uint32_t e = make_edge(dest(a), org_[b], pool);
+            splice(e, lnext(a));
+            splice(sym(e), b);
+            return e;
+         }
+
+         void remove(uint32_t e, edge_pool & pool)
+         {
+            splice(e, oprev_[e]);
+            splice(sym(e), oprev_[sym(e)]);
+            org_[e] = org_[sym(e)] = dc_dead;
+            pool.free.push_back(e / 2);
+         }
+
+         // results are hull edges with the interior on the left, the next
+         // one ccw along the hull is rprev
+         uint32_t build(uint32_t lo, uint32_t hi, int axis, size_t depth, edge_pool & pool)
+         {
+            if (depth == 0 || hi - lo < dc_min_parallel)
+            {
+               pool.spans.push_back(std::make_pair(3 * lo, 3 * hi));
+               return divide(lo, hi, axis, pool);
+            }
+
+            uint32_t mid = lo + (hi - lo) / 2;
+
+            edge_pool right_pool;
+            uint32_t right;
+            std::thread worker([&] { right = build(mid, hi, 1 - axis, depth - 1, right_pool); });
+            uint32_t left = build(lo, mid, 1 - axis, depth - 1, pool);
+            worker.join();
+
+            pool.splice(right_pool);
+            return merge(left, right, axis, pool);
+         }
+
+         uint32_t divide(uint32_t lo, uint32_t hi, int axis, edge_pool & pool)
+         {
+            if (hi - lo == 2)
+               return make_edge(lo, lo + 1, pool);
+
+            if (hi - lo == 3)
+            {
+               uint32_t a = make_edge(lo, lo + 1, pool);
+               uint32_t b = make_edge(lo + 1, lo + 2, pool);
+               splice(sym(a), b);
+
+               orientation_t o = orientation(points_[lo], points_[lo + 1], points_[lo + 2]);
+               if (o == CG_LEFT)
+                  connect(b, a, pool);
+               else if (o == CG_RIGHT)
+                  return sym(connect(b, a, pool));
+
+               return a;
+            }
+
+            uint32_t mid = lo + (hi - lo) / 2;
+            uint32_t left = divide(lo, mid, 1 - axis, pool);
+            uint32_t right = divide(mid, hi, 1 - axis, pool);
+            return merge(left, right, axis, pool);
+         }
+
+         // the hull edges out of the least and the greatest point in the frame
+         void extremes(uint32_t e, int axis, uint32_t & least, uint32_t & greatest) const
+         {
+            least = greatest = e;
+            for (uint32_t f = rprev(e); f != e; f = rprev(f))
+            {
+               if (less(org_point(f), org_point(least), axis))
+                  least = f;
+               if (less(org_point(greatest), org_point(f), axis))
+                  greatest = f;
+            }
+         }
+
+         bool valid(uint32_t e, uint32_t base) const
+         {
+            return right_of(dest_point(e), base);
+         }
+
+         uint32_t merge(uint32_t left, uint32_t right, int axis, edge_pool & pool)
+         {
+            // ldo ccw out of the least point of the left half, ldi cw out of
+            // its greatest, rdi ccw out of the least point of the right half
+            uint32_t ldo, ldi, rdi, rmax;
+            extremes(left, axis, ldo, ldi);
+            extremes(right, axis, rdi, rmax);
+            ldi = oprev_[ldi];
+
+            // lower common tangent
+            for (;;)
+            {
+               if (left_of(org_point(rdi), ldi))
+                  ldi = lnext(ldi);
+               else if (right_of(org_point(ldi), rdi))
+                  rdi = rprev(rdi);
+               else
+                  break;
+            }
+
+            // the base edge goes from right to left, the rising bubble is
+            // to its right
+            uint32_t base = connect(sym(rdi), ldi, pool);
+            if (org_[ldi] == org_[ldo])
+               ldo = sym(base);
+
+            for (;;)
+            {
+               uint32_t lcand = onext_[sym(base)];
+               if (valid(lcand, base))
+               {
+                  while (in_circle(dest_point(base), org_point(base), dest_point(lcand), dest_point(onext_[lcand]))
+                         == CG_INSIDE)
+                  {
+                     uint32_t next = onext_[lcand];
+                     remove(lcand, pool);
+                     lcand = next;
+                  }
+               }
+
+               uint32_t rcand = oprev_[base];
+               if (valid(rcand, base))
+               {
+                  while (in_circle(dest_point(base), org_point(base), dest_point(rcand), dest_point(oprev_[rcand]))
+                         == CG_INSIDE)
+                  {
+                     uint32_t next = oprev_[rcand];
+                     remove(rcand, pool);
+                     rcand = next;
+                  }
+               }
+
+               bool lvalid = valid(lcand, base), rvalid = valid(rcand, base);
+               if (!lvalid && !rvalid)
+                  break;
+
+               if (!lvalid || (rvalid && in_circle(dest_point(lcand), org_point(lcand), org_point(rcand),
+                                                   dest_point(rcand)) == CG_INSIDE))
+                  base = connect(rcand, sym(base), pool);
+               else
+                  base = connect(sym(base), sym(lcand), pool);
+            }
+
+            return ldo;
+         }
+
+         std::vector<point_2> points_;
+         std::vector<uint32_t> ids_;
+
+         std::vector<uint32_t> org_, onext_, oprev_;
+      };
+   }
+
+   // delaunay triangulation of pts by divide and conquer, the halves of the
+   // top log2(threads) levels partitioned and built in parallel. mesh
+   // vertices are pts, the triangles ccw, equal points use the first of
+   // them. threads == 0 means one per hardware thread.
+   inline void delaunay_mesh(std::vector<point_2> const & pts, indexed_mesh & res, size_t threads = 0)
+   {
+      if (threads == 0)
+         threads = common::default_threads();
+
+      res.clear();
+      res.vertices = pts;
+
+      detail::delaunay_dc(pts, threads).triangles(res.indices, threads);
+   }
+
+   // the same with the twin of every half-edge of res, no_twin on the
+   // hull, for a half_edge_mesh without matching the edges again
+   inline void delaunay_mesh(std::vector<point_2> const & pts, indexed_mesh & res, std::vector<uint32_t> & twins,
+                             size_t threads = 0)
+   {
+      if (threads == 0)
+         threads = common::default_threads();
+
+      res.clear();
+      res.vertices = pts;
+
+      detail::delaunay_dc(pts, threads).triangles(res.indices, threads, &twins);
+   }
+}
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/triangle.h>
+#include <cg/primitives/segment.h>
+#include <cg/operations/orientation.h>
+#include <cg/operations/in_circle.h>
+#include <cg/spatial/hilbert_sort.h>
+#include <cg/common/parallel.h>
+#include <cg/triangulation/indexed_mesh.h>
+#include <cg/triangulation/half_edge_mesh.h>
+
+namespace cg
+{
+   namespace detail
+   {
+      uint32_t const any_region = uint32_t(-1);
+
+      // meshes smaller than this per thread are flipped on one thread
+      size_t const flip_min_parallel = 1 << 14;
+
+      inline uint64_t edge_key(uint32_t u, uint32_t w)
+      {
+         return u < w ? (uint64_t(u) << 32) | w : (uint64_t(w) << 32) | u;
+      }
+
+      // lawson flips over the triangles of an indexed mesh. half-edge
+      // e = 3 t + i goes from indices[e] to indices[next(e)] and twins_[e] is
+      // the half-edge across it. edges on the boundary, constrained or shared
+      // by more than two triangles have no twin and are never flipped.
+      struct lawson_flipper
+      {
+         lawson_flipper(indexed_mesh & mesh, std::vector<std::pair<uint32_t, uint32_t> > const & constraints)
+            : pts_(mesh.vertices)
+            , vertices_(mesh.indices)
+         {
+            match_twins(vertices_, pts_.size(), twins_);
+            if (constraints.empty())
+               return;
+
+            std::vector<uint64_t> fixed;
+            fixed.reserve(constraints.size());
+            for (size_t l = 0; l != constraints.size(); ++l)
+               fixed.push_back(edge_key(constraints[l].first, constraints[l].second));
+            std::sort(fixed.begin(), fixed.end());
+
+            for (uint32_t e = 0; e != vertices_.size(); ++e)
+            {
+               uint32_t f = twins_[e];
+               if (f != no_twin && std::binary_search(fixed.begin(), fixed.end(), edge_key(vertices_[e], vertices_[next(e)])))
+                  twins_[e] = twins_[f] = no_twin;
+            }
+         }
+
+         // flips until no edge is left to flip, returns the number of flips
+         size_t run(size_t threads)
+         {
+            size_t n = vertices_.size() / 3;
+            threads = std::min(threads, std::max<size_t>(1, n / flip_min_parallel));
+
+            std::vector<uint32_t> stack;
+            if (threads <= 1)
+            {
+               for (uint32_t e = 0; e != vertices_.size(); ++e)
+                  if (twins_[e] != no_twin && e < twins_[e])
+                     stack.push_back(e);
+               return drain(stack, any_region, stack);
+            }
+
+            // contiguous pieces of a hilbert curve through the centroids
+            std::vector<point_2> centroids(n);
+            for (size_t t = 0; t != n; ++t)
+            {
+               point_2 const & a = pts_[vertices_[3 * t]], & b = pts_[vertices_[3 * t + 1]], & c = pts_[vertices_[3 * t + 2]];
+               centroids[t] = point_2((a.x + b.x + c.x) / 3, (a.y + b.y + c.y) / 3);
+            }
+
+            std::vector<uint32_t> order;
+            hilbert_sort(centroids, order);
+            regions_.resize(n);
+            for (size_t l = 0; l != n; ++l)
+               regions_[order[l]] = uint32_t(l * threads / n);
+
+            // a flip inside a region only touches triangles of the region,
+            // so regions flip in parallel. edges between regions wait.
+            std::vector<std::vector<uint32_t> > deferred(threads);
+            std::vector<size_t> flips(threads);
+            common::parallel_for(0, threads, [&] (size_t k)
+            {
+               std::vector<uint32_t> own;
+               for (size_t l = k * n / threads; l != (k + 1) * n / threads; ++l)
+                  for (uint32_t e = 3 * order[l]; e != 3 * order[l] + 3; ++e)
+                     if (twins_[e] != no_twin)
+                        own.push_back(e);
+               flips[k] = drain(own, uint32_t(k), deferred[k]);
+            }, threads);
+
+            for (size_t k = 0; k != threads; ++k)
+               stack.insert(stack.end(), deferred[k].begin(), deferred[k].end());
+
+            size_t res = drain(stack, any_region, stack);
+            for (size_t k = 0; k != threads; ++k)
+               res += flips[k];
+            return res;
+         }
+
+      private:
+         static uint32_t next(uint32_t e)
+         {
+            return e % 3 == 2 ? e - 2 : e + 1;
+         }
+
+         static uint32_t prev(uint32_t e)
+         {
+            return e % 3 == 0 ? e + 2 : e - 1;
+         }
+
+         bool owns(uint32_t region, uint32_t e) const
+         {
+            return region == any_region || e == no_twin || regions_[e / 3] == region;
+         }
+
+         // flips the edges on the stack and the ones around each flip.
+         // with a region, edges whose flip would touch a triangle of
+         // another region go to deferred instead.
+         size_t drain(std::vector<uint32_t> & stack, uint32_t region, std::vector<uint32_t> & deferred)
+         {
+            size_t res = 0;
+            while (!stack.empty())
+            {
+               uint32_t e = stack.back();
+               stack.pop_back();
+
+               uint32_t f = twins_[e];
+               if (f == no_twin)
+                  continue;
+
+               if (!owns(region, f) || !owns(region, twins_[next(e)]) || !owns(region, twins_[prev(e)])
+                   || !owns(region, twins_[next(f)]) || !owns(region, twins_[prev(f)]))
+               {
+                  deferred.push_back(e);
+                  continue;
+               }
+
+               point_2 const & a = pts_[vertices_[e]], & b = pts_[vertices_[next(e)]];
+               point_2 const & c = pts_[vertices_[prev(e)]], & d = pts_[vertices_[prev(f)]];
+               if (in_circle(a, b, c, d) != CG_INSIDE || orientation(c, a, d) != CG_LEFT || orientation(c, d, b) != CG_LEFT)
+                  continue;
+
+               flip(e);
+               ++res;
+
+               uint32_t t = e / 3, s = f / 3;
+               stack.push_back(3 * t);
+               stack.push_back(3 * t + 1);
+               stack.push_back(3 * s + 1);
+               stack.push_back(3 * s + 2);
+            }
+            return res;
+         }
+
+         void link(uint32_t e, uint32_t f)
+         {
+            twins_[e] = f;
+            if (f != no_twin)
+               twins_[f] = e;
+         }
+
+         // triangles a b c and b a d across e = a -> b become c a d and c d b
+         void flip(uint32_t e)
+         {
+            uint32_t f = twins_[e];
+            uint32_t t = e / 3, s = f / 3;
+            uint32_t a = vertices_[e], b = vertices_[next(e)], c = vertices_[prev(e)], d = vertices_[prev(f)];
+            uint32_t bc = twins_[next(e)], ca = twins_[prev(e)];
+            uint32_t ad = twins_[next(f)], db = twins_[prev(f)];
+
+            vertices_[3 * t] = c, vertices_[3 * t + 1] = a, vertices_[3 * t + 2] = d;
+            vertices_[3 * s] = c, vertices_[3 * s + 1] = d, vertices_[3 * s + 2] = b;
+            link(3 * t, ca);
+            link(3 * t + 1, ad);
+            link(3 * t + 2, 3 * s);
+            link(3 * s + 1, db);
+            link(3 * s + 2, bc);
+         }
+
+         std::vector<point_2> const & pts_;
+         std::vector<uint32_t> & vertices_;
+         std::vector<uint32_t> twins_;
+         std::vector<uint32_t> regions_;
+      };
+   }
+
+   // flips the edges of a ccw triangulated mesh, e.g. the output of
+   // triangulate, until every edge except the boundary and the constraints
+   // (vertex pairs) is locally delaunay. cheaper than rebuilding when the
+   // mesh is mostly good already. triangles keep their number but not their
+   // order, triangle_contours is recomputed if present. returns the number
+   // of flips.
+   inline size_t delaunay_flip(indexed_mesh & mesh, std::vector<std::pair<uint32_t, uint32_t> > const & constraints =
+                                  std::vector<std::pair<uint32_t, uint32_t> >(), size_t threads = 0)
+   {
+      if (threads == 0)
+         threads = common::default_threads();
+
+      size_t res = detail::lawson_flipper(mesh, constraints).run(threads);
+
+      if (!mesh.triangle_contours.empty())
+         for (size_t t = 0; t != mesh.triangles_num(); ++t)
+         {
+            uint32_t const * i = &mesh.indices[3 * t];
+            mesh.triangle_contours[t] = uint32_t(mesh.contour(*std::min_element(i, i + 3)));
+         }
+
+      return res;
+   }
+
+   // the same for a triangle soup: triangles share an edge where they share
+   // both end points. constraints whose end points are not vertices of the
+   // triangles are ignored.
+   inline size_t delaunay_flip(std::vector<triangle_2> & triangles, std::vector<segment_2> const & constraints =
+                                  std::vector<segment_2>(), size_t threads = 0)
+   {
+      indexed_mesh mesh;
+      for (size_t t = 0; t != triangles.size(); ++t)
+         for (size_t l = 0; l != 3; ++l)
+            mesh.vertices.push_back(triangles[t][l]);
+      std::sort(mesh.vertices.begin(), mesh.vertices.end());
+      mesh.vertices.erase(std::unique(mesh.vertices.begin(), mesh.vertices.end()), mesh.vertices.end());
+
+      auto index = [&mesh] (point_2 const & p)
+      {
+         return uint32_t(std::lower_bound(mesh.vertices.begin(), mesh.vertices.end(), p) - mesh.vertices.begin());
+      };
+
+      mesh.indices.reserve(3 * triangles.size());
+      for (size_t t = 0; t != triangles.size(); ++t)
+      {
+         triangle_2 const & tr = triangles[t];
+         bool cw = orientation(tr[0], tr[1], tr[2]) == CG_RIGHT;
+         mesh.indices.push_back(index(tr[0]));
+         mesh.indices.push_back(index(tr[cw ? 2 : 1]));
+         mesh.indices.push_back(index(tr[cw ? 1 : 2]));
+      }
+
+      std::vector<std::pair<uint32_t, uint32_t> > fixed;
+      for (size_t l = 0; l != constraints.size(); ++l)
+      {
+         uint32_t u = index(constraints[l][0]), w = index(constraints[l][1]);
+         if (u != mesh.vertices.size() && w != mesh.vertices.size()
+             && mesh.vertices[u] == constraints[l][0] && mesh.vertices[w] == constraints[l][1])
+            fixed.push_back(std::make_pair(u, w));
+      }
+
+      size_t res = delaunay_flip(mesh, fixed, threads);
+      for (size_t t = 0; t != triangles.size(); ++t)
+         triangles[t] = mesh.triangle(t);
+      return res;
+   }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/triangle.h>
+#include <cg/triangulation/indexed_mesh.h>
+
+namespace cg
+{
+   namespace detail
+   {
+      uint32_t const no_twin = uint32_t(-1);
+
+      uint32_t const many_edges = uint32_t(-2);
+
+      // twins[e] is the half-edge v -> u for the half-edge e = u -> v of the
+      // triangles in indices, no_twin if the edge is on the boundary or
+      // shared by more than two triangles. half-edges are bucketed by
+      // origin, then at every vertex u the edges out of u are matched with
+      // the edges into u, prev of the former, through two arrays indexed by
+      // the other end point. linear also around vertices of high degree.
+      inline void match_twins(std::vector<uint32_t> const & indices, size_t vertices_num, std::vector<uint32_t> & twins)
+      {
+         size_t n = indices.size();
+         twins.assign(n, no_twin);
+
+         std::vector<uint32_t> first(vertices_num + 1), order(n);
+         for (size_t e = 0; e != n; ++e)
+            ++first[indices[e] + 1];
+         for (size_t v = 0; v != vertices_num; ++v)
+            first[v + 1] += first[v];
+         for (uint32_t e = 0; e != n; ++e)
+            order[first[indices[e]]++] = e;
+         for (size_t v = vertices_num; v != 0; --v)
+            first[v] = first[v - 1];
+         first[0] = 0;
+
+         auto next = [] (uint32_t e) { return e % 3 == 2 ? e - 2 : e + 1; };
+         auto prev = [] (uint32_t e) { return e % 3 == 0 ? e + 2 : e - 1; };
+         auto mark = [] (uint32_t & slot, uint32_t e) { slot = slot == no_twin ? e : many_edges; };
+
+         std::vector<uint32_t> out(vertices_num, no_twin), in(vertices_num, no_twin);
+         for (size_t u = 0; u != vertices_num; ++u)
+         {
+            uint32_t const * b = &order[0] + first[u], * end = &order[0] + first[u + 1];
+            for (uint32_t const * e = b; e != end; ++e)
+            {
+               mark(out[indices[next(*e)]], *e);
+               mark(in[indices[prev(*e)]], prev(*e));
+            }
+
+            for (uint32_t const * e = b; e != end; ++e)
+            {
+               uint32_t w = indices[next(*e)];
+               if (out[w] == *e && in[w] != many_edges && w != u)
+                  twins[*e] = in[w];
+            }
+
+            for (uint32_t const * e = b; e != end; ++e)
+               out[indices[next(*e)]] = in[indices[prev(*e)]] = no_twin;
+         }
+      }
+   }
+
+   // triangles with their adjacency, in flat arrays: half-edge e = 3 t + i
+   // of triangle t goes from origin(e) to target(e), twin(e) is the
+   // half-edge across it or no_twin on the boundary. out(v) is a half-edge
+   // starting at v, on a boundary vertex the one with the boundary on its
+   // right, so turning it ccw passes every triangle around v. a vertex where
+   // several fans of triangles touch is seen through one of them.
+   struct half_edge_mesh
+   {
+      half_edge_mesh() {}
+
+      // in linear time from a ccw triangulated mesh, e.g. the output of
+      // triangulate. half-edges are numbered like mesh.indices.
+      explicit half_edge_mesh(indexed_mesh const & mesh)
+         : points_(mesh.vertices)
+         , vertices_(mesh.indices)
+      {
+         detail::match_twins(vertices_, points_.size(), twins_);
+         find_out();
+      }
+
+      // the same when the twins are known already, e.g. from the
+      // triangulation that built the mesh
+      half_edge_mesh(indexed_mesh const & mesh, std::vector<uint32_t> const & twins)
+         : points_(mesh.vertices)
+         , vertices_(mesh.indices)
+         , twins_(twins)
+      {
+         find_out();
+      }
+
+      std::vector<point_2> const & points() const { return points_; }
+      size_t vertices_num()   const { return points_.size(); }
+      size_t triangles_num()  const { return vertices_.size() / 3; }
+      size_t half_edges_num() const { return vertices_.size(); }
+
+      static uint32_t next(uint32_t e) { return e % 3 == 2 ? e - 2 : e + 1; }
+      static uint32_t prev(uint32_t e) { return e % 3 == 0 ? e + 2 : e - 1; }
+
+      uint32_t origin(uint32_t e) const { return vertices_[e]; }
+      uint32_t target(uint32_t e) const { return vertices_[next(e)]; }
+      uint32_t twin(uint32_t e)   const { return twins_[e]; }
+      bool is_boundary(uint32_t e) const { return twins_[e] == detail::no_twin; }
+
+      // no_twin for an isolated vertex
+      uint32_t out(uint32_t v) const { return out_[v]; }
+
+      // the next half-edge out of origin(e) ccw and cw, no_twin past the
+      // boundary
+      uint32_t turn_ccw(uint32_t e) const { return twins_[prev(e)]; }
+      uint32_t turn_cw(uint32_t e) const
+      {
+         uint32_t f = twins_[e];
+         return f == detail::no_twin ? f : next(f);
+      }
+
+      // the triangle across side i (origin(3 t + i) -> target) of t, no_twin
+      // on the boundary
+      uint32_t neighbor(uint32_t t, uint32_t i) const
+      {
+         uint32_t f = twins_[3 * t + i];
+         return f == detail::no_twin ? f : f / 3;
+      }
+
+      // the boundary half-edge after the boundary half-edge e, going around
+      // the region on its left
+      uint32_t next_boundary(uint32_t e) const
+      {
+         uint32_t f = next(e);
+         while (twins_[f] != detail::no_twin)
+            f = next(twins_[f]);
+         return f;
+      }
+
+      triangle_2 triangle(uint32_t t) const
+      {
+         return triangle_2(points_[vertices_[3 * t]], points_[vertices_[3 * t + 1]], points_[vertices_[3 * t + 2]]);
+      }
+
+   private:
+      void find_out()
+      {
+         out_.assign(points_.size(), detail::no_twin);
+         for (uint32_t e = 0; e != vertices_.size(); ++e)
+            if (out_[vertices_[e]] == detail::no_twin || twins_[e] == detail::no_twin)
+               out_[vertices_[e]] = e;
+      }
+
+      std::vector<point_2> points_;
+      std::vector<uint32_t> vertices_;
+      std::vector<uint32_t> twins_;
+      std::vector<uint32_t> out_;
+   };
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cg/primitives/point.h>
+#include <cg/primitives/triangle.h>
+
+namespace cg {
+   // triangles as uint32_t triples into a shared vertex array. the vertices
+   // are the input contours concatenated in order, so vertex v is vertex
+   // v - contour_offsets[k] of contour k, k = contour(v).
+   struct indexed_mesh {
+      std::vector<point_2> vertices;
+
+      // three per triangle, ccw
+      std::vector<uint32_t> indices;
+
+      // contour k owns vertices [contour_offsets[k], contour_offsets[k + 1])
+      std::vector<uint32_t> contour_offsets;
+
+      // optional, per triangle: the contour of its smallest vertex index
+      std::vector<uint32_t> triangle_contours;
+
+      size_t triangles_num() const {
+         return indices.size() / 3;
+      }
+
+      size_t contours_num() const {
+         return contour_offsets.empty() ? 0 : contour_offsets.size() - 1;
+      }
+
+      triangle_2 triangle(size_t t) const {
+         return triangle_2(vertices[indices[3 * t]], vertices[indices[3 * t + 1]], vertices[indices[3 * t + 2]]);
+      }
+
+      size_t contour(uint32_t v) const {
+         return std::upper_bound(contour_offsets.begin(), contour_offsets.end(), v) - contour_offsets.begin() - 1;
+      }
+
+      void clear() {
+         vertices.clear();
+         indices.clear();
+         contour_offsets.clear();
+         triangle_contours.clear();
+      }
+   };
+}
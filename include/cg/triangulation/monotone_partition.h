@@ -0,0 +1,391 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/contour.h>
+#include <cg/operations/orientation.h>
+#include <cg/common/parallel.h>
+#include <cg/triangulation/triangulation.h>
+#include <cg/triangulation/indexed_mesh.h>
+
+namespace cg
+{
+   // a polygon cut by diagonals into pieces monotone in the sweep order of
+   // triangulate, lexicographic (x, then y). piece k is the ccw cycle
+   // vertices[offsets[k]], ..., vertices[offsets[k + 1] - 1] of indices
+   // into points, the input contours concatenated like in indexed_mesh.
+   struct monotone_pieces
+   {
+      std::vector<point_2> points;
+      std::vector<uint32_t> contour_offsets;
+      std::vector<uint32_t> vertices, offsets;
+
+      size_t pieces_num() const
+      {
+         return offsets.empty() ? 0 : offsets.size() - 1;
+      }
+
+      // a piece of k vertices gives k - 2 triangles, these start at
+      // triangle offsets[p] - 2 p of the triangulation
+      size_t triangles_num() const
+      {
+         return vertices.size() - 2 * pieces_num();
+      }
+
+      void clear()
+      {
+         points.clear();
+         contour_offsets.clear();
+         vertices.clear();
+         offsets.clear();
+      }
+   };
+
+   namespace detail
+   {
+      // pieces with fewer vertices in total are triangulated on one thread
+      size_t const pieces_min_parallel = 1 << 14;
+
+      // the diagonals of the helper sweep: every status edge remembers the
+      // last vertex seen in the region to its right, a split vertex is
+      // connected to it and a merge vertex to the next vertex below it in
+      // its region. the same events over the same status as monotone_sweep.
+      struct partition_sweep
+      {
+         explicit partition_sweep(triangulation_workspace & ws) : ws(ws) {}
+
+         void run()
+         {
+            std::vector<point_2> const & pts = ws.points;
+            std::sort(ws.order.begin(), ws.order.end(),
+                      [&pts] (uint32_t a, uint32_t b) { return pts[a] > pts[b]; });
+
+            for (uint32_t c : ws.order)
+            {
+               uint32_t prev = ws.prev[c], next = ws.next[c];
+               switch (vertex_type(pts[prev], pts[c], pts[next]))
+               {
+               case START:
+                  insert(c);
+                  break;
+               case END:
+                  close(prev, c);
+                  ws.status.erase(find_edge(prev));
+                  break;
+               case SPLIT:
+               {
+                  status_entry & e = *ws.status.find(find_vertex(c));
+                  diagonal(c, e.helper);
+                  e.helper = c;
+                  insert(c);
+                  break;
+               }
+               case MERGE:
+                  close(prev, c);
+                  ws.status.erase(find_edge(prev));
+                  pass(c);
+                  break;
+               case LEFT_REGULAR:
+               {
+                  // the edge c -> next takes the place of prev -> c
+                  status_entry & e = close(prev, c);
+                  e.a = pts[c];
+                  e.b = pts[next];
+                  e.edge = e.helper = c;
+                  ws.status.refresh();
+                  break;
+               }
+               case RIGHT_REGULAR:
+                  pass(c);
+                  break;
+               }
+            }
+         }
+
+      private:
+         status_key find_edge(uint32_t edge) const
+         {
+            status_key k = {ws.points[edge], ws.points[ws.next[edge]]};
+            return k;
+         }
+
+         status_key find_vertex(uint32_t v) const
+         {
+            status_key k = {ws.points[v], ws.points[v]};
+            return k;
+         }
+
+         bool is_merge(uint32_t v) const
+         {
+            return vertex_type(ws.points[ws.prev[v]], ws.points[v], ws.points[ws.next[v]]) == MERGE;
+         }
+
+         void diagonal(uint32_t a, uint32_t b)
+         {
+            ws.diagonals.push_back(a);
+            ws.diagonals.push_back(b);
+         }
+
+         void insert(uint32_t c)
+         {
+            status_entry e;
+            e.a = ws.points[c];
+            e.b = ws.points[ws.next[c]];
+            e.edge = e.helper = c;
+            e.count = 0;
+            ws.status.insert(find_edge(c), e);
+         }
+
+         // the edge prev -> c ends at c
+         status_entry & close(uint32_t prev, uint32_t c)
+         {
+            status_entry & e = *ws.status.find(find_edge(prev));
+            if (is_merge(e.helper))
+               diagonal(c, e.helper);
+            return e;
+         }
+
+         // c is on the right of the region of the status edge left of it
+         void pass(uint32_t c)
+         {
+            status_entry & e = *ws.status.find(find_vertex(c));
+            if (is_merge(e.helper))
+               diagonal(c, e.helper);
+            e.helper = c;
+         }
+
+         triangulation_workspace & ws;
+      };
+
+      // the faces of the contours in ws cut by ws.diagonals, each walked
+      // with the face on the left: from the edge u -> w on along the edge
+      // out of w next cw after w -> u. around a vertex the edge to next
+      // comes first ccw, then the diagonals, then the edge to prev.
+      inline void collect_pieces(triangulation_workspace & ws, monotone_pieces & res)
+      {
+         std::vector<point_2> const & pts = ws.points;
+         std::vector<uint32_t> const & diagonals = ws.diagonals;
+         std::vector<uint32_t> & first = ws.fan_offsets, & fans = ws.fans;
+         uint32_t n = uint32_t(pts.size());
+
+         first.assign(n + 1, 0);
+         for (size_t l = 0; l != diagonals.size(); ++l)
+            ++first[diagonals[l] + 1];
+         for (uint32_t v = 0; v != n; ++v)
+            first[v + 1] += first[v];
+         fans.resize(diagonals.size());
+         for (size_t l = 0; l != diagonals.size(); ++l)
+            fans[first[diagonals[l]]++] = diagonals[l ^ 1];
+         for (uint32_t v = n; v != 0; --v)
+            first[v] = first[v - 1];
+         first[0] = 0;
+
+         for (uint32_t v = 0; v != n; ++v)
+         {
+            // ccw from the direction to next, left of it first
+            point_2 const & o = pts[v], & d = pts[ws.next[v]];
+            auto before = [&] (uint32_t a, uint32_t b)
+            {
+               bool ha = orientation(o, d, pts[a]) == CG_LEFT, hb = orientation(o, d, pts[b]) == CG_LEFT;
+               return ha != hb ? ha : orientation(o, pts[a], pts[b]) == CG_LEFT;
+            };
+            for (uint32_t s = first[v] + 1; s < first[v + 1]; ++s)
+               for (uint32_t t = s; t != first[v] && before(fans[t], fans[t - 1]); --t)
+                  std::swap(fans[t], fans[t - 1]);
+         }
+
+         // half-edge v < n is the contour edge v -> next[v], n + s the
+         // diagonal from its end at slot s to fans[s]
+         ws.used.assign(n + fans.size(), 0);
+         auto walk = [&] (uint32_t u, uint32_t w, uint32_t id)
+         {
+            for (uint32_t start = id; ; )
+            {
+               ws.used[id] = 1;
+               res.vertices.push_back(u);
+
+               uint32_t s = first[w];
+               if (u != ws.prev[w])
+                  while (fans[s] != u)
+                     ++s;
+               else
+                  s = first[w + 1];
+
+               u = w;
+               if (s == first[w])
+                  id = w, w = ws.next[w];
+               else
+                  id = n + s - 1, w = fans[s - 1];
+
+               if (id == start)
+                  break;
+            }
+            res.offsets.push_back(uint32_t(res.vertices.size()));
+         };
+
+         res.offsets.push_back(0);
+         for (uint32_t v = 0; v != n; ++v)
+            if (!ws.used[v])
+               walk(v, ws.next[v], v);
+         for (uint32_t v = 0; v != n; ++v)
+            for (uint32_t s = first[v]; s != first[v + 1]; ++s)
+               if (!ws.used[n + s])
+                  walk(v, fans[s], n + s);
+      }
+
+      // the monotone piece [piece, piece + k) of ccw vertex indices, merged
+      // from its two chains into sweep order and triangulated with a stack
+      // of reflex vertices. emits exactly k - 2 triangles, ccw. order and
+      // stack are buffers, the top bit of an entry marks the upper chain.
+      template <class Emit>
+      void triangulate_monotone(std::vector<point_2> const & pts, uint32_t const * piece, uint32_t k,
+                                std::vector<uint32_t> & order, std::vector<uint32_t> & stack, Emit emit)
+      {
+         uint32_t const upper = uint32_t(1) << 31;
+         auto at = [piece, upper] (uint32_t l) { return piece[l & ~upper]; };
+
+         uint32_t top = 0;
+         for (uint32_t l = 1; l != k; ++l)
+            if (pts[piece[l]] > pts[piece[top]])
+               top = l;
+
+         // ccw from the top the upper chain, cw the lower one
+         order.clear();
+         order.push_back(top | upper);
+         for (uint32_t i = (top + 1) % k, j = (top + k - 1) % k; ; )
+         {
+            if (i == j)
+            {
+               order.push_back(i);
+               break;
+            }
+            if (pts[piece[i]] > pts[piece[j]])
+               order.push_back(i | upper), i = (i + 1) % k;
+            else
+               order.push_back(j), j = (j + k - 1) % k;
+         }
+
+         // the triangles of c with the stack, a reflex chain on one side
+         auto fan = [&] (uint32_t c)
+         {
+            bool up = (stack.back() & upper) != 0;
+            for (size_t l = 0; l + 1 != stack.size(); ++l)
+            {
+               uint32_t a = at(stack[l]), b = at(stack[l + 1]);
+               if (up)
+                  emit(a, b, c);
+               else
+                  emit(b, a, c);
+            }
+         };
+
+         stack.assign(order.begin(), order.begin() + 2);
+         for (uint32_t l = 2; l + 1 < k; ++l)
+         {
+            uint32_t c = order[l];
+            bool up = (c & upper) != 0;
+            if (up != ((stack.back() & upper) != 0))
+            {
+               fan(at(c));
+               stack.assign(1, order[l - 1]);
+               stack.push_back(c);
+               continue;
+            }
+
+            uint32_t last = stack.back();
+            stack.pop_back();
+            while (!stack.empty())
+            {
+               point_2 const & s = pts[at(stack.back())], & m = pts[at(last)], & p = pts[at(c)];
+               if (up ? orientation(s, m, p) != CG_LEFT : orientation(p, m, s) != CG_LEFT)
+                  break;
+               if (up)
+                  emit(at(stack.back()), at(last), at(c));
+               else
+                  emit(at(c), at(last), at(stack.back()));
+               last = stack.back();
+               stack.pop_back();
+            }
+            stack.push_back(last);
+            stack.push_back(c);
+         }
+         fan(at(order.back()));
+      }
+   }
+
+   // cuts the polygon (outer contour ccw, holes cw) into monotone pieces,
+   // the first stage of triangulate on its own. the pieces replace the
+   // contents of res and can be triangulated by triangulate_pieces, kept
+   // for later or used as they are. nothing is allocated once ws and res
+   // are warm.
+   inline void monotone_partition(std::vector<contour_2> const & polygon, triangulation_workspace & ws, monotone_pieces & res)
+   {
+      res.clear();
+      res.contour_offsets.push_back(0);
+      for (contour_2 const & c : polygon)
+         res.contour_offsets.push_back(uint32_t(res.contour_offsets.back() + c.size()));
+
+      detail::load_polygon(polygon, ws);
+      detail::partition_sweep(ws).run();
+      detail::collect_pieces(ws, res);
+      res.points.assign(ws.points.begin(), ws.points.end());
+   }
+
+   inline monotone_pieces monotone_partition(std::vector<contour_2> const & polygon)
+   {
+      triangulation_workspace ws;
+      monotone_pieces res;
+      monotone_partition(polygon, ws, res);
+      return res;
+   }
+
+   // the second stage: the pieces triangulated independently, in parallel,
+   // into an indexed mesh over pieces.points. the triangles of piece p
+   // start at triangle offsets[p] - 2 p, so the mesh is the same for any
+   // number of threads.
+   inline void triangulate_pieces(monotone_pieces const & pieces, indexed_mesh & mesh, bool contour_ids = false, size_t threads = 0)
+   {
+      if (threads == 0)
+         threads = common::default_threads();
+
+      mesh.clear();
+      mesh.vertices = pieces.points;
+      mesh.contour_offsets = pieces.contour_offsets;
+      mesh.indices.resize(3 * pieces.triangles_num());
+
+      size_t n = pieces.pieces_num(), total = pieces.vertices.size();
+      threads = std::max<size_t>(1, std::min(threads, total / detail::pieces_min_parallel));
+
+      // pieces by the share of vertices they start in
+      std::vector<uint32_t> const & offsets = pieces.offsets;
+      common::parallel_for(0, threads, [&] (size_t w)
+      {
+         size_t lo = std::lower_bound(offsets.begin(), offsets.begin() + n, uint32_t(w * total / threads)) - offsets.begin();
+         size_t hi = std::lower_bound(offsets.begin(), offsets.begin() + n, uint32_t((w + 1) * total / threads)) - offsets.begin();
+
+         std::vector<uint32_t> order, stack;
+         for (size_t p = lo; p != hi; ++p)
+         {
+            uint32_t * out = &mesh.indices[0] + 3 * (offsets[p] - 2 * p);
+            detail::triangulate_monotone(pieces.points, &pieces.vertices[offsets[p]], offsets[p + 1] - offsets[p], order, stack,
+                                         [&out] (uint32_t a, uint32_t b, uint32_t c)
+            {
+               *out++ = a;
+               *out++ = b;
+               *out++ = c;
+            });
+         }
+      }, threads);
+
+      if (contour_ids)
+      {
+         std::vector<uint32_t> const & indices = mesh.indices;
+         mesh.triangle_contours.resize(mesh.triangles_num());
+         for (size_t t = 0; t != mesh.triangles_num(); ++t)
+            mesh.triangle_contours[t] = uint32_t(mesh.contour(std::min(std::min(indices[3 * t], indices[3 * t + 1]), indices[3 * t + 2])));
+      }
+   }
+}
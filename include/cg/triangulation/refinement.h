@@ -0,0 +1,487 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/contour.h>
+#include <cg/primitives/triangle.h>
+#include <cg/operations/orientation.h>
+#include <cg/operations/in_circle.h>
+#include <cg/operations/circumcenter.h>
+#include <cg/triangulation/delaunay.h>
+#include <cg/triangulation/constrained_delaunay.h>
+#include <cg/triangulation/indexed_mesh.h>
+
+namespace cg
+{
+   namespace detail
+   {
+      uint32_t const no_edge = uint32_t(-1);
+
+      // the largest smallest angle refinement is run for, in degrees. beyond
+      // it the refiner may never stop.
+      double const max_min_angle = 33;
+
+      // a triangle to split, found bad when it had the vertices a, b, c.
+      // the worst one, with the least sin^2 of its smallest angle, is on top.
+      struct bad_triangle
+      {
+         double quality;
+         uint32_t t, a, b, c;
+
+         bool operator < (bad_triangle const & other) const
+         {
+            return quality > other.quality;
+         }
+      };
+
+      // ruppert's delaunay refinement of a constrained delaunay triangulation
+      // whose inside is given per triangle. segments (the constrained edges)
+      // with a vertex inside their diametral circle are split first, then the
+      // worst bad triangle gets its circumcenter as a new vertex unless the
+      // circumcenter encroaches segments, which are split instead. a segment
+      // at an input vertex is split at a power of two from it, so the splits
+      // of segments meeting at a small angle stay on common circles around
+      // it (shewchuk's concentric shells), and a triangle whose shortest edge
+      // joins two such splits at the same distance is left as it is, since
+      // splitting it would never stop. this ends for angles up to about 20.7
+      // degrees when the input has no angles under 60, and in practice for
+      // up to about 33 degrees, to which min_angle is clamped.
+      struct refiner
+      {
+         // the first inputs vertices are the input ones, segments are the
+         // constrained edges between them
+         refiner(delaunay_triangulation & dt, std::vector<uint8_t> const & inside, uint32_t inputs,
+                 double min_angle, double max_area, size_t max_points)
+            : dt_(dt)
+            , inside_(inside)
+            , inputs_(inputs)
+            , max_area_(max_area)
+            , max_points_(max_points)
+            , unsplit_(0)
+         {
+            double s = std::sin(std::min(std::max(0., min_angle), max_min_angle) * std::acos(-1.) / 180);
+            min_quality_ = s * s;
+         }
+
+         // false if it stopped at max_points with work left or gave up on a
+         // triangle
+         bool run()
+         {
+            for (uint32_t e = 0; e != dt_.half_edges_num(); ++e)
+               if (dt_.constrained(e) && e < dt_.twin(e) && encroached(e))
+                  segments_.push_back(std::make_pair(e, dt_.origin(e)));
+            for (uint32_t t = 0; t != inside_.size(); ++t)
+               check(t);
+
+            while (!full())
+            {
+               if (!segments_.empty())
+               {
+                  std::pair<uint32_t, uint32_t> s = segments_.back();
+                  segments_.pop_back();
+                  if (segment(s.first, s.second) && encroached(s.first))
+                     split_segment(s.first);
+                  continue;
+               }
+
+               if (bad_.empty())
+                  break;
+
+               bad_triangle b = bad_.top();
+               bad_.pop();
+               if (current(b))
+                  split_triangle(b);
+            }
+
+            while (!bad_.empty() && !current(bad_.top()))
+               bad_.pop();
+            segments_.erase(std::remove_if(segments_.begin(), segments_.end(),
+                                           [this] (std::pair<uint32_t, uint32_t> const & s)
+                                           {
+                                              return !segment(s.first, s.second) || !encroached(s.first);
+                                           }),
+                            segments_.end());
+            return unsplit_ == 0 && bad_.empty() && segments_.empty();
+         }
+
+         // per triangle of dt, whether it is inside
+         std::vector<uint8_t> const & inside() const { return inside_; }
+
+      private:
+         bool full() const
+         {
+            return max_points_ != 0 && dt_.points().size() - inputs_ >= max_points_;
+         }
+
+         point_2 const & point(uint32_t e) const
+         {
+            return dt_.point(dt_.origin(e));
+         }
+
+         // e is still the constrained edge from a
+         bool segment(uint32_t e, uint32_t a) const
+         {
+            return e < dt_.half_edges_num() && dt_.constrained(e) && dt_.origin(e) == a;
+         }
+
+         bool current(bad_triangle const & b) const
+         {
+            uint32_t t = b.t;
+            return inside_[t] && dt_.origin(3 * t) == b.a && dt_.origin(3 * t + 1) == b.b && dt_.origin(3 * t + 2) == b.c;
+         }
+
+         // p is strictly inside the diametral circle of e
+         bool encroaches(uint32_t e, point_2 const & p) const
+         {
+            point_2 const & a = point(e), & b = point(delaunay_triangulation::next(e));
+            return (a.x - p.x) * (b.x - p.x) + (a.y - p.y) * (b.y - p.y) < 0;
+         }
+
+         // a triangle on either side of the segment e has its apex inside
+         // the diametral circle, in a delaunay triangulation this is the
+         // case whenever any vertex is
+         bool encroached(uint32_t e) const
+         {
+            for (uint32_t f : {e, dt_.twin(e)})
+            {
+               uint32_t apex = delaunay_triangulation::prev(f);
+               if (dt_.origin(apex) != infinite_vertex && encroaches(e, point(apex)))
+                  return true;
+            }
+            return false;
+         }
+
+         // queues t if it is inside and bad
+         void check(uint32_t t)
+         {
+            if (!inside_[t])
+               return;
+
+            triangle_2 tr = dt_.triangle(t);
+            double lengths[3];
+            for (size_t i = 0; i != 3; ++i)
+            {
+               point_2 const & a = tr[i], & b = tr[(i + 1) % 3];
+               lengths[i] = (b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y);
+            }
+
+            double cross = (tr[1].x - tr[0].x) * (tr[2].y - tr[0].y) - (tr[1].y - tr[0].y) * (tr[2].x - tr[0].x);
+            size_t shortest = std::min_element(lengths, lengths + 3) - lengths;
+
+            // sin^2 of the smallest angle from the edges next to it
+            double quality = cross * cross / (lengths[(shortest + 1) % 3] * lengths[(shortest + 2) % 3]);
+            bool large = max_area_ > 0 && std::fabs(cross) > 2 * max_area_;
+            if (!large && (quality >= min_quality_ || shell_edge(3 * t + uint32_t(shortest))))
+               return;
+
+            bad_triangle b = {quality, t, dt_.origin(3 * t), dt_.origin(3 * t + 1), dt_.origin(3 * t + 2)};
+            bad_.push(b);
+         }
+
+         // e joins splits of two segments from a common input vertex on the
+         // same shell around it. the shells are compared by their exponent,
+         // not by the rounded distances of the splits.
+         bool shell_edge(uint32_t e) const
+         {
+            uint32_t u = dt_.origin(e), w = dt_.origin(delaunay_triangulation::next(e));
+            if (u < inputs_ || w < inputs_)
+               return false;
+
+            shell const & su = shells_[u - inputs_], & sw = shells_[w - inputs_];
+            return su.apex != no_edge && su.apex == sw.apex && su.exponent == sw.exponent
+                && segment_of_[u - inputs_] != segment_of_[w - inputs_];
+         }
+
+         // the input segment with the subsegment between a and b
+         std::pair<uint32_t, uint32_t> input_segment(uint32_t a, uint32_t b) const
+         {
+            if (a >= inputs_ && segment_of_[a - inputs_].first != no_edge)
+               return segment_of_[a - inputs_];
+            if (b >= inputs_ && segment_of_[b - inputs_].first != no_edge)
+               return segment_of_[b - inputs_];
+            return std::make_pair(std::min(a, b), std::max(a, b));
+         }
+
+         void split_segment(uint32_t e)
+         {
+            uint32_t a = dt_.origin(e), b = dt_.origin(delaunay_triangulation::next(e));
+            point_2 pa = dt_.point(a), pb = dt_.point(b);
+
+            // at a power of two from an input end point, in the middle third
+            double t = .5;
+            shell sh = {no_edge, 0};
+            if ((a < inputs_) != (b < inputs_))
+            {
+               sh.apex = a < inputs_ ? a : b;
+               if (b < inputs_)
+                  std::swap(pa, pb);
+               double length = std::sqrt((pb.x - pa.x) * (pb.x - pa.x) + (pb.y - pa.y) * (pb.y - pa.y));
+               sh.exponent = std::ilogb(2 * length / 3);
+               t = std::ldexp(1., sh.exponent) / length;
+            }
+
+            point_2 p(pa.x + t * (pb.x - pa.x), pa.y + t * (pb.y - pa.y));
+            if (p == pa || p == pb)
+               return;
+
+            segment_of_.push_back(input_segment(a, b));
+            shells_.push_back(sh);
+            dt_.split(e, p);
+            inserted(uint32_t(dt_.points().size() - 1));
+         }
+
+         void split_triangle(bad_triangle const & b)
+         {
+            triangle_2 tr = dt_.triangle(b.t);
+            point_2 c = circumcenter(tr);
+
+            uint32_t t = b.t;
+            uint32_t blocking = walk(t, tr, c);
+            if (blocking != no_edge)
+            {
+               if (dt_.constrained(blocking))
+               {
+                  split_segment(blocking);
+                  bad_.push(b);
+               }
+               return;
+            }
+
+            // the segments on the boundary of the cavity of c
+            encroached_.clear();
+            cavity_.clear();
+            cavity_.push_back(t);
+            for (size_t k = 0; k != cavity_.size(); ++k)
+               for (uint32_t e = 3 * cavity_[k]; e != 3 * cavity_[k] + 3; ++e)
+               {
+                  if (dt_.constrained(e))
+                  {
+                     if (encroaches(e, c))
+                        encroached_.push_back(std::make_pair(e, dt_.origin(e)));
+                     continue;
+                  }
+
+                  uint32_t s = dt_.twin(e) / 3;
+                  if (!dt_.is_ghost(s) && std::find(cavity_.begin(), cavity_.end(), s) == cavity_.end())
+                  {
+                     triangle_2 ts = dt_.triangle(s);
+                     if (in_circle(ts[0], ts[1], ts[2], c) == CG_INSIDE)
+                        cavity_.push_back(s);
+                  }
+               }
+
+            if (!encroached_.empty())
+            {
+               for (size_t l = 0; l != encroached_.size() && !full(); ++l)
+                  if (segment(encroached_[l].first, encroached_[l].second))
+                     split_segment(encroached_[l].first);
+               bad_.push(b);
+               return;
+            }
+
+            // a circumcenter on a vertex still takes an id, without a vertex
+            add_interior();
+            if (dt_.insert(c, t))
+               inserted(uint32_t(dt_.points().size() - 1));
+            else
+               split_longest(b.t);
+         }
+
+         // for a circumcenter rounded onto a vertex: splits the longest edge
+         // of t instead, counts t as given up if that edge is too short
+         void split_longest(uint32_t t)
+         {
+            uint32_t e = 3 * t;
+            double longest = 0;
+            for (uint32_t f = 3 * t; f != 3 * t + 3; ++f)
+            {
+               point_2 const & a = point(f), & b = point(delaunay_triangulation::next(f));
+               double length = (b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y);
+               if (length > longest)
+               {
+                  longest = length;
+                  e = f;
+               }
+            }
+
+            size_t points = dt_.points().size();
+            if (dt_.constrained(e))
+               split_segment(e);
+            else
+            {
+               point_2 const & a = point(e), & b = point(delaunay_triangulation::next(e));
+               point_2 p((a.x + b.x) / 2, (a.y + b.y) / 2);
+               if (p != a && p != b)
+               {
+                  add_interior();
+                  dt_.split(e, p);
+                  inserted(uint32_t(dt_.points().size() - 1));
+               }
+            }
+
+            if (dt_.points().size() == points)
+               ++unsplit_;
+         }
+
+         // bookkeeping of a steiner vertex off the input segments
+         void add_interior()
+         {
+            segment_of_.push_back(std::make_pair(no_edge, no_edge));
+            shell sh = {no_edge, 0};
+            shells_.push_back(sh);
+         }
+
+         // walks from the centroid of triangle t (with points tr) straight
+         // towards p, stops in the triangle containing p or returns the first
+         // constrained or hull edge in the way, or containing p
+         uint32_t walk(uint32_t & t, triangle_2 tr, point_2 const & p) const
+         {
+            point_2 s((tr[0].x + tr[1].x + tr[2].x) / 3, (tr[0].y + tr[1].y + tr[2].y) / 3);
+            uint32_t from = no_edge;
+            for (;;)
+            {
+               // the side the segment leaves through, any side p is beyond
+               // as a fallback, the constrained side p is on
+               uint32_t exit = no_edge, beyond = no_edge, on = no_edge;
+               for (uint32_t i = 0; i != 3; ++i)
+               {
+                  uint32_t e = 3 * t + i;
+                  point_2 const & a = tr[i], & b = tr[(i + 1) % 3];
+                  orientation_t o = orientation(a, b, p);
+                  if (o == CG_COLLINEAR && dt_.constrained(e) && p != a && p != b)
+                     on = e;
+                  if (e == from || o != CG_RIGHT)
+                     continue;
+
+                  beyond = e;
+                  if (orientation(s, p, a) != CG_LEFT && orientation(s, p, b) != CG_RIGHT)
+                  {
+                     exit = e;
+                     break;
+                  }
+               }
+
+               if (exit == no_edge)
+                  exit = beyond;
+               if (exit == no_edge)
+                  return on;
+
+               uint32_t f = dt_.twin(exit);
+               if (dt_.constrained(exit) || dt_.is_ghost(f / 3))
+                  return exit;
+
+               from = f;
+               t = f / 3;
+               tr = dt_.triangle(t);
+            }
+         }
+
+         // labels the triangles around the new vertex v from their
+         // neighbours across the opposite edges, which did not change, and
+         // queues the bad ones and the encroached segments among their edges
+         void inserted(uint32_t v)
+         {
+            inside_.resize(dt_.half_edges_num() / 3);
+
+            uint32_t first = dt_.out(v), e = first;
+            do
+            {
+               uint32_t t = e / 3, o = delaunay_triangulation::next(e);
+               inside_[t] = !dt_.is_ghost(t) && (inside_[dt_.twin(o) / 3] != dt_.constrained(o));
+               e = dt_.twin(delaunay_triangulation::prev(e));
+            }
+            while (e != first);
+
+            do
+            {
+               uint32_t t = e / 3;
+               if (!dt_.is_ghost(t))
+               {
+                  for (uint32_t f = 3 * t; f != 3 * t + 3; ++f)
+                     if (dt_.constrained(f) && encroached(f))
+                        segments_.push_back(std::make_pair(f, dt_.origin(f)));
+                  check(t);
+               }
+               e = dt_.twin(delaunay_triangulation::prev(e));
+            }
+            while (e != first);
+         }
+
+         delaunay_triangulation & dt_;
+         std::vector<uint8_t> inside_;
+         uint32_t inputs_;
+         double min_quality_, max_area_;
+         size_t max_points_;
+
+         // bad triangles given up on
+         size_t unsplit_;
+
+         // per steiner vertex the end points of the input segment it is on,
+         // no_edge for one inside
+         std::vector<std::pair<uint32_t, uint32_t> > segment_of_;
+
+         // per steiner vertex the input vertex it was put at a power of two
+         // 2^exponent from, no_edge for other splits
+         struct shell
+         {
+            uint32_t apex;
+            int exponent;
+         };
+         std::vector<shell> shells_;
+
+         // segments as (half-edge, origin) to check again, bad triangles
+         std::vector<std::pair<uint32_t, uint32_t> > segments_, encroached_;
+         std::priority_queue<bad_triangle> bad_;
+         std::vector<uint32_t> cavity_;
+      };
+   }
+
+   // constrained delaunay triangulation of the polygon (outer contour ccw,
+   // holes cw) refined with steiner points until no triangle has an angle
+   // under min_angle degrees or an area over max_area (0 for no bound).
+   // contour edges are split where needed, at most max_points steiner points
+   // are added (0 for no limit). replaces the contents of mesh: the polygon
+   // vertices as in triangulate, then the steiner points after
+   // contour_offsets.back(). min_angle is clamped to 33 degrees, beyond
+   // which refinement may not end. false if it was, if max_points stopped
+   // it or if a triangle too small to split is left under the bounds.
+   inline bool refined_delaunay(std::vector<contour_2> const & polygon, indexed_mesh & mesh, double min_angle = 20,
+                                double max_area = 0, size_t max_points = 0)
+   {
+      delaunay_triangulation dt;
+      detail::constrain_polygon(polygon, dt);
+
+      std::vector<uint8_t> inside(dt.half_edges_num() / 3);
+      for (uint32_t t : detail::interior_triangles(dt))
+         inside[t] = 1;
+
+      detail::refiner refiner(dt, inside, uint32_t(dt.points().size()), min_angle, max_area, max_points);
+      bool done = refiner.run() && min_angle <= detail::max_min_angle;
+
+      mesh.clear();
+      mesh.contour_offsets.push_back(0);
+      for (contour_2 const & c : polygon)
+         mesh.contour_offsets.push_back(uint32_t(mesh.contour_offsets.back() + c.size()));
+
+      mesh.vertices = dt.points();
+      for (uint32_t t = 0; t != refiner.inside().size(); ++t)
+         if (refiner.inside()[t])
+            for (uint32_t e = 3 * t; e != 3 * t + 3; ++e)
+               mesh.indices.push_back(dt.origin(e));
+      return done;
+   }
+
+   inline indexed_mesh refined_delaunay_indexed(std::vector<contour_2> const & polygon, double min_angle = 20,
+                                                double max_area = 0, size_t max_points = 0)
+   {
+      indexed_mesh mesh;
+      refined_delaunay(polygon, mesh, min_angle, max_area, max_points);
+      return mesh;
+   }
+}
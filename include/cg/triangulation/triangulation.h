@@ -2,173 +2,743 @@
 
 #include <algorithm>
 #include <vector>
-#include <map>
-#include <memory>
+#include <cstdint>
 #include <cg/primitives/point.h>
 #include <cg/primitives/contour.h>
 #include <cg/primitives/triangle.h>
 #include <cg/primitives/segment.h>
 #include <cg/operations/orientation.h>
+#include <cg/triangulation/indexed_mesh.h>
 
 namespace cg {
    enum v_type {SPLIT, MERGE, LEFT_REGULAR, RIGHT_REGULAR, START, END};
 
-   v_type vertex_type(const contour_2::circulator_t &c) {
-      auto cur = *c;
-      auto prev = *(c - 1);
-      auto next = *(c + 1);
-
+   inline v_type vertex_type(const point_2 &prev, const point_2 &cur, const point_2 &next) {
       bool right = orientation(prev, cur, next) == CG_RIGHT;
       if (cur > prev && cur > next) return right ? SPLIT : START;
       if (cur < prev && cur < next) return right ? MERGE : END;
       return next > cur ? RIGHT_REGULAR : LEFT_REGULAR;
    }
 
-   struct monotone_chain {
-      bool left;
-      std::vector<point_2> v;
-      monotone_chain() {}
+   inline v_type vertex_type(const contour_2::circulator_t &c) {
+      return vertex_type(*(c - 1), *c, *(c + 1));
+   }
+
+   namespace detail {
+      uint32_t const no_index = uint32_t(-1);
+
+      // stack of vertices waiting for triangles, a linked list in the node arena
+      struct sweep_chain {
+         uint32_t top, bottom, size;
+         bool left;
+      };
+
+      struct chain_node {
+         point_2 point;
+         uint32_t vertex, below;
+      };
+
+      // edge (edge, next[edge]) of the status with its helper vertex and
+      // the chains (at most two) of the region to its right. the end points
+      // are copied in, so a search step reads one entry.
+      struct status_entry {
+         point_2 a, b;
+         point_2 helper_point;
+         uint32_t edge, helper;
+         uint32_t chains[2];
+         uint32_t count;
+      };
+
+      // a vertex as the sweep meets it with its neighbours along the
+      // contour. the sweep reads points only from events, status entries and
+      // chain nodes, so the events may come from anywhere in sweep order.
+      struct sweep_event {
+         point_2 prev_point, point, next_point;
+         uint32_t prev, vertex, next;
+      };
+
+      // the sweep status as a b+-tree. leaves hold up to leaf_size sorted
+      // entries, inner nodes up to fanout children with the last edge of
+      // each, so a search reads few nodes and an insert or erase moves
+      // entries of one leaf instead of the whole status. edges are ordered
+      // by a predicate less(a, b) true for the edges (a, b) before the key,
+      // as the order depends on the sweep line. nodes are recycled, so a
+      // warm status does not allocate.
+      struct status_tree {
+         static uint32_t const leaf_size = 64;
+         static uint32_t const fanout = 32;
+
+         struct fence {
+            point_2 a, b;
+         };
+
+         struct inner_node {
+            uint32_t count;
+            uint32_t children[fanout];
+            fence fences[fanout];
+         };
+
+         status_tree() : root(no_index), height(0) {}
+
+         // the first entry not less than the key, null if there is none. the
+         // path to it is kept for refresh.
+         template <class Less>
+         status_entry *find(Less less) {
+            if (root == no_index) return nullptr;
+
+            uint32_t node = root;
+            for (uint32_t h = height; h != 0; --h) {
+               nodes[h] = node;
+               path[h] = child(inners[node], less);
+               node = inners[node].children[path[h]];
+            }
+            nodes[0] = node;
+
+            status_entry *first = leaf(node), *it = lower(first, sizes[node], less);
+            return it == first + sizes[node] ? nullptr : it;
+         }
+
+         // after the edge of the entry last found changed in place, keeping
+         // its place in the order
+         void refresh() {
+            for (uint32_t h = 1; h <= height; ++h)
+               inners[nodes[h]].fences[path[h]] = last(nodes[h - 1], h - 1);
+         }
+
+         // before the first entry not less than the key
+         template <class Less>
+         void insert(Less less, const status_entry &e) {
+            if (root == no_index) {
+               root = new_leaf();
+               height = 0;
+            }
+
+            uint32_t sibling = insert(root, height, less, e);
+            if (sibling != no_index) {
+               uint32_t up = new_inner();
+               inner_node &n = inners[up];
+               n.count = 2;
+               n.children[0] = root;
+               n.children[1] = sibling;
+               n.fences[0] = last(root, height);
+               n.fences[1] = last(sibling, height);
+               root = up;
+               ++height;
+            }
+         }
+
+         // the first entry not less than the key
+         template <class Less>
+         void erase(Less less) {
+            if (erase(root, height, less)) {
+               free_node(root, height);
+               root = no_index;
+            }
+            while (root != no_index && height != 0 && inners[root].count == 1) {
+               uint32_t only = inners[root].children[0];
+               free_inners.push_back(root);
+               root = only;
+               --height;
+            }
+         }
+
+         void clear() {
+            entries.clear();
+            sizes.clear();
+            inners.clear();
+            free_leaves.clear();
+            free_inners.clear();
+            root = no_index;
+            height = 0;
+         }
+
+         // leaf k holds entries [k * leaf_size, k * leaf_size + sizes[k])
+         std::vector<status_entry> entries;
+         std::vector<uint32_t> sizes;
+         std::vector<inner_node> inners;
+         std::vector<uint32_t> free_leaves, free_inners;
+
+      private:
+         template <class Less>
+         static uint32_t child(const inner_node &n, Less less) {
+            uint32_t l = 0, h = n.count - 1;
+            while (l != h) {
+               uint32_t mid = (l + h) / 2;
+               if (less(n.fences[mid].a, n.fences[mid].b)) l = mid + 1;
+               else h = mid;
+            }
+            return l;
+         }
+
+         template <class Less>
+         static status_entry *lower(status_entry *first, uint32_t size, Less less) {
+            uint32_t l = 0, h = size;
+            while (l != h) {
+               uint32_t mid = (l + h) / 2;
+               if (less(first[mid].a, first[mid].b)) l = mid + 1;
+               else h = mid;
+            }
+            return first + l;
+         }
+
+         status_entry *leaf(uint32_t k) {
+            return &entries[k * leaf_size];
+         }
+
+         fence last(uint32_t node, uint32_t h) {
+            if (h != 0) return inners[node].fences[inners[node].count - 1];
+            const status_entry &e = leaf(node)[sizes[node] - 1];
+            fence f = {e.a, e.b};
+            return f;
+         }
+
+         // inserts into the subtree, returns the new node after it if it split
+         template <class Less>
+         uint32_t insert(uint32_t node, uint32_t h, Less less, const status_entry &e) {
+            if (h == 0) {
+               uint32_t sibling = no_index, target = node;
+               uint32_t pos = uint32_t(lower(leaf(node), sizes[node], less) - leaf(node));
+               if (sizes[node] == leaf_size) {
+                  uint32_t half = leaf_size / 2;
+                  sibling = new_leaf();
+                  std::copy(leaf(node) + half, leaf(node) + leaf_size, leaf(sibling));
+                  sizes[node] = sizes[sibling] = half;
+                  if (pos > half) {
+                     target = sibling;
+                     pos -= half;
+                  }
+               }
+
+               status_entry *first = leaf(target);
+               std::copy_backward(first + pos, first + sizes[target], first + sizes[target] + 1);
+               first[pos] = e;
+               ++sizes[target];
+               return sibling;
+            }
+
+            uint32_t i = child(inners[node], less);
+            uint32_t c = inners[node].children[i];
+            uint32_t split = insert(c, h - 1, less, e);
+            inners[node].fences[i] = last(c, h - 1);
+            if (split == no_index) return no_index;
+
+            uint32_t sibling = no_index, target = node, pos = i + 1;
+            if (inners[node].count == fanout) {
+               uint32_t half = fanout / 2;
+               sibling = new_inner();
+               inner_node &n = inners[node], &s = inners[sibling];
+               std::copy(n.children + half, n.children + fanout, s.children);
+               std::copy(n.fences + half, n.fences + fanout, s.fences);
+               n.count = s.count = half;
+               if (pos > half) {
+                  target = sibling;
+                  pos -= half;
+               }
+            }
+
+            inner_node &n = inners[target];
+            std::copy_backward(n.children + pos, n.children + n.count, n.children + n.count + 1);
+            std::copy_backward(n.fences + pos, n.fences + n.count, n.fences + n.count + 1);
+            n.children[pos] = split;
+            n.fences[pos] = last(split, h - 1);
+            ++n.count;
+            return sibling;
+         }
+
+         // erases from the subtree, true if it is left empty
+         template <class Less>
+         bool erase(uint32_t node, uint32_t h, Less less) {
+            if (h == 0) {
+               status_entry *first = leaf(node), *it = lower(first, sizes[node], less);
+               std::copy(it + 1, first + sizes[node], it);
+               return --sizes[node] == 0;
+            }
+
+            uint32_t i = child(inners[node], less);
+            uint32_t c = inners[node].children[i];
+            inner_node &n = inners[node];
+            if (!erase(c, h - 1, less)) {
+               n.fences[i] = last(c, h - 1);
+               return false;
+            }
+
+            free_node(c, h - 1);
+            std::copy(n.children + i + 1, n.children + n.count, n.children + i);
+            std::copy(n.fences + i + 1, n.fences + n.count, n.fences + i);
+            return --n.count == 0;
+         }
+
+         uint32_t new_leaf() {
+            if (!free_leaves.empty()) {
+               uint32_t k = free_leaves.back();
+               free_leaves.pop_back();
+               sizes[k] = 0;
+               return k;
+            }
+            sizes.push_back(0);
+            entries.resize(entries.size() + leaf_size);
+            return uint32_t(sizes.size() - 1);
+         }
+
+         uint32_t new_inner() {
+            if (!free_inners.empty()) {
+               uint32_t k = free_inners.back();
+               free_inners.pop_back();
+               inners[k].count = 0;
+               return k;
+            }
+            inners.push_back(inner_node());
+            inners.back().count = 0;
+            return uint32_t(inners.size() - 1);
+         }
+
+         void free_node(uint32_t node, uint32_t h) {
+            if (h == 0) free_leaves.push_back(node);
+            else free_inners.push_back(node);
+         }
+
+         uint32_t root, height;
+         // node at every height on the way of the last find, and the child
+         // taken there
+         uint32_t nodes[16], path[16];
+      };
+   }
+
+   // buffers of the triangulation sweep. all of them keep their capacity
+   // between calls, so triangulating polygons of similar size with the same
+   // workspace does not touch the heap after the first call.
+   struct triangulation_workspace {
+      // vertices of all contours and their neighbours along the contour
+      std::vector<point_2> points;
+      std::vector<uint32_t> prev, next;
 
-      monotone_chain(const segment_2 &s1, bool left) : left(left) {
-         v.push_back(s1[0]);
-         v.push_back(s1[1]);
+      // vertices in sweep order
+      std::vector<uint32_t> order;
+
+      // sweep status, sorted by the edge order
+      detail::status_tree status;
+
+      std::vector<detail::sweep_chain> chains;
+      std::vector<detail::chain_node> nodes;
+
+      // monotone_partition: diagonals as vertex pairs, the diagonals
+      // around every vertex and the half-edges already in a piece
+      std::vector<uint32_t> diagonals, fan_offsets, fans;
+      std::vector<uint8_t> used;
+
+      void clear() {
+         points.clear();
+         prev.clear();
+         next.clear();
+         order.clear();
+         status.clear();
+         chains.clear();
+         nodes.clear();
+         diagonals.clear();
+         fan_offsets.clear();
+         fans.clear();
+         used.clear();
       }
    };
 
-   void add(std::vector<triangle_2> &result, std::vector<std::shared_ptr<monotone_chain>> &chains,
-         const segment_2 &s1, bool left = false) {
-      if (chains.size() == 0) {
-         chains.push_back(std::shared_ptr<monotone_chain>(new monotone_chain(s1, left)));
-         return;
-      }
-      for (auto &chain : chains) {
-         auto &v = chain->v;
-         auto &p1 = s1[1];
-         if (v.size() == 2 && s1[0] == v[0] && s1[1] == v[1]) continue;
-         if (s1[0] == v[0]) {
-            //other side
-            for (size_t i = 0; i < v.size() - 1; i++) {
-               result.push_back(triangle_2(p1, v[i + 1], v[i]));
-            }
-            v.erase(v.begin(), v.end() - 1);
-            v.push_back(p1);
-            chain->left ^= 1;
-         } else if (s1[0] == v.back()) {
-            //same side
-            orientation_t need = chain->left ? CG_RIGHT : CG_LEFT;
-            while (v.size() > 1 && orientation(p1, v[v.size() - 1], v[v.size() - 2]) == need) {
-               result.push_back(triangle_2(p1, v[v.size() - 1], v[v.size() - 2]));
-               v.pop_back();
-            }
-            v.push_back(p1);
+   namespace detail {
+      // order of the edges (a0, a1) and (b0, b1) crossing the sweep line
+      inline bool edge_less(const point_2 &a0, const point_2 &a1, const point_2 &b0, const point_2 &b1) {
+         if (a0.x < b0.x) {
+            auto res = orientation(b0, b1, a0);
+            if (res != CG_COLLINEAR) return res == CG_LEFT;
+         } else if (b0.x < a0.x) {
+            auto res = orientation(a0, a1, b0);
+            if (res != CG_COLLINEAR) return res == CG_RIGHT;
          }
+         if (a0 != b0) return a0 < b0;
+         return a1 < b1;
       }
-   }
 
-   std::vector<triangle_2> triangulate(const std::vector<contour_2> &polygon) {
-      std::vector<triangle_2> result;
+      // status edges before the segment (a, b)
+      struct status_key {
+         const point_2 &a, &b;
 
-      std::vector<contour_2::circulator_t> p;
-      for (const contour_2 &c : polygon) {
-         auto start = c.circulator();
-         auto cur = start;
-         do {
-            p.push_back(cur++);
-         } while (cur != start);
-      }
-      std::sort(p.begin(), p.end(),
-      [](const contour_2::circulator_t &c1, const contour_2::circulator_t &c2) { return *c1 > *c2; });
-      auto segment_comp = [](const segment_2 &s1, const segment_2 &s2) {
-               if (s1[0].x < s2[0].x) {
-                  auto res = orientation(s2[0], s2[1], s1[0]);
-                  if (res != CG_COLLINEAR) return res == CG_LEFT;
-               } else if (s2[0].x < s1[0].x) {
-                  auto res = orientation(s1[0], s1[1], s2[0]);
-                  if (res != CG_COLLINEAR) return res == CG_RIGHT;
-               }
-               if (s1[0] != s2[0]) return s1[0] < s2[0];
-               return s1[1] < s2[1];
-            };
-      typedef std::vector<std::shared_ptr<monotone_chain>> chains_t;
-      std::map<segment_2, std::pair<point_2, std::vector<std::shared_ptr<monotone_chain>>>,
-         decltype(segment_comp)> helper(segment_comp);
-      auto left_cont = [&helper, &result](const segment_2 &prev_edge, const point_2 &p, chains_t &res) {
-               const auto &ej = helper.lower_bound(prev_edge);
-               auto &old_helper = ej->second.first;
-               auto &chains = ej->second.second;
-               segment_2 new_seg(old_helper, p);
-               add(result, chains, prev_edge, true);
-               if (chains.size() == 2) {
-                  add(result, chains, new_seg);
-                  res[res.size() - 1] = chains[1];
-               } else {
-                  res[res.size() - 1] = chains[0];
+         bool operator()(const point_2 &ea, const point_2 &eb) const {
+            return edge_less(ea, eb, a, b);
+         }
+      };
+
+      // monotone decomposition and triangulation of the monotone pieces in
+      // one sweep. emit(a, b, c) gets vertex indices of every triangle, ccw.
+      template <class Emit>
+      struct monotone_sweep {
+         monotone_sweep(triangulation_workspace &ws, Emit &emit) : ws(ws), emit(emit) {}
+
+         void run() {
+            std::vector<point_2> const &pts = ws.points;
+            std::sort(ws.order.begin(), ws.order.end(),
+                      [&pts](uint32_t a, uint32_t b) { return pts[a] > pts[b]; });
+
+            for (uint32_t c : ws.order) {
+               uint32_t prev = ws.prev[c], next = ws.next[c];
+               sweep_event ev = {pts[prev], pts[c], pts[next], prev, c, next};
+               process(ev);
+            }
+         }
+
+         // the events must come in descending order of their points
+         void process(const sweep_event &ev) {
+            v_type type = vertex_type(ev.prev_point, ev.point, ev.next_point);
+
+            if (type == SPLIT) split(ev);
+
+            uint32_t res[2] = {no_index, no_index};
+            uint32_t count = 0;
+            if (type == MERGE) count = 2;
+            else if (type == LEFT_REGULAR || type == RIGHT_REGULAR || type == END) count = 1;
+
+            if (type == MERGE) {
+               left_cont(ev, res, count);
+               right_cont(ev, res, count);
+            }
+            if (type == END) {
+               right_cont(ev, res, count);
+               left_cont(ev, res, count);
+            }
+            if (type == LEFT_REGULAR) left_cont(ev, res, count, true);
+            if (type == RIGHT_REGULAR) right_cont(ev, res, count);
+
+            if (type == START) insert(ev, res, count);
+         }
+
+         // drops the chains no status entry refers to any more and the nodes
+         // popped off chains, renumbering the rest, so the arena holds only
+         // what is live. for sweeps too long to keep every node.
+         void compact() {
+            remap.assign(ws.chains.size(), no_index);
+            chains.clear();
+            nodes.clear();
+            status_tree &st = ws.status;
+            for (size_t k = 0; k != st.sizes.size(); ++k)
+               for (status_entry *e = &st.entries[k * status_tree::leaf_size], *end = e + st.sizes[k]; e != end; ++e)
+                  for (uint32_t i = 0; i != e->count; ++i) {
+                     uint32_t &c = e->chains[i];
+                     if (remap[c] == no_index) {
+                        sweep_chain ch = ws.chains[c];
+                        uint32_t top = uint32_t(nodes.size());
+                        for (uint32_t nd = ch.top; nd != no_index; nd = ws.nodes[nd].below) {
+                           nodes.push_back(ws.nodes[nd]);
+                           nodes.back().below = uint32_t(nodes.size());
+                        }
+                        nodes.back().below = no_index;
+                        ch.top = top;
+                        remap[c] = uint32_t(chains.size());
+                        chains.push_back(ch);
+                     }
+                     c = remap[c];
+                  }
+            ws.chains.swap(chains);
+            ws.nodes.swap(nodes);
+         }
+
+      private:
+         static status_key find_edge(const point_2 &a, const point_2 &b) {
+            status_key k = {a, b};
+            return k;
+         }
+
+         static status_key find_vertex(const point_2 &v) {
+            status_key k = {v, v};
+            return k;
+         }
+
+         // the edge from the vertex of ev to the next one, with that vertex
+         // as the helper
+         void insert(const sweep_event &ev, const uint32_t *chains, uint32_t count) {
+            status_entry e;
+            e.a = ev.point;
+            e.b = ev.next_point;
+            e.helper_point = ev.point;
+            e.edge = e.helper = ev.vertex;
+            e.count = count;
+            std::copy(chains, chains + count, e.chains);
+            ws.status.insert(find_edge(ev.point, ev.next_point), e);
+         }
+
+         uint32_t new_node(uint32_t vertex, const point_2 &point, uint32_t below) {
+            chain_node nd = {point, vertex, below};
+            ws.nodes.push_back(nd);
+            return uint32_t(ws.nodes.size() - 1);
+         }
+
+         uint32_t vertex(uint32_t node) const {
+            return ws.nodes[node].vertex;
+         }
+
+         // triangles cut off a chain turn to the side opposite to the chain
+         void emit_ccw(sweep_chain const &ch, uint32_t a, uint32_t b, uint32_t c) {
+            if (ch.left) emit(a, c, b);
+            else emit(a, b, c);
+         }
+
+         // feeds the edge (a, b) to the chains of a region
+         void add(uint32_t *chains, uint32_t &count, uint32_t a, const point_2 &pa, uint32_t b, const point_2 &pb,
+                  bool left = false) {
+            if (count == 0) {
+               sweep_chain ch;
+               ch.top = new_node(b, pb, new_node(a, pa, no_index));
+               ch.bottom = a;
+               ch.size = 2;
+               ch.left = left;
+               ws.chains.push_back(ch);
+               chains[count++] = uint32_t(ws.chains.size() - 1);
+               return;
+            }
+
+            for (uint32_t k = 0; k != count; ++k) {
+               sweep_chain &ch = ws.chains[chains[k]];
+               if (ch.size == 2 && a == ch.bottom && b == vertex(ch.top)) continue;
+               if (a == ch.bottom) {
+                  //other side
+                  for (uint32_t nd = ch.top; ws.nodes[nd].below != no_index; nd = ws.nodes[nd].below)
+                     emit_ccw(ch, b, vertex(nd), vertex(ws.nodes[nd].below));
+                  ws.nodes[ch.top].below = no_index;
+                  ch.bottom = vertex(ch.top);
+                  ch.top = new_node(b, pb, ch.top);
+                  ch.size = 2;
+                  ch.left ^= 1;
+               } else if (a == vertex(ch.top)) {
+                  //same side
+                  orientation_t need = ch.left ? CG_RIGHT : CG_LEFT;
+                  while (ch.size > 1) {
+                     uint32_t below = ws.nodes[ch.top].below;
+                     if (orientation(pb, ws.nodes[ch.top].point, ws.nodes[below].point) != need) break;
+                     emit_ccw(ch, b, vertex(ch.top), vertex(below));
+                     ch.top = below;
+                     --ch.size;
+                  }
+                  ch.top = new_node(b, pb, ch.top);
+                  ++ch.size;
                }
-               helper[ej->first] = std::make_pair(p, res);
-               helper.erase(prev_edge);
-            };
-      auto right_cont = [&helper, &result](const segment_2 &rev_cur_edge, const point_2 &p, chains_t &res) {
-               segment_2 cur_vertex(p, p);
-               const auto &ej = helper.lower_bound(cur_vertex);
-               auto &old_helper = ej->second.first;
-               auto &chains = ej->second.second;
-               segment_2 new_seg(old_helper, p);
-               add(result, chains, rev_cur_edge, false);
-               res[0] = chains[0];
-               if (chains.size() == 2) add(result, chains, new_seg);
-               helper[ej->first] = std::make_pair(p, res);
-               helper.erase(cur_vertex);
-            };
-      for (auto &c : p) {
-         v_type type = vertex_type(c);
-         segment_2 prev_edge(*(c - 1), *c);
-         segment_2 cur_edge(*c, *(c + 1));
-         segment_2 rev_cur_edge(*(c + 1), *c);
-         segment_2 cur_vertex(*c, *c);
-         if (type == SPLIT) {
-            const auto &ej = helper.lower_bound(cur_vertex);
-            auto &old_helper = ej->second.first;
-            auto &chains = ej->second.second;
-            segment_2 new_seg(old_helper, *c);
-            chains_t new_chains;
-            point_2 new_helper;
-            new_helper = old_helper = *c;
-            add(result, chains, new_seg, false);
-            if (chains.size() == 2) {
+            }
+         }
+
+         void split(const sweep_event &ev) {
+            uint32_t c = ev.vertex;
+            status_entry &e = *ws.status.find(find_vertex(ev.point));
+            uint32_t old_helper = e.helper;
+            point_2 old_point = e.helper_point;
+            e.helper = c;
+            e.helper_point = ev.point;
+            add(e.chains, e.count, old_helper, old_point, c, ev.point, false);
+
+            uint32_t new_chains[2];
+            uint32_t new_count = 0;
+            if (e.count == 2) {
                //merge
-               new_chains.push_back(*(--chains.end()));
-               chains.erase(--chains.end());
-               helper[ej->first] = std::make_pair(old_helper, chains);
-               helper[cur_edge] = std::make_pair(new_helper, new_chains);
+               new_chains[new_count++] = e.chains[--e.count];
+               insert(ev, new_chains, new_count);
             } else {
                //ordinary
-               add(result, new_chains, new_seg, !chains[0]->left);
-               if (chains[0]->left) {
-                  helper[cur_edge] = std::make_pair(old_helper, chains);
-                  helper[ej->first] = std::make_pair(new_helper, new_chains);
+               add(new_chains, new_count, old_helper, old_point, c, ev.point, !ws.chains[e.chains[0]].left);
+               if (ws.chains[e.chains[0]].left) {
+                  uint32_t chains[2] = {e.chains[0], no_index};
+                  uint32_t count = e.count;
+                  std::copy(new_chains, new_chains + new_count, e.chains);
+                  e.count = new_count;
+                  insert(ev, chains, count);
                } else {
-                  helper[cur_edge] = std::make_pair(new_helper, new_chains);
-                  helper[ej->first] = std::make_pair(old_helper, chains);
+                  insert(ev, new_chains, new_count);
                }
             }
          }
-         chains_t res;
-         if (type == MERGE) res = chains_t(2);
-         else if (type == LEFT_REGULAR || type == RIGHT_REGULAR || type == END) res = chains_t(1);
 
-         if (type == MERGE) {
-            left_cont(prev_edge, *c, res);
-            right_cont(rev_cur_edge, *c, res);
+         // the edge prev -> c ends at c. on a left regular vertex the edge
+         // c -> next takes its place in the status.
+         void left_cont(const sweep_event &ev, uint32_t *res, uint32_t count, bool replace = false) {
+            uint32_t c = ev.vertex;
+            status_entry &e = *ws.status.find(find_edge(ev.prev_point, ev.point));
+            uint32_t helper = e.helper;
+            point_2 helper_point = e.helper_point;
+            add(e.chains, e.count, ev.prev, ev.prev_point, c, ev.point, true);
+            if (e.count == 2) {
+               add(e.chains, e.count, helper, helper_point, c, ev.point);
+               res[count - 1] = e.chains[1];
+            } else {
+               res[count - 1] = e.chains[0];
+            }
+
+            if (replace) {
+               e.a = ev.point;
+               e.b = ev.next_point;
+               e.helper_point = ev.point;
+               e.edge = e.helper = c;
+               e.count = count;
+               std::copy(res, res + count, e.chains);
+               ws.status.refresh();
+            } else {
+               ws.status.erase(find_edge(ev.prev_point, ev.point));
+            }
          }
-         if (type == END) {
-            right_cont(rev_cur_edge, *c, res);
-            left_cont(prev_edge, *c, res);
+
+         // the edge next -> c ends at c, the region is the one left of c
+         void right_cont(const sweep_event &ev, uint32_t *res, uint32_t count) {
+            uint32_t c = ev.vertex;
+            status_entry &e = *ws.status.find(find_vertex(ev.point));
+            uint32_t helper = e.helper;
+            add(e.chains, e.count, ev.next, ev.next_point, c, ev.point, false);
+            res[0] = e.chains[0];
+            if (e.count == 2) add(e.chains, e.count, helper, e.helper_point, c, ev.point);
+            e.helper = c;
+            e.helper_point = ev.point;
+            e.count = count;
+            std::copy(res, res + count, e.chains);
          }
-         if (type == LEFT_REGULAR) left_cont(prev_edge, *c, res);
-         if (type == RIGHT_REGULAR) right_cont(rev_cur_edge, *c, res);
 
-         if (type == LEFT_REGULAR || type == START) helper[cur_edge] = std::make_pair(*c, res);
+         triangulation_workspace &ws;
+         Emit &emit;
+
+         // buffers of compact
+         std::vector<uint32_t> remap;
+         std::vector<sweep_chain> chains;
+         std::vector<chain_node> nodes;
+      };
+
+      inline void load_polygon(const std::vector<contour_2> &polygon, triangulation_workspace &ws) {
+         ws.clear();
+         for (const contour_2 &c : polygon) {
+            uint32_t first = uint32_t(ws.points.size()), n = uint32_t(c.size());
+            if (n == 0) continue;
+            for (uint32_t i = 0; i != n; ++i) {
+               ws.points.push_back(c[i]);
+               ws.prev.push_back(first + (i + n - 1) % n);
+               ws.next.push_back(first + (i + 1) % n);
+               ws.order.push_back(first + i);
+            }
+         }
       }
+
+      // contours up to this size are ear clipped in arrays on the stack
+      uint32_t const max_ear_vertices = 32;
+
+      // a fan from vertex 0 if the single contour in ws turns strictly left
+      // at every vertex. collinear vertices would give flat triangles.
+      template <class Emit>
+      bool triangulate_convex(const triangulation_workspace &ws, Emit &emit) {
+         const std::vector<point_2> &p = ws.points;
+         uint32_t n = uint32_t(p.size());
+         for (uint32_t i = 0; i != n; ++i)
+            if (orientation(p[ws.prev[i]], p[i], p[ws.next[i]]) != CG_LEFT)
+               return false;
+
+         for (uint32_t i = 1; i + 1 != n; ++i)
+            emit(0, i, i + 1);
+         return true;
+      }
+
+      // ear clipping of the single contour in ws, at most max_ear_vertices.
+      // an ear turns strictly left and no other vertex is in its closed
+      // triangle. false, with nothing emitted, if a degenerate contour runs
+      // out of ears.
+      template <class Emit>
+      bool clip_ears(const triangulation_workspace &ws, Emit &emit) {
+         const std::vector<point_2> &p = ws.points;
+         uint32_t n = uint32_t(p.size());
+         uint32_t prev[max_ear_vertices] = {}, next[max_ear_vertices] = {}, tris[3 * max_ear_vertices];
+         for (uint32_t i = 0; i != n; ++i) {
+            prev[i] = ws.prev[i];
+            next[i] = ws.next[i];
+         }
+
+         uint32_t size = 0, v = 0;
+         for (uint32_t left = n, tried = 0; left > 3; ) {
+            uint32_t a = prev[v], c = next[v];
+            bool ear = orientation(p[a], p[v], p[c]) == CG_LEFT;
+            for (uint32_t w = next[c]; ear && w != a; w = next[w])
+               ear = orientation(p[a], p[v], p[w]) == CG_RIGHT || orientation(p[v], p[c], p[w]) == CG_RIGHT
+                     || orientation(p[c], p[a], p[w]) == CG_RIGHT;
+
+            if (!ear) {
+               if (++tried == left) return false;
+               v = c;
+               continue;
+            }
+
+            tris[size++] = a, tris[size++] = v, tris[size++] = c;
+            next[a] = c;
+            prev[c] = a;
+            v = a;
+            --left;
+            tried = 0;
+         }
+
+         if (orientation(p[prev[v]], p[v], p[next[v]]) != CG_LEFT)
+            return false;
+         tris[size++] = prev[v], tris[size++] = v, tris[size++] = next[v];
+
+         for (uint32_t l = 0; l != size; l += 3)
+            emit(tris[l], tris[l + 1], tris[l + 2]);
+         return true;
+      }
+
+      // calls emit(a, b, c) with indices into ws.points, contours concatenated.
+      // a single convex contour is fanned and a small one ear clipped, the
+      // rest goes through the sweep.
+      template <class Emit>
+      void triangulate(const std::vector<contour_2> &polygon, triangulation_workspace &ws, Emit emit) {
+         load_polygon(polygon, ws);
+         if (polygon.size() == 1 && ws.points.size() >= 3) {
+            if (triangulate_convex(ws, emit))
+               return;
+            if (ws.points.size() <= max_ear_vertices && clip_ears(ws, emit))
+               return;
+         }
+         monotone_sweep<Emit>(ws, emit).run();
+      }
+   }
+
+   // triangles of the polygon (outer contour ccw, holes cw) replace the
+   // contents of result. nothing is allocated once ws and result are warm.
+   inline void triangulate(const std::vector<contour_2> &polygon, triangulation_workspace &ws,
+                           std::vector<triangle_2> &result) {
+      result.clear();
+      std::vector<point_2> const &pts = ws.points;
+      detail::triangulate(polygon, ws, [&result, &pts](uint32_t a, uint32_t b, uint32_t c) {
+         result.push_back(triangle_2(pts[a], pts[b], pts[c]));
+      });
+   }
+
+   // the same as an indexed mesh over the input vertices, with the source
+   // contour of every triangle if contour_ids is set
+   inline void triangulate(const std::vector<contour_2> &polygon, triangulation_workspace &ws,
+                           indexed_mesh &mesh, bool contour_ids = false) {
+      mesh.clear();
+      mesh.contour_offsets.push_back(0);
+      for (const contour_2 &c : polygon)
+         mesh.contour_offsets.push_back(uint32_t(mesh.contour_offsets.back() + c.size()));
+
+      std::vector<uint32_t> &indices = mesh.indices;
+      detail::triangulate(polygon, ws, [&indices](uint32_t a, uint32_t b, uint32_t c) {
+         indices.push_back(a);
+         indices.push_back(b);
+         indices.push_back(c);
+      });
+      mesh.vertices.assign(ws.points.begin(), ws.points.end());
+
+      if (contour_ids) {
+         mesh.triangle_contours.resize(mesh.triangles_num());
+         for (size_t t = 0; t != mesh.triangles_num(); ++t)
+            mesh.triangle_contours[t] = uint32_t(mesh.contour(std::min(std::min(indices[3 * t], indices[3 * t + 1]), indices[3 * t + 2])));
+      }
+   }
+
+   inline indexed_mesh triangulate_indexed(const std::vector<contour_2> &polygon, bool contour_ids = false) {
+      triangulation_workspace ws;
+      indexed_mesh mesh;
+      triangulate(polygon, ws, mesh, contour_ids);
+      return mesh;
+   }
+
+   inline std::vector<triangle_2> triangulate(const std::vector<contour_2> &polygon) {
+      triangulation_workspace ws;
+      std::vector<triangle_2> result;
+      triangulate(polygon, ws, result);
       return result;
    }
 }
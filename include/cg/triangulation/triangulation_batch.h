@@ -0,0 +1,140 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+#include <cg/primitives/contour.h>
+#include <cg/common/parallel.h>
+#include <cg/triangulation/triangulation.h>
+#include <cg/triangulation/indexed_mesh.h>
+
+namespace cg
+{
+   // triangulations of many polygons in one mesh. polygon k owns the
+   // vertices [vertex_offsets[k], vertex_offsets[k + 1]) and the triangles
+   // [triangle_offsets[k], triangle_offsets[k + 1]). contour_offsets of the
+   // mesh run over the contours of all polygons in order.
+   struct mesh_batch
+   {
+      indexed_mesh mesh;
+      std::vector<uint32_t> vertex_offsets, triangle_offsets;
+
+      size_t polygons_num() const
+      {
+         return vertex_offsets.empty() ? 0 : vertex_offsets.size() - 1;
+      }
+
+      void clear()
+      {
+         mesh.clear();
+         vertex_offsets.clear();
+         triangle_offsets.clear();
+      }
+   };
+
+   namespace detail
+   {
+      // polygons taken by a worker at a time
+      size_t const batch_chunk = 64;
+
+      // triangles of a chunk of polygons in the buffer of the worker that
+      // took it, with global vertex ids
+      struct batch_piece
+      {
+         uint32_t worker;
+         size_t begin;
+      };
+   }
+
+   // triangulates polygons [first, last) (random access, each a vector of
+   // contours like for triangulate) into one mesh. workers take chunks of
+   // polygons as they finish the previous ones, each with its own workspace
+   // from workspaces, which keep their buffers for the next call. the
+   // result is the same for any number of threads.
+   template <class Iter>
+   void triangulate_batch(Iter first, Iter last, mesh_batch & res, std::vector<triangulation_workspace> & workspaces,
+                          bool contour_ids = false, size_t threads = 0)
+   {
+      if (threads == 0)
+         threads = common::default_threads();
+
+      size_t n = last - first, chunks = (n + detail::batch_chunk - 1) / detail::batch_chunk;
+      threads = std::max<size_t>(1, std::min(threads, chunks));
+      if (workspaces.size() < threads)
+         workspaces.resize(threads);
+
+      res.clear();
+      res.vertex_offsets.reserve(n + 1);
+      res.vertex_offsets.push_back(0);
+      res.mesh.contour_offsets.push_back(0);
+      for (size_t k = 0; k != n; ++k)
+      {
+         std::vector<contour_2> const & polygon = first[k];
+         for (size_t c = 0; c != polygon.size(); ++c)
+            res.mesh.contour_offsets.push_back(uint32_t(res.mesh.contour_offsets.back() + polygon[c].size()));
+         res.vertex_offsets.push_back(res.mesh.contour_offsets.back());
+      }
+      res.mesh.vertices.resize(res.vertex_offsets.back());
+
+      // per polygon the number of triangles, then the prefix sums
+      res.triangle_offsets.assign(n + 1, 0);
+      std::vector<std::vector<uint32_t> > buffers(threads);
+      std::vector<detail::batch_piece> pieces(chunks);
+      std::atomic<size_t> next_chunk(0);
+
+      common::parallel_for(0, threads, [&] (size_t w)
+      {
+         triangulation_workspace & ws = workspaces[w];
+         std::vector<uint32_t> & out = buffers[w];
+         for (size_t chunk; (chunk = next_chunk++) < chunks; )
+         {
+            pieces[chunk].worker = uint32_t(w);
+            pieces[chunk].begin = out.size();
+            for (size_t k = chunk * detail::batch_chunk; k != std::min(n, (chunk + 1) * detail::batch_chunk); ++k)
+            {
+               std::vector<contour_2> const & polygon = first[k];
+               uint32_t base = res.vertex_offsets[k];
+               size_t size = out.size();
+               detail::triangulate(polygon, ws, [&out, base] (uint32_t a, uint32_t b, uint32_t c)
+               {
+                  out.push_back(base + a);
+                  out.push_back(base + b);
+                  out.push_back(base + c);
+               });
+               std::copy(ws.points.begin(), ws.points.end(), res.mesh.vertices.begin() + base);
+               res.triangle_offsets[k + 1] = uint32_t((out.size() - size) / 3);
+            }
+         }
+      }, threads);
+
+      for (size_t k = 0; k != n; ++k)
+         res.triangle_offsets[k + 1] += res.triangle_offsets[k];
+
+      std::vector<uint32_t> & indices = res.mesh.indices;
+      indices.resize(3 * size_t(res.triangle_offsets.back()));
+      common::parallel_for(0, chunks, [&] (size_t c)
+      {
+         size_t lo = c * detail::batch_chunk, hi = std::min(n, lo + detail::batch_chunk);
+         uint32_t const * src = buffers[pieces[c].worker].data() + pieces[c].begin;
+         std::copy(src, src + 3 * size_t(res.triangle_offsets[hi] - res.triangle_offsets[lo]), indices.begin() + 3 * size_t(res.triangle_offsets[lo]));
+      }, threads);
+
+      if (contour_ids)
+      {
+         res.mesh.triangle_contours.resize(res.mesh.triangles_num());
+         common::parallel_for(0, res.mesh.triangles_num(), [&] (size_t t)
+         {
+            res.mesh.triangle_contours[t] = uint32_t(res.mesh.contour(std::min(std::min(indices[3 * t], indices[3 * t + 1]), indices[3 * t + 2])));
+         }, threads, 4096);
+      }
+   }
+
+   template <class Iter>
+   void triangulate_batch(Iter first, Iter last, mesh_batch & res, bool contour_ids = false, size_t threads = 0)
+   {
+      std::vector<triangulation_workspace> workspaces;
+      triangulate_batch(first, last, res, workspaces, contour_ids, threads);
+   }
+}
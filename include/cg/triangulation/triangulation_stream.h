@@ -0,0 +1,263 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/contour.h>
+#include <cg/triangulation/triangulation.h>
+
+namespace cg
+{
+   // polygon files of triangulate_stream: the contours one after another,
+   // each a uint32_t vertex count followed by the vertices as x, y doubles,
+   // in native byte order. false if writing fails.
+   inline bool write_polygon(std::FILE * out, std::vector<contour_2> const & polygon)
+   {
+      for (contour_2 const & c : polygon)
+      {
+         uint32_t n = uint32_t(c.size());
+         if (std::fwrite(&n, sizeof(n), 1, out) != 1)
+            return false;
+
+         for (point_2 const & p : c)
+         {
+            double xy[2] = {p.x, p.y};
+            if (std::fwrite(xy, sizeof(double), 2, out) != 2)
+               return false;
+         }
+      }
+      return true;
+   }
+
+   namespace detail
+   {
+      // points read from a polygon file at a time
+      size_t const stream_block = 1 << 12;
+
+      // smallest buffer of a run in the merge, in events
+      size_t const min_run_buffer = 1 << 10;
+
+      // chain nodes of the streaming sweep before it first drops dead ones
+      size_t const min_compact = 1 << 12;
+
+      // sweep order, equal points by vertex
+      inline bool event_before(sweep_event const & a, sweep_event const & b)
+      {
+         return a.point > b.point || (a.point == b.point && a.vertex < b.vertex);
+      }
+
+      // calls f(ev) for every vertex of a polygon file in file order with
+      // vertex ids over all contours, holding one block of points. false if
+      // f does, if the file is cut short or on a contour of one or two
+      // vertices.
+      template <class F>
+      bool read_events(std::FILE * in, F f)
+      {
+         std::vector<double> block(2 * stream_block);
+         uint32_t first = 0;
+         for (uint32_t n; std::fread(&n, sizeof(n), 1, in) == 1; first += n)
+         {
+            if (n == 0)
+               continue;
+            if (n < 3)
+               return false;
+
+            // the first two points and the last two read
+            point_2 p0, p1, a, b;
+            for (uint32_t i = 0; i != n; )
+            {
+               size_t count = std::min<size_t>(n - i, stream_block);
+               if (std::fread(block.data(), sizeof(double), 2 * count, in) != 2 * count)
+                  return false;
+
+               for (size_t k = 0; k != count; ++k, ++i)
+               {
+                  point_2 p(block[2 * k], block[2 * k + 1]);
+                  if (i == 0)
+                     p0 = p;
+                  else if (i == 1)
+                     p1 = p;
+                  else
+                  {
+                     sweep_event ev = {a, b, p, first + i - 2, first + i - 1, first + i};
+                     if (!f(ev))
+                        return false;
+                  }
+                  a = b;
+                  b = p;
+               }
+            }
+
+            sweep_event last = {a, b, p0, first + n - 2, first + n - 1, first};
+            sweep_event head = {b, p0, p1, first + n - 1, first, first + 1};
+            if (!f(last) || !f(head))
+               return false;
+         }
+         return std::ferror(in) == 0;
+      }
+
+      // external merge sort of sweep events. runs of run_size events are
+      // sorted in memory and written to temporary files, which are merged
+      // through a buffer each, run_size events for all of them. a single
+      // run stays in memory.
+      struct event_sorter
+      {
+         explicit event_sorter(size_t run_size)
+            : run_size_(std::max<size_t>(run_size, 1))
+         {}
+
+         ~event_sorter()
+         {
+            for (std::FILE * f : runs_)
+               std::fclose(f);
+         }
+
+         bool push(sweep_event const & ev)
+         {
+            buffer_.push_back(ev);
+            return buffer_.size() < run_size_ || flush();
+         }
+
+         // calls f(ev) for all events in sweep order, false if reading a
+         // run fails
+         template <class F>
+         bool merge(F f)
+         {
+            if (runs_.empty())
+            {
+               std::sort(buffer_.begin(), buffer_.end(), event_before);
+               for (sweep_event const & ev : buffer_)
+                  f(ev);
+               return true;
+            }
+
+            if (!buffer_.empty() && !flush())
+               return false;
+            std::vector<sweep_event>().swap(buffer_);
+
+            size_t k = runs_.size();
+            std::vector<run> runs(k);
+            std::vector<uint32_t> heap;
+            for (uint32_t r = 0; r != k; ++r)
+            {
+               std::rewind(runs_[r]);
+               runs[r].file = runs_[r];
+               runs[r].events.resize(std::max(min_run_buffer, run_size_ / k));
+               if (runs[r].fill())
+                  heap.push_back(r);
+            }
+
+            auto later = [&runs] (uint32_t a, uint32_t b) { return event_before(runs[b].head(), runs[a].head()); };
+            std::make_heap(heap.begin(), heap.end(), later);
+            while (!heap.empty())
+            {
+               std::pop_heap(heap.begin(), heap.end(), later);
+               run & r = runs[heap.back()];
+               f(r.head());
+               if (++r.pos != r.size || r.fill())
+                  std::push_heap(heap.begin(), heap.end(), later);
+               else
+                  heap.pop_back();
+            }
+
+            for (run const & r : runs)
+               if (std::ferror(r.file))
+                  return false;
+            return true;
+         }
+
+      private:
+         struct run
+         {
+            std::FILE * file;
+            std::vector<sweep_event> events;
+            size_t pos, size;
+
+            sweep_event const & head() const { return events[pos]; }
+
+            // false at the end of the run
+            bool fill()
+            {
+               pos = 0;
+               size = std::fread(events.data(), sizeof(sweep_event), events.size(), file);
+               return size != 0;
+            }
+         };
+
+         bool flush()
+         {
+            std::sort(buffer_.begin(), buffer_.end(), event_before);
+            std::FILE * f = std::tmpfile();
+            if (!f)
+               return false;
+
+            runs_.push_back(f);
+            bool ok = std::fwrite(buffer_.data(), sizeof(sweep_event), buffer_.size(), f) == buffer_.size();
+            buffer_.clear();
+            return ok;
+         }
+
+         size_t run_size_;
+         std::vector<sweep_event> buffer_;
+         std::vector<std::FILE *> runs_;
+      };
+   }
+
+   // triangulates the polygon of a polygon file (outer contours ccw, holes
+   // cw) without holding it in memory. the vertices are put in sweep order
+   // by an external sort with run_size events in memory, then the monotone
+   // sweep keeps only its status and the open chains, dropping the rest as
+   // it goes, and emit(a, b, c) gets the vertex indices of every triangle,
+   // ccw, once it is done. for distinct points the triangles are those of
+   // the sweep of triangulate. false if the file is malformed or a
+   // temporary file fails.
+   template <class Emit>
+   bool triangulate_stream(std::FILE * in, Emit emit, size_t run_size = size_t(1) << 20)
+   {
+      detail::event_sorter sorter(run_size);
+      if (!detail::read_events(in, [&sorter] (detail::sweep_event const & ev) { return sorter.push(ev); }))
+         return false;
+
+      triangulation_workspace ws;
+      detail::monotone_sweep<Emit> sweep(ws, emit);
+      size_t compact = detail::min_compact;
+      return sorter.merge([&] (detail::sweep_event const & ev)
+      {
+         sweep.process(ev);
+         if (ws.nodes.size() >= compact)
+         {
+            sweep.compact();
+            compact = std::max(detail::min_compact, 2 * ws.nodes.size());
+         }
+      });
+   }
+
+   // the same writing every triangle to out as three uint32_t vertex
+   // indices, in native byte order
+   inline bool triangulate_stream(std::FILE * in, std::FILE * out, size_t run_size = size_t(1) << 20)
+   {
+      std::vector<uint32_t> buffer;
+      buffer.reserve(3 * detail::stream_block);
+      bool written = true;
+      auto flush = [&buffer, &written, out] ()
+      {
+         written = written && std::fwrite(buffer.data(), sizeof(uint32_t), buffer.size(), out) == buffer.size();
+         buffer.clear();
+      };
+
+      bool read = triangulate_stream(in, [&buffer, &flush] (uint32_t a, uint32_t b, uint32_t c)
+      {
+         buffer.push_back(a);
+         buffer.push_back(b);
+         buffer.push_back(c);
+         if (buffer.size() == buffer.capacity())
+            flush();
+      }, run_size);
+
+      flush();
+      return read && written;
+   }
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include <cg/primitives/point.h>
+#include <cg/primitives/contour.h>
+#include <cg/primitives/rectangle.h>
+#include <cg/operations/circumcenter.h>
+#include <cg/common/parallel.h>
+#include <cg/triangulation/indexed_mesh.h>
+#include <cg/triangulation/half_edge_mesh.h>
+#include <cg/triangulation/delaunay_dc.h>
+
+namespace cg
+{
+   // voronoi cells clipped to a box, in flat arrays: the cell of site k is
+   // the convex ccw polygon vertices[offsets[k]], ...,
+   // vertices[offsets[k + 1] - 1]. it is empty for a site equal to an
+   // earlier one and for a cell outside the box.
+   struct voronoi_diagram
+   {
+      std::vector<point_2> vertices;
+      std::vector<uint32_t> offsets;
+
+      size_t cells_num() const
+      {
+         return offsets.empty() ? 0 : offsets.size() - 1;
+      }
+
+      contour_2 cell(size_t k) const
+      {
+         return contour_2(std::vector<point_2>(vertices.begin() + offsets[k], vertices.begin() + offsets[k + 1]));
+      }
+
+      void clear()
+      {
+         vertices.clear();
+         offsets.clear();
+      }
+   };
+
+   namespace detail
+   {
+      // fewer sites per thread are done on one thread
+      size_t const voronoi_min_parallel = 1 << 12;
+
+      // the part of the convex polygon in where f(p) <= 0 for an affine f,
+      // snap(p) moves a new vertex onto the line exactly where it can
+      template <class F, class Snap>
+      void clip_convex(std::vector<point_2> const & in, std::vector<point_2> & out, F f, Snap snap)
+      {
+         out.clear();
+         for (size_t l = 0; l != in.size(); ++l)
+         {
+            point_2 const & a = in[l], & b = in[l + 1 == in.size() ? 0 : l + 1];
+            double fa = f(a), fb = f(b);
+            if (fa <= 0)
+               out.push_back(a);
+            if ((fa < 0 && fb > 0) || (fa > 0 && fb < 0))
+            {
+               double t = fa / (fa - fb);
+               point_2 p(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y));
+               snap(p);
+               out.push_back(p);
+            }
+         }
+      }
+
+      // cells from a delaunay triangulation of the sites: the circumcenters
+      // of the triangles around an inner site in ccw order, clipped to the
+      // box when they leave it, and for a site on the hull, whose cell is
+      // unbounded, the box cut by the bisectors with its neighbours. with
+      // no triangles the sites are on a line and the neighbours are the
+      // next ones along it.
+      struct voronoi_builder
+      {
+         voronoi_builder(std::vector<point_2> const & sites, rectangle_2 const & box, size_t threads)
+            : sites_(sites)
+            , box_(box)
+         {
+            indexed_mesh mesh;
+            std::vector<uint32_t> twins;
+            delaunay_mesh(sites, mesh, twins, threads);
+            mesh_ = half_edge_mesh(mesh, twins);
+
+            centers_.resize(mesh.triangles_num());
+            common::parallel_for(0, centers_.size(), [this, &mesh] (size_t t)
+            {
+               centers_[t] = circumcenter(mesh.triangle(t));
+            }, threads, 4096);
+
+            if (mesh.triangles_num() != 0)
+               return;
+
+            // the first of equal sites in sorted order, then their ranks
+            for (uint32_t v = 0; v != sites.size(); ++v)
+               line_.push_back(v);
+            std::sort(line_.begin(), line_.end(), [&sites] (uint32_t a, uint32_t b)
+            {
+               return sites[a] < sites[b] || (sites[a] == sites[b] && a < b);
+            });
+            line_.erase(std::unique(line_.begin(), line_.end(), [&sites] (uint32_t a, uint32_t b)
+            {
+               return sites[a] == sites[b];
+            }), line_.end());
+
+            ranks_.assign(sites.size(), no_twin);
+            for (uint32_t l = 0; l != line_.size(); ++l)
+               ranks_[line_[l]] = l;
+         }
+
+         // the cell of site v into res, tmp is a buffer
+         void cell(uint32_t v, std::vector<point_2> & res, std::vector<point_2> & tmp) const
+         {
+            res.clear();
+            if (mesh_.triangles_num() == 0)
+            {
+               uint32_t l = ranks_[v];
+               if (l == no_twin)
+                  return;
+               box_corners(res);
+               if (l != 0)
+                  cut(v, line_[l - 1], res, tmp);
+               if (l + 1 != line_.size())
+                  cut(v, line_[l + 1], res, tmp);
+               return;
+            }
+
+            uint32_t e = mesh_.out(v);
+            if (e == no_twin)
+               return;
+
+            if (mesh_.is_boundary(e))
+            {
+               box_corners(res);
+               for (uint32_t f = e; ; )
+               {
+                  cut(v, mesh_.target(f), res, tmp);
+                  uint32_t g = mesh_.turn_ccw(f);
+                  if (g == no_twin)
+                  {
+                     cut(v, mesh_.origin(half_edge_mesh::prev(f)), res, tmp);
+                     break;
+                  }
+                  f = g;
+               }
+               return;
+            }
+
+            bool inside = true;
+            uint32_t f = e;
+            do
+            {
+               point_2 const & p = centers_[f / 3];
+               if (res.empty() || res.back() != p)
+               {
+                  res.push_back(p);
+                  inside = inside && box_.contains(p);
+               }
+               f = mesh_.turn_ccw(f);
+            }
+            while (f != e);
+            if (res.size() > 1 && res.front() == res.back())
+               res.pop_back();
+
+            if (!inside)
+               clip_to_box(res, tmp);
+         }
+
+      private:
+         void box_corners(std::vector<point_2> & res) const
+         {
+            res.push_back(box_.corner(0, 0));
+            res.push_back(box_.corner(1, 0));
+            res.push_back(box_.corner(1, 1));
+            res.push_back(box_.corner(0, 1));
+         }
+
+         // keeps the side of the bisector of v and u closer to v
+         void cut(uint32_t v, uint32_t u, std::vector<point_2> & res, std::vector<point_2> & tmp) const
+         {
+            point_2 const & a = sites_[v], & b = sites_[u];
+            double mx = (a.x + b.x) / 2, my = (a.y + b.y) / 2, dx = b.x - a.x, dy = b.y - a.y;
+            clip_convex(res, tmp, [=] (point_2 const & p) { return (p.x - mx) * dx + (p.y - my) * dy; },
+                        [] (point_2 &) {});
+            res.swap(tmp);
+         }
+
+         void clip_to_box(std::vector<point_2> & res, std::vector<point_2> & tmp) const
+         {
+            range const & x = box_.x, & y = box_.y;
+            clip_convex(res, tmp, [&x] (point_2 const & p) { return x.inf - p.x; }, [&x] (point_2 & p) { p.x = x.inf; });
+            clip_convex(tmp, res, [&x] (point_2 const & p) { return p.x - x.sup; }, [&x] (point_2 & p) { p.x = x.sup; });
+            clip_convex(res, tmp, [&y] (point_2 const & p) { return y.inf - p.y; }, [&y] (point_2 & p) { p.y = y.inf; });
+            clip_convex(tmp, res, [&y] (point_2 const & p) { return p.y - y.sup; }, [&y] (point_2 & p) { p.y = y.sup; });
+         }
+
+         std::vector<point_2> const & sites_;
+         rectangle_2 box_;
+         half_edge_mesh mesh_;
+         std::vector<point_2> centers_;
+         std::vector<uint32_t> line_, ranks_;
+      };
+   }
+
+   // voronoi diagram of the sites clipped to box, as the dual of their
+   // delaunay triangulation. the triangulation, the circumcenters and the
+   // cells are built in parallel, the result is the same for any number
+   // of threads.
+   inline void voronoi(std::vector<point_2> const & sites, rectangle_2 const & box, voronoi_diagram & res, size_t threads = 0)
+   {
+      if (threads == 0)
+         threads = common::default_threads();
+
+      detail::voronoi_builder builder(sites, box, threads);
+
+      size_t n = sites.size();
+      threads = std::max<size_t>(1, std::min(threads, n / detail::voronoi_min_parallel));
+
+      // every thread builds a contiguous block of cells into its buffer,
+      // which is copied to its place once the sizes are known
+      res.clear();
+      res.offsets.assign(n + 1, 0);
+      std::vector<std::vector<point_2> > buffers(threads);
+      common::parallel_for(0, threads, [&] (size_t w)
+      {
+         std::vector<point_2> cell, tmp;
+         for (size_t k = w * n / threads; k != (w + 1) * n / threads; ++k)
+         {
+            builder.cell(uint32_t(k), cell, tmp);
+            buffers[w].insert(buffers[w].end(), cell.begin(), cell.end());
+            res.offsets[k + 1] = uint32_t(cell.size());
+         }
+      }, threads);
+
+      for (size_t k = 0; k != n; ++k)
+         res.offsets[k + 1] += res.offsets[k];
+
+      res.vertices.resize(res.offsets.back());
+      common::parallel_for(0, threads, [&] (size_t w)
+      {
+         std::copy(buffers[w].begin(), buffers[w].end(), res.vertices.begin() + res.offsets[w * n / threads]);
+      }, threads);
+   }
+
+   inline voronoi_diagram voronoi(std::vector<point_2> const & sites, rectangle_2 const & box)
+   {
+      voronoi_diagram res;
+      voronoi(sites, box, res);
+      return res;
+   }
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+#include <iterator>
+
+#include <cg/primitives/rectangle.h>
+#include <cg/primitives/segment.h>
+#include <cg/operations/clip/rectangle_segment.h>
+#include <cg/operations/has_intersection/rectangle_segment.h>
+
+#include "random_utils.h"
+
+namespace
+{
+   cg::point_2 at(cg::segment_2 const & s, double t)
+   {
+      return cg::point_2(s[0].x + t * (s[1].x - s[0].x), s[0].y + t * (s[1].y - s[0].y));
+   }
+
+   bool near_rectangle(cg::rectangle_2 const & r, cg::point_2 const & p)
+   {
+      double const eps = 1e-9;
+      return r.x.inf - eps <= p.x && p.x <= r.x.sup + eps
+          && r.y.inf - eps <= p.y && p.y <= r.y.sup + eps;
+   }
+
+   void check_clip(cg::rectangle_2 const & r, cg::segment_2 const & s)
+   {
+      cg::range res = cg::clip(r, s);
+
+      ASSERT_EQ(cg::has_intersection(r, s), !res.is_empty());
+      if (res.is_empty())
+         return;
+
+      EXPECT_LE(0, res.inf);
+      EXPECT_GE(1, res.sup);
+      EXPECT_TRUE(near_rectangle(r, at(s, res.inf)));
+      EXPECT_TRUE(near_rectangle(r, at(s, res.sup)));
+      EXPECT_TRUE(near_rectangle(r, at(s, (res.inf + res.sup) / 2)));
+
+      // the part before and after the range is outside
+      if (res.inf > 1e-6)
+      {
+         EXPECT_FALSE(r.contains(at(s, res.inf - 1e-6)));
+      }
+      if (res.sup < 1 - 1e-6)
+      {
+         EXPECT_FALSE(r.contains(at(s, res.sup + 1e-6)));
+      }
+   }
+}
+
+TEST(clip, rectangle_segment)
+{
+   using cg::point_2;
+   using cg::segment_2;
+   using cg::rectangle_2;
+   using cg::range;
+
+   rectangle_2 r(range(0, 4), range(0, 2));
+
+   range res = cg::clip(r, segment_2(point_2(-2, 1), point_2(6, 1)));
+   EXPECT_DOUBLE_EQ(.25, res.inf);
+   EXPECT_DOUBLE_EQ(.75, res.sup);
+
+   res = cg::clip(r, segment_2(point_2(1, 1), point_2(2, 1)));
+   EXPECT_EQ(0, res.inf);
+   EXPECT_EQ(1, res.sup);
+
+   EXPECT_TRUE(cg::clip(r, segment_2(point_2(5, 0), point_2(5, 2))).is_empty());
+   EXPECT_TRUE(cg::clip(r, segment_2(point_2(-1, 4), point_2(6, 2.5))).is_empty());
+
+   // touching a corner, running along a side, a point on a side
+   res = cg::clip(r, segment_2(point_2(3, 3), point_2(5, 1)));
+   ASSERT_FALSE(res.is_empty());
+   EXPECT_DOUBLE_EQ(.5, res.inf);
+   EXPECT_DOUBLE_EQ(.5, res.sup);
+
+   res = cg::clip(r, segment_2(point_2(-1, 2), point_2(5, 2)));
+   EXPECT_DOUBLE_EQ(1. / 6, res.inf);
+   EXPECT_DOUBLE_EQ(5. / 6, res.sup);
+
+   EXPECT_FALSE(cg::clip(r, segment_2(point_2(4, 1), point_2(4, 1))).is_empty());
+   EXPECT_TRUE(cg::clip(r, segment_2(point_2(4.5, 1), point_2(4.5, 1))).is_empty());
+
+   EXPECT_TRUE(cg::clip(rectangle_2(), segment_2(point_2(0, 0), point_2(1, 1))).is_empty());
+}
+
+TEST(clip, rectangle_segment_batch)
+{
+   using cg::point_2;
+   using cg::segment_2;
+   using cg::rectangle_2;
+   using cg::range;
+
+   std::vector<point_2> pts = uniform_points(4000);
+
+   std::vector<segment_2> segments;
+   for (size_t l = 0; l + 1 < pts.size(); l += 2)
+      segments.push_back(segment_2(pts[l], point_2(pts[l].x + pts[l + 1].x / 4, pts[l].y + pts[l + 1].y / 4)));
+
+   // lattice segments touch the lattice rectangles at corners and along sides
+   util::uniform_random_int<int, std::mt19937> rnd(-4, 4);
+   for (size_t l = 0; l != 2000; ++l)
+      segments.push_back(segment_2(point_2(rnd(), rnd()), point_2(rnd(), rnd())));
+
+   std::vector<rectangle_2> rects;
+   rects.push_back(rectangle_2(range(-20, 30), range(-50, 10)));
+   rects.push_back(rectangle_2(range(-2, 2), range(-1, 3)));
+   rects.push_back(rectangle_2(range(0, 0), range(-1, 1)));
+   rects.push_back(rectangle_2(range(1, 1), range(2, 2)));
+
+   for (size_t k = 0; k != rects.size(); ++k)
+   {
+      std::vector<range> res;
+      cg::clip(rects[k], segments.begin(), segments.end(), std::back_inserter(res));
+
+      std::vector<bool> hit;
+      cg::has_intersection(rects[k], segments.begin(), segments.end(), std::back_inserter(hit));
+
+      ASSERT_EQ(segments.size(), res.size());
+      ASSERT_EQ(segments.size(), hit.size());
+      for (size_t l = 0; l != segments.size(); ++l)
+      {
+         check_clip(rects[k], segments[l]);
+         EXPECT_EQ(!res[l].is_empty(), hit[l]);
+      }
+   }
+}
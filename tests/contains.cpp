@@ -7,6 +7,9 @@
 #include <cg/operations/contains/segment_point.h>
 #include <cg/operations/contains/triangle_point.h>
 #include <cg/operations/contains/contour_point.h>
+#include <cg/operations/contains/packed_contour_point.h>
+#include <cg/operations/contains/convex_locator.h>
+#include <cg/operations/contains/polygon_point.h>
 #include <cg/convex_hull/graham.h>
 
 TEST(contains, triangle_point)
@@ -392,3 +395,169 @@ TEST(contains, convex_ccw_point_uniform1)
       }
    }
 }
+
+namespace details
+{
+   // random star-shaped contour on the integer lattice, lots of degenerate configurations
+   cg::contour_2 lattice_star_contour(size_t cnt_vertices, int radius)
+   {
+      util::uniform_random_int<int, std::mt19937> rnd(1, radius);
+      std::vector<std::pair<double, cg::point_2> > pts;
+
+      for (size_t l = 0; l != cnt_vertices; ++l)
+      {
+         double angle = 2 * M_PI * l / cnt_vertices;
+         double r = rnd();
+         pts.push_back(std::make_pair(angle, cg::point_2(std::floor(r * cos(angle)), std::floor(r * sin(angle)))));
+      }
+
+      std::vector<cg::point_2> res;
+      for (size_t l = 0; l != pts.size(); ++l)
+         res.push_back(pts[l].second);
+
+      return cg::contour_2(res);
+   }
+}
+
+TEST(contains, packed_contour_point)
+{
+   using cg::point_2;
+
+   for (size_t cnt_vertices = 3; cnt_vertices < 300; cnt_vertices += 7)
+   {
+      cg::contour_2 cont = details::lattice_star_contour(cnt_vertices, 20);
+      cg::packed_contour_2 packed(cont);
+
+      for (int x = -22; x <= 22; ++x)
+         for (int y = -22; y <= 22; ++y)
+         {
+            point_2 q(x, y);
+            EXPECT_EQ(cg::contains(cont, q), cg::contains(packed, q));
+
+            point_2 h(x + .5, y);
+            EXPECT_EQ(cg::contains(cont, h), cg::contains(packed, h));
+         }
+
+      for (size_t l = 0; l != cont.size(); ++l)
+         EXPECT_TRUE(cg::contains(packed, cont[l]));
+   }
+}
+
+TEST(contains, packed_contour_point_batch)
+{
+   using cg::point_2;
+
+   cg::contour_2 cont = details::lattice_star_contour(500, 100);
+   cg::packed_contour_2 packed(cont);
+
+   std::vector<point_2> pts = uniform_points(10000);
+   std::vector<bool> res;
+   cg::contains(packed, pts.begin(), pts.end(), std::back_inserter(res));
+
+   ASSERT_EQ(res.size(), pts.size());
+   for (size_t l = 0; l != pts.size(); ++l)
+      EXPECT_EQ(cg::contains(cont, pts[l]), res[l]);
+
+   EXPECT_FALSE(cg::contains(cg::packed_contour_2(), point_2(0, 0)));
+}
+
+TEST(contains, convex_locator_lattice)
+{
+   using cg::point_2;
+   using cg::contour_2;
+
+   util::uniform_random_int<int, std::mt19937> rnd(-30, 30);
+
+   for (size_t cnt_points = 1; cnt_points < 200; cnt_points += 3)
+   {
+      std::vector<point_2> pts(cnt_points);
+      for (size_t l = 0; l != cnt_points; ++l)
+         pts[l] = point_2(rnd(), rnd());
+
+      auto it = cg::graham_hull(pts.begin(), pts.end());
+      pts.resize(std::distance(pts.begin(), it));
+
+      contour_2 cont(pts);
+      cg::convex_locator locator(cont);
+
+      for (int x = -32; x <= 32; ++x)
+         for (int y = -32; y <= 32; ++y)
+         {
+            point_2 q(x, y);
+            EXPECT_EQ(cg::convex_contains(cont, q), locator.contains(q));
+
+            point_2 h(x + .5, y - .5);
+            EXPECT_EQ(cg::convex_contains(cont, h), locator.contains(h));
+         }
+   }
+}
+
+TEST(contains, convex_locator_collinear)
+{
+   using cg::point_2;
+
+   std::vector<point_2> pts = boost::assign::list_of(point_2(0, 0))
+                                                    (point_2(2, 0))
+                                                    (point_2(4, 0))
+                                                    (point_2(4, 4))
+                                                    (point_2(2, 4))
+                                                    (point_2(-4, 4))
+                                                    (point_2(-4, 0))
+                                                    (point_2(-2, 0));
+
+   cg::contour_2 cont(pts);
+   for (size_t buckets = 1; buckets != 20; ++buckets)
+   {
+      cg::convex_locator locator(cont, buckets);
+      for (int x = -6; x <= 6; ++x)
+         for (int y = -2; y <= 6; ++y)
+            EXPECT_EQ(cg::convex_contains(cont, point_2(x, y)), locator.contains(point_2(x, y)));
+   }
+}
+
+TEST(contains, convex_locator_uniform)
+{
+   using cg::point_2;
+   using cg::contour_2;
+
+   for (size_t cnt_tests = 0; cnt_tests != 5; cnt_tests++)
+   {
+      std::vector<point_2> pts = uniform_points(100000);
+      std::vector<point_2> pts2 = uniform_points(100000);
+
+      auto it = cg::graham_hull(pts.begin(), pts.end());
+      pts.resize(std::distance(pts.begin(), it));
+
+      contour_2 cont(pts);
+      cg::convex_locator locator(cont);
+
+      for (size_t i = 0; i < cont.size(); i++)
+         EXPECT_TRUE(locator.contains(cont[i]));
+
+      for (size_t i = 0; i < pts2.size(); i++)
+         EXPECT_EQ(cg::convex_contains(cont, pts2[i]), locator.contains(pts2[i]));
+   }
+}
+
+TEST(contains, polygon_with_holes_point)
+{
+   using cg::point_2;
+
+   cg::contour_2 outer(boost::assign::list_of(point_2(-2, -2))(point_2(2, -2))(point_2(2, 2))(point_2(-2, 2)).convert_to_container<std::vector<point_2> >());
+   cg::contour_2 hole(boost::assign::list_of(point_2(1, 1))(point_2(1, -1))(point_2(-1, -1))(point_2(-1, 1)).convert_to_container<std::vector<point_2> >());
+
+   cg::polygon_with_holes_2 poly(outer, std::vector<cg::contour_2>(1, hole));
+
+   EXPECT_TRUE(cg::contains(poly, point_2(-1.5, 0)));
+   EXPECT_TRUE(cg::contains(poly, point_2(2, 0)));
+   EXPECT_TRUE(cg::contains(poly, point_2(-2, -2)));
+   EXPECT_TRUE(cg::contains(poly, point_2(1, 0)));
+   EXPECT_TRUE(cg::contains(poly, point_2(1, 1)));
+
+   EXPECT_FALSE(cg::contains(poly, point_2(0, 0)));
+   EXPECT_FALSE(cg::contains(poly, point_2(0.5, -0.5)));
+   EXPECT_FALSE(cg::contains(poly, point_2(3, 0)));
+
+   EXPECT_EQ(poly.contours_num(), 2u);
+   EXPECT_EQ(cg::polygon_with_holes_2(poly.contours()).holes.size(), 1u);
+}
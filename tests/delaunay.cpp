@@ -0,0 +1,473 @@
+#include <gtest/gtest.h>
+
+#include <cg/operations/in_circle.h>
+#include <cg/triangulation/delaunay.h>
+#include <cg/triangulation/delaunay_dc.h>
+#include <cg/triangulation/voronoi.h>
+#include <cg/triangulation/half_edge_mesh.h>
+#include <cg/operations/circumcenter.h>
+#include <cg/operations/contains/triangle_point.h>
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "random_utils.h"
+
+namespace
+{
+   // every finite triangle is ccw, every edge has its twin, no vertex lies
+   // inside the circumcircle of the triangle across an edge
+   void check_delaunay(cg::delaunay_triangulation const & dt)
+   {
+      uint32_t const inf = cg::detail::infinite_vertex;
+
+      for (uint32_t e = 0; e != dt.half_edges_num(); ++e)
+      {
+         uint32_t f = dt.twin(e);
+         ASSERT_EQ(e, dt.twin(f));
+         EXPECT_EQ(dt.origin(e), dt.origin(dt.next(f)));
+         EXPECT_EQ(dt.origin(f), dt.origin(dt.next(e)));
+
+         if (dt.is_ghost(e / 3))
+            continue;
+
+         cg::triangle_2 t = dt.triangle(e / 3);
+         EXPECT_EQ(cg::CG_LEFT, cg::orientation(t[0], t[1], t[2]));
+
+         uint32_t q = dt.origin(dt.prev(f));
+         if (q != inf)
+         {
+            EXPECT_NE(cg::CG_INSIDE, cg::in_circle(t[0], t[1], t[2], dt.point(q)));
+         }
+      }
+   }
+
+   // the same, except across constrained edges
+   void check_delaunay_constrained(cg::delaunay_triangulation const & dt)
+   {
+      uint32_t const inf = cg::detail::infinite_vertex;
+
+      for (uint32_t e = 0; e != dt.half_edges_num(); ++e)
+      {
+         uint32_t f = dt.twin(e);
+         ASSERT_EQ(e, dt.twin(f));
+         EXPECT_EQ(dt.constrained(e), dt.constrained(f));
+
+         if (dt.is_ghost(e / 3) || dt.constrained(e))
+            continue;
+
+         cg::triangle_2 t = dt.triangle(e / 3);
+         EXPECT_EQ(cg::CG_LEFT, cg::orientation(t[0], t[1], t[2]));
+
+         uint32_t q = dt.origin(dt.prev(f));
+         if (q != inf)
+         {
+            EXPECT_NE(cg::CG_INSIDE, cg::in_circle(t[0], t[1], t[2], dt.point(q)));
+         }
+      }
+   }
+
+   // points not on the hull and hull vertices give the triangle count
+   size_t hull_vertices(cg::delaunay_triangulation const & dt)
+   {
+      size_t res = 0;
+      for (uint32_t t = 0; t != dt.half_edges_num() / 3; ++t)
+         res += dt.is_ghost(t);
+      return res;
+   }
+
+   double area(cg::contour_2 const & c)
+   {
+      double res = 0;
+      for (size_t l = 0; l != c.size(); ++l)
+      {
+         cg::point_2 const & a = c[l], & b = c[(l + 1) % c.size()];
+         res += a.x * b.y - a.y * b.x;
+      }
+      return res / 2;
+   }
+
+   // cells are convex and ccw, tile the box, and a point of the box well
+   // closer to one site than to any other is in the cell of that site
+   void check_voronoi(std::vector<cg::point_2> const & sites, cg::rectangle_2 const & box, cg::voronoi_diagram const & vd)
+   {
+      ASSERT_EQ(sites.size(), vd.cells_num());
+
+      double total = 0;
+      for (size_t k = 0; k != vd.cells_num(); ++k)
+      {
+         cg::contour_2 c = vd.cell(k);
+         for (size_t l = 0; l != c.size(); ++l)
+         {
+            EXPECT_TRUE(box.contains(c[l]));
+            EXPECT_NE(cg::CG_RIGHT, cg::orientation(c[l], c[(l + 1) % c.size()], c[(l + 2) % c.size()]));
+         }
+         EXPECT_TRUE(c.size() == 0 || c.size() >= 3);
+         total += area(c);
+      }
+      double box_area = (box.x.sup - box.x.inf) * (box.y.sup - box.y.inf);
+      EXPECT_NEAR(box_area, total, 1e-9 * box_area);
+
+      std::vector<cg::point_2> probes = uniform_points(500);
+      for (size_t l = 0; l != probes.size(); ++l)
+      {
+         cg::point_2 p(box.x.inf + (probes[l].x + 100) / 200 * (box.x.sup - box.x.inf),
+                       box.y.inf + (probes[l].y + 100) / 200 * (box.y.sup - box.y.inf));
+         std::vector<std::pair<double, size_t> > dist;
+         for (size_t k = 0; k != sites.size(); ++k)
+            dist.push_back(std::make_pair((sites[k].x - p.x) * (sites[k].x - p.x) + (sites[k].y - p.y) * (sites[k].y - p.y), k));
+         std::sort(dist.begin(), dist.end());
+         if (dist.size() > 1 && dist[1].first < dist[0].first * (1 + 1e-6) + 1e-9)
+            continue;
+
+         cg::contour_2 c = vd.cell(dist[0].second);
+         ASSERT_LE(3u, c.size());
+         for (size_t i = 0; i != c.size(); ++i)
+            EXPECT_NE(cg::CG_RIGHT, cg::orientation(c[i], c[(i + 1) % c.size()], p));
+      }
+   }
+
+   // triangles of a mesh, each rotated to start at its smallest index
+   std::vector<std::array<uint32_t, 3> > normalized(cg::indexed_mesh const & mesh)
+   {
+      std::vector<std::array<uint32_t, 3> > res;
+      for (size_t t = 0; t != mesh.triangles_num(); ++t)
+      {
+         uint32_t const * i = &mesh.indices[3 * t];
+         size_t k = std::min_element(i, i + 3) - i;
+         std::array<uint32_t, 3> tri = {{ i[k], i[(k + 1) % 3], i[(k + 2) % 3] }};
+         res.push_back(tri);
+      }
+
+      std::sort(res.begin(), res.end());
+      return res;
+   }
+}
+
+TEST(delaunay, in_circle)
+{
+   using cg::point_2;
+
+   point_2 a(5, 0), b(0, 5), c(-5, 0);
+
+   EXPECT_EQ(cg::CG_COCIRCULAR, cg::in_circle(a, b, c, point_2(3, -4)));
+   EXPECT_EQ(cg::CG_COCIRCULAR, cg::in_circle(a, b, c, point_2(-4, 3)));
+   EXPECT_EQ(cg::CG_INSIDE,     cg::in_circle(a, b, c, point_2(0, 0)));
+   EXPECT_EQ(cg::CG_OUTSIDE,    cg::in_circle(a, b, c, point_2(4, 4)));
+
+   // near the circle the filters must agree with the exact answer
+   double const eps = std::numeric_limits<double>::epsilon();
+   std::vector<point_2> pts = uniform_points(300);
+   for (size_t l = 0; l != pts.size(); ++l)
+   {
+      point_2 d(3 * (1 + (pts[l].x / 100) * eps), -4 * (1 + (pts[l].y / 100) * eps));
+      EXPECT_EQ(*cg::in_circle_r()(a, b, c, d), cg::in_circle(a, b, c, d));
+   }
+}
+
+TEST(delaunay, uniform)
+{
+   std::vector<cg::point_2> pts = uniform_points(5000);
+   cg::delaunay_triangulation dt(pts);
+
+   check_delaunay(dt);
+   EXPECT_EQ(2 * pts.size() - 2 - hull_vertices(dt), dt.triangles_num());
+
+   std::vector<cg::triangle_2> t;
+   dt.triangles(std::back_inserter(t));
+   EXPECT_EQ(dt.triangles_num(), t.size());
+
+   cg::indexed_mesh mesh;
+   dt.mesh(mesh);
+   EXPECT_EQ(pts, mesh.vertices);
+   ASSERT_EQ(t.size(), mesh.triangles_num());
+   for (size_t l = 0; l != t.size(); ++l)
+      EXPECT_EQ(t[l], mesh.triangle(l));
+}
+
+TEST(delaunay, empty_circles)
+{
+   std::vector<cg::point_2> pts = uniform_points(200);
+   cg::delaunay_triangulation dt(pts);
+
+   std::vector<cg::triangle_2> t;
+   dt.triangles(std::back_inserter(t));
+   for (size_t l = 0; l != t.size(); ++l)
+      for (size_t k = 0; k != pts.size(); ++k)
+         EXPECT_NE(cg::CG_INSIDE, cg::in_circle(t[l][0], t[l][1], t[l][2], pts[k]));
+}
+
+TEST(delaunay, grid)
+{
+   // cocircular and collinear everywhere, with duplicates
+   std::vector<cg::point_2> pts;
+   for (int k = 0; k != 2; ++k)
+      for (int i = 0; i != 30; ++i)
+         for (int j = 0; j != 30; ++j)
+            pts.push_back(cg::point_2(i, j));
+
+   cg::delaunay_triangulation dt(pts);
+   check_delaunay(dt);
+   EXPECT_EQ(2u * 29 * 29, dt.triangles_num());
+   EXPECT_EQ(4u * 29, hull_vertices(dt));
+}
+
+TEST(delaunay, incremental)
+{
+   using cg::point_2;
+
+   cg::delaunay_triangulation dt;
+   EXPECT_EQ(0u, dt.triangles_num());
+   EXPECT_FALSE(dt.locate(point_2(0, 0)));
+
+   // collinear points wait for the first triangle, repeats of any of them
+   // are rejected
+   for (int l = 0; l != 10; ++l)
+      EXPECT_EQ(l < 5, dt.insert(point_2(l % 5, 0)));
+   EXPECT_EQ(0u, dt.triangles_num());
+
+   dt.insert(point_2(2, 3));
+   check_delaunay(dt);
+   EXPECT_EQ(4u, dt.triangles_num());
+
+   std::vector<point_2> pts = uniform_points(1000);
+   for (size_t l = 0; l != pts.size(); ++l)
+      dt.insert(pts[l]);
+
+   check_delaunay(dt);
+   EXPECT_EQ(2 * (pts.size() + 6) - 2 - hull_vertices(dt), dt.triangles_num());
+
+   for (size_t l = 0; l != pts.size(); ++l)
+   {
+      boost::optional<uint32_t> t = dt.locate(pts[l]);
+      ASSERT_TRUE(t);
+      EXPECT_TRUE(cg::contains(dt.triangle(*t), pts[l]));
+   }
+
+   EXPECT_FALSE(dt.locate(point_2(1000, 1000)));
+}
+
+TEST(delaunay, divide_conquer)
+{
+   // points in general position have a unique delaunay triangulation
+   std::vector<cg::point_2> pts = uniform_points(40000);
+
+   cg::indexed_mesh expected;
+   cg::delaunay_triangulation(pts).mesh(expected);
+
+   for (size_t threads = 1; threads <= 4; threads *= 2)
+   {
+      cg::indexed_mesh mesh;
+      cg::delaunay_mesh(pts, mesh, threads);
+
+      EXPECT_EQ(pts, mesh.vertices);
+      EXPECT_TRUE(normalized(expected) == normalized(mesh));
+
+      // the twins from the quad-edges are the matched ones
+      cg::indexed_mesh same;
+      std::vector<uint32_t> twins;
+      cg::delaunay_mesh(pts, same, twins, threads);
+      EXPECT_EQ(mesh.indices, same.indices);
+      cg::half_edge_mesh matched(same);
+      ASSERT_EQ(matched.half_edges_num(), twins.size());
+      for (uint32_t e = 0; e != twins.size(); ++e)
+         EXPECT_EQ(matched.twin(e), twins[e]);
+   }
+}
+
+TEST(delaunay, divide_conquer_degenerate)
+{
+   using cg::point_2;
+
+   cg::indexed_mesh mesh;
+   for (size_t n = 0; n != 4; ++n)
+   {
+      std::vector<point_2> pts;
+      for (size_t l = 0; l != n; ++l)
+         pts.push_back(point_2(l, l * l % 3));
+
+      cg::delaunay_mesh(pts, mesh, 1);
+      EXPECT_EQ(n == 3 ? 1u : 0u, mesh.triangles_num());
+   }
+
+   std::vector<point_2> line;
+   for (int l = 0; l != 100; ++l)
+      line.push_back(point_2(l % 10, 2 * (l % 10)));
+   cg::delaunay_mesh(line, mesh, 1);
+   EXPECT_EQ(0u, mesh.triangles_num());
+
+   std::vector<point_2> grid;
+   for (int k = 0; k != 2; ++k)
+      for (int i = 0; i != 30; ++i)
+         for (int j = 0; j != 30; ++j)
+            grid.push_back(point_2(j, i));
+
+   cg::delaunay_mesh(grid, mesh, 1);
+   ASSERT_EQ(2u * 29 * 29, mesh.triangles_num());
+   for (size_t t = 0; t != mesh.triangles_num(); ++t)
+   {
+      cg::triangle_2 tr = mesh.triangle(t);
+      EXPECT_EQ(cg::CG_LEFT, cg::orientation(tr[0], tr[1], tr[2]));
+      EXPECT_GT(900u, *std::max_element(&mesh.indices[3 * t], &mesh.indices[3 * t] + 3));
+      for (size_t l = 0; l != 900; ++l)
+         EXPECT_NE(cg::CG_INSIDE, cg::in_circle(tr[0], tr[1], tr[2], grid[l]));
+   }
+}
+
+TEST(delaunay, constraints)
+{
+   using cg::point_2;
+
+   std::vector<point_2> pts = uniform_points(2000);
+   pts.push_back(point_2(-50, -40));
+   pts.push_back(point_2(60, 30));
+   pts.push_back(point_2(-50, 30));
+   size_t n = pts.size();
+
+   // crossing many edges, then through a vertex put on it
+   cg::delaunay_triangulation dt(pts);
+   dt.insert_constraint(n - 3, n - 2);
+   dt.insert(point_2(5, -5));
+   dt.insert_constraint(n - 3, n - 1);
+   dt.insert_constraint(n - 1, n);
+
+   // later points on and near the constraints
+   for (int l = 1; l != 10; ++l)
+   {
+      dt.insert(point_2(-50 + 11 * l, -40 + 7 * l));
+      dt.insert(point_2(-50 + 11 * l, -39 + 7 * l));
+   }
+
+   check_delaunay_constrained(dt);
+
+   // the segments are unions of constrained edges
+   point_2 const ends[][2] = {{pts[n - 3], pts[n - 2]}, {pts[n - 3], pts[n - 1]}};
+   for (size_t k = 0; k != 2; ++k)
+   {
+      double length = 0;
+      for (uint32_t e = 0; e != dt.half_edges_num(); ++e)
+      {
+         if (!dt.constrained(e) || dt.origin(e) > dt.origin(dt.next(e)))
+            continue;
+
+         point_2 a = dt.point(dt.origin(e)), b = dt.point(dt.origin(dt.next(e)));
+         if (cg::orientation(ends[k][0], ends[k][1], a) == cg::CG_COLLINEAR
+          && cg::orientation(ends[k][0], ends[k][1], b) == cg::CG_COLLINEAR)
+            length += std::sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+      }
+
+      point_2 a = ends[k][0], b = ends[k][1];
+      EXPECT_NEAR(std::sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y)), length, 1e-9);
+   }
+}
+
+TEST(delaunay, circumcenter)
+{
+   using cg::point_2;
+
+   EXPECT_EQ(point_2(0, 0), cg::circumcenter(point_2(5, 0), point_2(0, 5), point_2(-5, 0)));
+   EXPECT_EQ(point_2(1.5, 2), cg::circumcenter(cg::triangle_2(point_2(0, 0), point_2(3, 0), point_2(0, 4))));
+
+   // nearly collinear points go through the exact fallback, within an ulp
+   double const eps = std::numeric_limits<double>::epsilon();
+   point_2 c = cg::circumcenter(point_2(0, 0), point_2(1, eps), point_2(2, 0));
+   EXPECT_EQ(1., c.x);
+   EXPECT_NEAR(-1 / (2 * eps), c.y, 1 / (2 * eps) * 4 * eps);
+
+   // centers near the origin are held to the size of the input
+   std::vector<point_2> pts = uniform_points(3000);
+   for (size_t l = 0; l + 2 < pts.size(); l += 3)
+   {
+      point_2 t[3];
+      double s = 0;
+      for (size_t k = 0; k != 3; ++k)
+      {
+         t[k] = point_2(pts[l + k].x / 100, pts[l + k].y / 100);
+         s = std::max({s, std::fabs(t[k].x), std::fabs(t[k].y)});
+      }
+      if (cg::orientation(t[0], t[1], t[2]) == cg::CG_COLLINEAR)
+         continue;
+
+      mpq_class bx = mpq_class(t[1].x) - t[0].x, by = mpq_class(t[1].y) - t[0].y;
+      mpq_class cx = mpq_class(t[2].x) - t[0].x, cy = mpq_class(t[2].y) - t[0].y;
+      mpq_class den = 2 * (bx * cy - by * cx), b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+      mpq_class x = t[0].x + (cy * b2 - by * c2) / den, y = t[0].y + (bx * c2 - cx * b2) / den;
+
+      point_2 c = cg::circumcenter(t[0], t[1], t[2]);
+      EXPECT_LE(std::fabs(c.x - x.get_d()), 64 * eps * std::max(s, std::fabs(c.x)));
+      EXPECT_LE(std::fabs(c.y - y.get_d()), 64 * eps * std::max(s, std::fabs(c.y)));
+   }
+}
+
+TEST(delaunay, voronoi)
+{
+   using cg::point_2;
+   cg::rectangle_2 box(cg::range(-100, 100), cg::range(-100, 100));
+
+   std::vector<point_2> sites = uniform_points(3000);
+   cg::voronoi_diagram expected;
+   cg::voronoi(sites, box, expected, 1);
+   check_voronoi(sites, box, expected);
+
+   for (size_t threads = 2; threads <= 4; threads *= 2)
+   {
+      cg::voronoi_diagram vd;
+      cg::voronoi(sites, box, vd, threads);
+      EXPECT_EQ(expected.vertices, vd.vertices);
+      EXPECT_EQ(expected.offsets, vd.offsets);
+   }
+
+   // sites outside the box, the box within one cell
+   std::vector<point_2> far = {point_2(-1000, 0), point_2(1000, 50), point_2(0, 1000), point_2(0, 0)};
+   check_voronoi(far, box, cg::voronoi(far, box));
+   cg::rectangle_2 small(cg::range(-1, 1), cg::range(-1, 1));
+   cg::voronoi_diagram vd = cg::voronoi(far, small);
+   check_voronoi(far, small, vd);
+   EXPECT_EQ(4u, vd.cell(3).size());
+}
+
+TEST(delaunay, voronoi_degenerate)
+{
+   using cg::point_2;
+   cg::rectangle_2 box(cg::range(-5, 35), cg::range(-5, 65));
+
+   // cocircular everywhere, duplicates get empty cells
+   std::vector<point_2> grid;
+   for (int k = 0; k != 2; ++k)
+      for (int i = 0; i != 30; ++i)
+         for (int j = 0; j != 30; ++j)
+            grid.push_back(point_2(i, 2 * j));
+
+   cg::voronoi_diagram vd = cg::voronoi(grid, box);
+   check_voronoi(grid, box, vd);
+   for (size_t k = 0; k != 900; ++k)
+   {
+      EXPECT_EQ(0u, vd.cell(900 + k).size());
+      if (grid[k].x != 0 && grid[k].x != 29 && grid[k].y != 0 && grid[k].y != 58)
+      {
+         cg::contour_2 c = vd.cell(k);
+         ASSERT_EQ(4u, c.size());
+         EXPECT_EQ(2., area(c));
+      }
+   }
+
+   // no triangles: strips between the sites along a line, and a single site
+   std::vector<point_2> line;
+   for (int l = 0; l != 20; ++l)
+      line.push_back(point_2(l % 10, 3 * (l % 10)));
+   vd = cg::voronoi(line, box);
+   check_voronoi(line, box, vd);
+   for (size_t k = 10; k != 20; ++k)
+      EXPECT_EQ(0u, vd.cell(k).size());
+
+   std::vector<point_2> one(1, point_2(3, 4));
+   vd = cg::voronoi(one, box);
+   check_voronoi(one, box, vd);
+   EXPECT_EQ(4u, vd.vertices.size());
+
+   vd = cg::voronoi(std::vector<point_2>(), box);
+   EXPECT_EQ(0u, vd.cells_num());
+}
@@ -3,6 +3,14 @@
 #include <cg/operations/has_intersection/segment_segment.h>
 #include <cg/operations/has_intersection/triangle_segment.h>
 #include <cg/operations/has_intersection/rectangle_segment.h>
+#include <cg/operations/has_intersection/rectangle_rectangle.h>
+#include <cg/operations/has_intersection/rectangle_triangle.h>
+#include <cg/operations/has_intersection/batch.h>
+
+#include <vector>
+#include <iterator>
+
+#include "random_utils.h"
 
 TEST(has_intersection, segment_segment)
 {
@@ -85,3 +93,109 @@ TEST(has_intersection, rectangle_segment)
    EXPECT_TRUE(cg::has_intersection(rectangle_2(a, b), segment_2(point_2(-1, -1), point_2(3, 3))));
    EXPECT_TRUE(cg::has_intersection(rectangle_2(a, b), segment_2(point_2(1, -1), point_2(1, 3))));
 }
+
+TEST(has_intersection, rectangle_rectangle)
+{
+   using cg::rectangle_2;
+   using cg::range;
+
+   rectangle_2 r(range(0, 2), range(0, 2));
+
+   EXPECT_TRUE(cg::has_intersection(r, rectangle_2(range(1, 3), range(1, 3))));
+   EXPECT_TRUE(cg::has_intersection(r, rectangle_2(range(2, 3), range(2, 3))));
+   EXPECT_TRUE(cg::has_intersection(r, rectangle_2(range(.5, 1), range(-1, 5))));
+   EXPECT_FALSE(cg::has_intersection(r, rectangle_2(range(2.5, 3), range(0, 2))));
+   EXPECT_FALSE(cg::has_intersection(r, rectangle_2()));
+}
+
+TEST(has_intersection, rectangle_triangle)
+{
+   using cg::point_2;
+   using cg::triangle_2;
+   using cg::rectangle_2;
+   using cg::range;
+
+   rectangle_2 r(range(0, 2), range(0, 2));
+
+   // vertex inside, side across, rectangle inside the triangle, touching a corner
+   EXPECT_TRUE(cg::has_intersection(r, triangle_2(point_2(1, 1), point_2(5, 1), point_2(5, 5))));
+   EXPECT_TRUE(cg::has_intersection(r, triangle_2(point_2(-1, 1), point_2(3, 1), point_2(1, 5))));
+   EXPECT_TRUE(cg::has_intersection(r, triangle_2(point_2(-10, -10), point_2(10, -10), point_2(0, 10))));
+   EXPECT_TRUE(cg::has_intersection(r, triangle_2(point_2(2, 2), point_2(3, 2), point_2(3, 3))));
+
+   // apart with overlapping boxes, degenerate triangle
+   EXPECT_FALSE(cg::has_intersection(r, triangle_2(point_2(1.5, 3), point_2(3, 1.5), point_2(3, 3))));
+   EXPECT_TRUE(cg::has_intersection(r, triangle_2(point_2(-1, 1), point_2(0, 1), point_2(1, 1))));
+   EXPECT_FALSE(cg::has_intersection(rectangle_2(), triangle_2(point_2(0, 0), point_2(1, 0), point_2(0, 1))));
+}
+
+TEST(has_intersection, batch)
+{
+   using cg::point_2;
+   using cg::segment_2;
+   using cg::triangle_2;
+   using cg::rectangle_2;
+   using cg::range;
+
+   std::vector<point_2> pts = uniform_points(3000);
+
+   // short items so that most boxes are disjoint, plus degenerate ones on a lattice
+   std::vector<segment_2> segments;
+   std::vector<triangle_2> triangles;
+   std::vector<rectangle_2> rectangles;
+   for (size_t l = 0; l + 2 < pts.size(); l += 3)
+   {
+      point_2 a = pts[l];
+      point_2 b(a.x + pts[l + 1].x / 10, a.y + pts[l + 1].y / 10);
+      point_2 c(a.x + pts[l + 2].x / 10, a.y + pts[l + 2].y / 10);
+
+      segments.push_back(segment_2(a, b));
+      triangles.push_back(triangle_2(a, b, c));
+      rectangles.push_back(rectangle_2(range(std::min(a.x, b.x), std::max(a.x, b.x)), range(std::min(a.y, c.y), std::max(a.y, c.y))));
+   }
+
+   for (int l = -3; l <= 3; ++l)
+   {
+      segments.push_back(segment_2(point_2(l, 0), point_2(l, 0)));
+      triangles.push_back(triangle_2(point_2(l, 0), point_2(l + 1, 0), point_2(l + 2, 0)));
+      rectangles.push_back(rectangle_2(range(l, l), range(0, 1)));
+   }
+
+   std::vector<segment_2> queries(segments.begin(), segments.begin() + 100);
+   queries.push_back(segment_2(point_2(-3, 0), point_2(3, 0)));
+   queries.push_back(segment_2(point_2(0, -100), point_2(0, 100)));
+
+   for (size_t q = 0; q != queries.size(); ++q)
+   {
+      std::vector<bool> res;
+      std::vector<size_t> idx, expected;
+
+      cg::has_intersection(queries[q], segments.begin(), segments.end(), std::back_inserter(res));
+      cg::intersecting(queries[q], segments.begin(), segments.end(), std::back_inserter(idx));
+      ASSERT_EQ(segments.size(), res.size());
+      for (size_t l = 0; l != segments.size(); ++l)
+      {
+         EXPECT_EQ(cg::has_intersection(segments[l], queries[q]), res[l]);
+         if (res[l])
+            expected.push_back(l);
+      }
+      EXPECT_EQ(expected, idx);
+
+      res.clear();
+      cg::has_intersection(queries[q], triangles.begin(), triangles.end(), std::back_inserter(res));
+      ASSERT_EQ(triangles.size(), res.size());
+      for (size_t l = 0; l != triangles.size(); ++l)
+         EXPECT_EQ(cg::has_intersection(triangles[l], queries[q]), res[l]);
+
+      res.clear();
+      cg::has_intersection(queries[q], rectangles.begin(), rectangles.end(), std::back_inserter(res));
+      ASSERT_EQ(rectangles.size(), res.size());
+      for (size_t l = 0; l != rectangles.size(); ++l)
+         EXPECT_EQ(cg::has_intersection(rectangles[l], queries[q]), res[l]);
+   }
+
+   // the box rejection must not change exact answers for touching items
+   EXPECT_TRUE(cg::has_intersection(segment_2(point_2(0, 0), point_2(1, 0)), segment_2(point_2(1, 0), point_2(2, 5))));
+   EXPECT_TRUE(cg::has_intersection(triangle_2(point_2(0, 0), point_2(1, 0), point_2(0, 1)), segment_2(point_2(1, 0), point_2(1, 5))));
+   EXPECT_FALSE(cg::has_intersection(rectangle_2(), segment_2(point_2(0, 0), point_2(-1, -1))));
+}
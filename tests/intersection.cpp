@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+#include <cg/primitives/segment.h>
+#include <cg/primitives/lazy_point.h>
+#include <cg/operations/orientation.h>
+#include <cg/operations/intersection/segment_segment.h>
+
+#include "random_utils.h"
+
+namespace
+{
+   bool within_ulp(double approx, mpq_class const & exact)
+   {
+      double const inf = std::numeric_limits<double>::infinity();
+      return mpq_class(std::nextafter(approx, -inf)) < exact && exact < mpq_class(std::nextafter(approx, inf));
+   }
+}
+
+TEST(intersection, segment_segment)
+{
+   using cg::point_2;
+   using cg::segment_2;
+
+   segment_2 a(point_2(0, 0), point_2(2, 2));
+
+   auto res = cg::intersection(a, segment_2(point_2(0, 2), point_2(2, 0)));
+   ASSERT_TRUE(res);
+   EXPECT_EQ(point_2(1, 1), boost::get<point_2>(*res));
+
+   // touching at an endpoint, an endpoint inside the other segment
+   res = cg::intersection(a, segment_2(point_2(2, 2), point_2(3, 0)));
+   ASSERT_TRUE(res);
+   EXPECT_EQ(point_2(2, 2), boost::get<point_2>(*res));
+
+   res = cg::intersection(a, segment_2(point_2(1, 1), point_2(1, -5)));
+   ASSERT_TRUE(res);
+   EXPECT_EQ(point_2(1, 1), boost::get<point_2>(*res));
+
+   // collinear overlap, collinear touching, collinear apart
+   res = cg::intersection(a, segment_2(point_2(3, 3), point_2(1, 1)));
+   ASSERT_TRUE(res);
+   EXPECT_EQ(segment_2(point_2(1, 1), point_2(2, 2)), boost::get<segment_2>(*res));
+
+   res = cg::intersection(a, segment_2(point_2(3, 3), point_2(2, 2)));
+   ASSERT_TRUE(res);
+   EXPECT_EQ(point_2(2, 2), boost::get<point_2>(*res));
+
+   EXPECT_FALSE(cg::intersection(a, segment_2(point_2(3, 3), point_2(4, 4))));
+   EXPECT_FALSE(cg::intersection(a, segment_2(point_2(0, 1), point_2(1, 2))));
+
+   // degenerate segments
+   res = cg::intersection(segment_2(point_2(.5, .5), point_2(.5, .5)), a);
+   ASSERT_TRUE(res);
+   EXPECT_EQ(point_2(.5, .5), boost::get<point_2>(*res));
+}
+
+TEST(intersection, segment_segment_rounding)
+{
+   using cg::point_2;
+   using cg::segment_2;
+
+   std::vector<point_2> pts = uniform_points(4000);
+   for (size_t l = 0; l + 3 < pts.size(); l += 4)
+   {
+      segment_2 a(pts[l], pts[l + 1]), b(pts[l + 2], pts[l + 3]);
+
+      // nearly parallel twin of a through pts[l + 2]
+      segment_2 c(pts[l + 2], point_2(pts[l + 2].x + (pts[l + 1].x - pts[l].x) * 3, pts[l + 2].y + (pts[l + 1].y - pts[l].y) * 3 + 1e-9));
+
+      for (segment_2 const & s : { b, c })
+      {
+         auto res = cg::lazy_intersection(a, s);
+         ASSERT_EQ(cg::has_intersection(a, s), bool(res));
+         if (!res)
+            continue;
+
+         cg::lazy_point_2 const * p = boost::get<cg::lazy_point_2>(&*res);
+         ASSERT_TRUE(p);
+
+         // the lazy point lies exactly on both segments
+         EXPECT_EQ(cg::CG_COLLINEAR, cg::orientation(a[0], a[1], *p));
+         EXPECT_EQ(cg::CG_COLLINEAR, cg::orientation(s[0], s[1], *p));
+         EXPECT_EQ(cg::CG_COLLINEAR, cg::orientation(s[1], s[0], cg::lazy_point_2(*p)));
+
+         EXPECT_TRUE(p->box.contains(p->approx));
+
+         point_2 q = boost::get<point_2>(*cg::intersection(a, s));
+         EXPECT_EQ(p->rounded(), q);
+         EXPECT_TRUE(q.x == p->exact().first || within_ulp(q.x, p->exact().first));
+         EXPECT_TRUE(q.y == p->exact().second || within_ulp(q.y, p->exact().second));
+
+         // order of lazy points agrees with the order of input points
+         cg::lazy_point_2 e0(a[0]), e1(a[1]);
+         EXPECT_EQ(a[0] < a[1], e0 < e1);
+         EXPECT_TRUE(std::min(e0, e1) < *p && *p < std::max(e0, e1));
+         EXPECT_TRUE(*p == cg::lazy_point_2(s, a));
+      }
+   }
+}
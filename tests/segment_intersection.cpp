@@ -0,0 +1,273 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+#include <cg/primitives/segment.h>
+#include <cg/operations/has_intersection/segment_segment.h>
+#include <cg/segment_intersection/bentley_ottmann.h>
+#include <cg/segment_intersection/shamos_hoey.h>
+
+#include "random_utils.h"
+
+namespace
+{
+   typedef std::vector<std::pair<size_t, size_t> > pairs_t;
+
+   pairs_t naive_intersect_all(std::vector<cg::segment_2> const & s)
+   {
+      pairs_t res;
+      for (size_t i = 0; i != s.size(); ++i)
+         for (size_t j = i + 1; j != s.size(); ++j)
+            if (cg::has_intersection(s[i], s[j]))
+               res.push_back(std::make_pair(i, j));
+
+      return res;
+   }
+
+   void check_intersect_all(std::vector<cg::segment_2> const & s)
+   {
+      pairs_t res;
+      cg::intersect_all(s, std::back_inserter(res));
+
+      size_t reported = res.size();
+      std::sort(res.begin(), res.end());
+      res.erase(std::unique(res.begin(), res.end()), res.end());
+
+      EXPECT_EQ(res.size(), reported);
+      EXPECT_EQ(naive_intersect_all(s), res);
+   }
+
+   std::vector<cg::segment_2> lattice_segments(size_t count, int size)
+   {
+      util::uniform_random_int<int, std::mt19937> rnd(0, size);
+
+      std::vector<cg::segment_2> res;
+      for (size_t l = 0; l != count; ++l)
+         res.push_back(cg::segment_2(cg::point_2(rnd(), rnd()), cg::point_2(rnd(), rnd())));
+
+      return res;
+   }
+
+   cg::segment_2 edge(cg::contour_2 const & c, size_t l)
+   {
+      return cg::segment_2(c[l], c[(l + 1) % c.size()]);
+   }
+
+   bool naive_edges_touch(cg::contour_2 const & c, size_t i, size_t j)
+   {
+      size_t n = c.size();
+      cg::segment_2 a = edge(c, i), b = edge(c, j);
+
+      if ((i + 1) % n != j && (j + 1) % n != i)
+         return cg::has_intersection(a, b);
+
+      if ((j + 1) % n == i)
+         std::swap(a, b);
+
+      // neighbours: a ends where b starts
+      if (a[0] == a[1] || b[0] == b[1])
+         return true;
+
+      return cg::orientation(a[0], a[1], b[1]) == cg::CG_COLLINEAR
+          && !cg::collinear_are_ordered_along_line(a[0], a[1], b[1]);
+   }
+
+   bool naive_is_simple(cg::contour_2 const & c)
+   {
+      for (size_t i = 0; i != c.size(); ++i)
+         for (size_t j = i + 1; j != c.size(); ++j)
+            if (naive_edges_touch(c, i, j))
+               return false;
+
+      return c.size() >= 3;
+   }
+
+   void check_is_simple(cg::contour_2 const & c)
+   {
+      boost::optional<std::pair<size_t, size_t> > res = cg::find_self_intersection(c);
+
+      EXPECT_EQ(naive_is_simple(c), cg::is_simple(c));
+      if (res)
+      {
+         EXPECT_TRUE(naive_edges_touch(c, res->first, res->second));
+      }
+   }
+
+   cg::contour_2 contour(std::vector<cg::point_2> const & pts)
+   {
+      return cg::contour_2(pts);
+   }
+
+   // star shaped around the origin, simple for any distinct angles
+   cg::contour_2 star(size_t n, double r0, double r1, bool ccw = true)
+   {
+      std::vector<cg::point_2> pts;
+      for (size_t l = 0; l != n; ++l)
+      {
+         double a = (ccw ? 2 : -2) * M_PI * l / n;
+         double r = (l % 2) ? r0 : r1;
+         pts.push_back(cg::point_2(r * cos(a), r * sin(a)));
+      }
+
+      return cg::contour_2(pts);
+   }
+}
+
+TEST(segment_intersection, bentley_ottmann_simple)
+{
+   using cg::point_2;
+   using cg::segment_2;
+
+   std::vector<segment_2> s;
+   s.push_back(segment_2(point_2(0, 0), point_2(2, 2)));
+   s.push_back(segment_2(point_2(0, 2), point_2(2, 0)));
+   s.push_back(segment_2(point_2(1, -1), point_2(1, 3)));
+   s.push_back(segment_2(point_2(3, 3), point_2(4, 4)));
+   s.push_back(segment_2(point_2(2, 2), point_2(3, 3)));
+   s.push_back(segment_2(point_2(1, 1), point_2(1, 1)));
+   s.push_back(segment_2(point_2(0.5, 0.5), point_2(1.5, 1.5)));
+   s.push_back(segment_2(point_2(5, 0), point_2(6, 0)));
+
+   check_intersect_all(s);
+
+   pairs_t res;
+   cg::intersect_all(std::vector<segment_2>(), std::back_inserter(res));
+   EXPECT_TRUE(res.empty());
+}
+
+TEST(segment_intersection, bentley_ottmann_lattice)
+{
+   for (size_t cnt = 2; cnt < 200; cnt += 13)
+      for (int size = 2; size < 40; size *= 3)
+         check_intersect_all(lattice_segments(cnt, size));
+}
+
+TEST(segment_intersection, bentley_ottmann_uniform)
+{
+   for (size_t cnt = 10; cnt < 400; cnt *= 2)
+   {
+      std::vector<cg::point_2> pts = uniform_points(2 * cnt);
+      std::vector<cg::segment_2> s;
+      for (size_t l = 0; l != cnt; ++l)
+      {
+         cg::point_2 a = pts[2 * l], b = pts[2 * l + 1];
+         s.push_back(cg::segment_2(a, cg::point_2(a.x + (b.x - a.x) / 8, a.y + (b.y - a.y) / 8)));
+      }
+
+      check_intersect_all(s);
+   }
+}
+
+TEST(segment_intersection, bentley_ottmann_concurrent)
+{
+   using cg::point_2;
+   using cg::segment_2;
+
+   // many segments through one crossing point and rays of a star
+   std::vector<segment_2> s;
+   for (int l = 1; l != 12; ++l)
+      s.push_back(segment_2(point_2(-l, -3 * l + 1), point_2(l, 3 * l - 1)));
+   for (int l = -5; l <= 5; ++l)
+   {
+      s.push_back(segment_2(point_2(0, 0), point_2(10, l)));
+      s.push_back(segment_2(point_2(l, -10), point_2(l, 10)));
+      s.push_back(segment_2(point_2(-10, l * 0.1), point_2(10, -l * 0.3)));
+   }
+
+   check_intersect_all(s);
+}
+
+TEST(segment_intersection, shamos_hoey_simple)
+{
+   using cg::point_2;
+
+   std::vector<point_2> square = { point_2(0, 0), point_2(2, 0), point_2(2, 2), point_2(0, 2) };
+   EXPECT_TRUE(cg::is_simple(contour(square)));
+
+   std::vector<point_2> bow = { point_2(0, 0), point_2(2, 2), point_2(2, 0), point_2(0, 2) };
+   boost::optional<std::pair<size_t, size_t> > res = cg::find_self_intersection(contour(bow));
+   ASSERT_TRUE(res);
+   EXPECT_EQ(std::make_pair(size_t(0), size_t(2)), *res);
+
+   // collinear vertex is fine, a spike back along the edge is not
+   std::vector<point_2> flat = { point_2(0, 0), point_2(1, 0), point_2(2, 0), point_2(1, 1) };
+   EXPECT_TRUE(cg::is_simple(contour(flat)));
+
+   std::vector<point_2> spike = { point_2(0, 0), point_2(2, 0), point_2(1, 0), point_2(1, 1) };
+   EXPECT_FALSE(cg::is_simple(contour(spike)));
+
+   // vertex touching another edge, repeated vertex
+   std::vector<point_2> touch = { point_2(0, 0), point_2(4, 0), point_2(2, 2), point_2(3, 0), point_2(2, 3) };
+   EXPECT_FALSE(cg::is_simple(contour(touch)));
+
+   std::vector<point_2> twice = { point_2(0, 0), point_2(1, 0), point_2(1, 0), point_2(1, 1) };
+   EXPECT_FALSE(cg::is_simple(contour(twice)));
+
+   EXPECT_FALSE(cg::is_simple(contour({ point_2(0, 0), point_2(1, 1) })));
+   EXPECT_TRUE(cg::is_simple(star(50, 1, 3)));
+}
+
+TEST(segment_intersection, shamos_hoey_random)
+{
+   for (size_t cnt = 3; cnt < 12; ++cnt)
+      for (size_t l = 0; l != 200; ++l)
+         check_is_simple(contour(uniform_points(cnt)));
+
+   util::uniform_random_int<int, std::mt19937> rnd(0, 4);
+   for (size_t cnt = 3; cnt < 9; ++cnt)
+      for (size_t l = 0; l != 300; ++l)
+      {
+         std::vector<cg::point_2> pts;
+         for (size_t k = 0; k != cnt; ++k)
+            pts.push_back(cg::point_2(rnd(), rnd()));
+
+         check_is_simple(contour(pts));
+      }
+}
+
+TEST(segment_intersection, shamos_hoey_polygon)
+{
+   using cg::point_2;
+   using cg::polygon_with_holes_2;
+
+   cg::contour_2 outer = star(40, 10, 12);
+   std::vector<cg::contour_2> holes;
+   holes.push_back(star(10, 1, 2, false));
+
+   EXPECT_TRUE(cg::is_valid(polygon_with_holes_2(outer, holes)));
+   EXPECT_TRUE(cg::is_valid(polygon_with_holes_2(outer)));
+
+   // wrong orientations
+   EXPECT_FALSE(cg::is_valid(polygon_with_holes_2(star(40, 10, 12, false), holes)));
+   EXPECT_FALSE(cg::is_valid(polygon_with_holes_2(outer, std::vector<cg::contour_2>(1, star(10, 1, 2)))));
+
+   // hole outside, holes nested, holes crossing, hole touching outer
+   std::vector<cg::contour_2> bad = holes;
+   bad.push_back(contour({ point_2(20, 0), point_2(20, 1), point_2(21, 0) }));
+   EXPECT_FALSE(cg::is_valid(polygon_with_holes_2(outer, bad)));
+
+   bad = holes;
+   bad.push_back(contour({ point_2(0, 0), point_2(0, 0.1), point_2(0.1, 0) }));
+   EXPECT_FALSE(cg::is_valid(polygon_with_holes_2(outer, bad)));
+
+   bad = holes;
+   bad.push_back(contour({ point_2(0, 0), point_2(3, 3), point_2(3, 0) }));
+   boost::optional<std::pair<cg::polygon_edge, cg::polygon_edge> > res = cg::find_intersection(polygon_with_holes_2(outer, bad));
+   ASSERT_TRUE(res);
+   EXPECT_EQ(1u, res->first.first);
+   EXPECT_EQ(2u, res->second.first);
+   EXPECT_FALSE(cg::is_valid(polygon_with_holes_2(outer, bad)));
+
+   bad = holes;
+   bad.push_back(contour({ point_2(12, 0), point_2(5, 1), point_2(5, -1) }));
+   EXPECT_FALSE(cg::is_valid(polygon_with_holes_2(outer, bad)));
+
+   // sibling holes
+   std::vector<cg::contour_2> ok = holes;
+   ok.push_back(contour({ point_2(5, 0), point_2(5, 1), point_2(6, 0) }));
+   ok.push_back(contour({ point_2(-5, 0), point_2(-5, 1), point_2(-4, 0) }));
+   EXPECT_TRUE(cg::is_valid(polygon_with_holes_2(outer, ok)));
+   EXPECT_FALSE(cg::find_intersection(polygon_with_holes_2(outer, ok)));
+}
@@ -0,0 +1,455 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+#include <iterator>
+#include <sstream>
+
+#include <cg/primitives/polygon.h>
+#include <cg/operations/contains/polygon_point.h>
+#include <cg/spatial/polygon_locator.h>
+#include <cg/spatial/segment_grid_index.h>
+#include <cg/spatial/rtree.h>
+#include <cg/spatial/triangle_bvh.h>
+#include <cg/operations/has_intersection/segment_segment.h>
+#include <cg/operations/has_intersection/rectangle_segment.h>
+
+#include "random_utils.h"
+
+namespace
+{
+   cg::contour_2 square(double x0, double y0, double x1, double y1, bool ccw)
+   {
+      std::vector<cg::point_2> pts;
+      pts.push_back(cg::point_2(x0, y0));
+      pts.push_back(cg::point_2(x1, y0));
+      pts.push_back(cg::point_2(x1, y1));
+      pts.push_back(cg::point_2(x0, y1));
+
+      if (!ccw)
+         std::reverse(pts.begin(), pts.end());
+
+      return cg::contour_2(pts);
+   }
+
+   // n x n layer of unit squares with a hole in every other square
+   std::vector<cg::polygon_with_holes_2> squares_layer(size_t n)
+   {
+      std::vector<cg::polygon_with_holes_2> layer;
+
+      for (size_t i = 0; i != n; ++i)
+         for (size_t j = 0; j != n; ++j)
+         {
+            cg::polygon_with_holes_2 p(square(i, j, i + 1, j + 1, true));
+            if ((i + j) % 2)
+               p.holes.push_back(square(i + .25, j + .25, i + .75, j + .75, false));
+            layer.push_back(p);
+         }
+
+      return layer;
+   }
+
+   std::vector<cg::segment_2> short_segments(size_t count, double len)
+   {
+      std::vector<cg::point_2> pts = uniform_points(2 * count);
+
+      std::vector<cg::segment_2> res;
+      for (size_t l = 0; l != count; ++l)
+      {
+         cg::point_2 a = pts[2 * l], b = pts[2 * l + 1];
+         res.push_back(cg::segment_2(a, cg::point_2(a.x + (b.x - a.x) * len, a.y + (b.y - a.y) * len)));
+      }
+
+      return res;
+   }
+
+   template <class Primitive>
+   void check_rtree(std::vector<Primitive> const & items, cg::packed_rtree<Primitive> const & tree)
+   {
+      std::vector<cg::point_2> pts = uniform_points(200);
+
+      for (size_t q = 0; q + 1 < pts.size(); q += 2)
+      {
+         cg::point_2 a = pts[q], b(pts[q].x + pts[q + 1].x / 10, pts[q].y + pts[q + 1].y / 10);
+         cg::segment_2 s(a, b);
+         cg::rectangle_2 r(cg::range(std::min(a.x, b.x), std::max(a.x, b.x)), cg::range(std::min(a.y, b.y), std::max(a.y, b.y)));
+
+         std::vector<size_t> expected_window, expected_stab, expected_seg;
+         for (size_t l = 0; l != items.size(); ++l)
+         {
+            if (cg::has_intersection(r, items[l]))
+               expected_window.push_back(l);
+            if (cg::detail::rtree_stabs(items[l], a))
+               expected_stab.push_back(l);
+            if (cg::has_intersection(items[l], s))
+               expected_seg.push_back(l);
+         }
+
+         std::vector<size_t> window, stab, seg;
+         tree.window(r, std::back_inserter(window));
+         tree.stabbing(a, std::back_inserter(stab));
+         tree.intersecting(s, std::back_inserter(seg));
+
+         std::sort(window.begin(), window.end());
+         std::sort(stab.begin(), stab.end());
+         std::sort(seg.begin(), seg.end());
+
+         EXPECT_EQ(expected_window, window);
+         EXPECT_EQ(expected_stab, stab);
+         EXPECT_EQ(expected_seg, seg);
+         EXPECT_EQ(!expected_seg.empty(), tree.intersects(s));
+      }
+   }
+
+   // n x n squares split into two triangles each, shuffled
+   std::vector<cg::triangle_2> grid_triangles(int n)
+   {
+      std::vector<cg::triangle_2> res;
+      for (int i = 0; i != n; ++i)
+         for (int j = 0; j != n; ++j)
+         {
+            cg::point_2 a(i, j), b(i + 1, j), c(i + 1, j + 1), d(i, j + 1);
+            res.push_back(cg::triangle_2(a, b, c));
+            res.push_back(cg::triangle_2(a, c, d));
+         }
+
+      std::mt19937 gen(7);
+      std::shuffle(res.begin(), res.end(), gen);
+      return res;
+   }
+
+   boost::optional<size_t> naive_locate(std::vector<cg::triangle_2> const & triangles, cg::point_2 const & q)
+   {
+      for (size_t l = 0; l != triangles.size(); ++l)
+         if (cg::contains(triangles[l], q))
+            return l;
+
+      return boost::none;
+   }
+
+   boost::optional<size_t> naive_first_hit(std::vector<cg::triangle_2> const & triangles, cg::segment_2 const & s)
+   {
+      boost::optional<size_t> res;
+      double best = 2;
+      for (size_t l = 0; l != triangles.size(); ++l)
+      {
+         if (!cg::has_intersection(triangles[l], s))
+            continue;
+
+         double t = cg::detail::entry_parameter(triangles[l], s);
+         if (t < best)
+         {
+            best = t;
+            res = l;
+         }
+      }
+
+      return res;
+   }
+
+   void check_grid_index(cg::segment_grid_index const & index, std::vector<cg::segment_2> const & live,
+                         std::vector<size_t> const & ids, std::vector<cg::segment_2> const & queries)
+   {
+      for (size_t q = 0; q != queries.size(); ++q)
+      {
+         std::vector<size_t> expected;
+         for (size_t l = 0; l != live.size(); ++l)
+            if (cg::has_intersection(live[l], queries[q]))
+               expected.push_back(ids[l]);
+         std::sort(expected.begin(), expected.end());
+
+         std::vector<size_t> found;
+         index.query(queries[q], std::back_inserter(found));
+         EXPECT_EQ(expected, found);
+         EXPECT_EQ(!expected.empty(), index.intersects(queries[q]));
+      }
+   }
+}
+
+TEST(spatial, polygon_locator)
+{
+   using cg::point_2;
+
+   std::vector<cg::polygon_with_holes_2> layer = squares_layer(30);
+   cg::polygon_locator locator(layer);
+
+   ASSERT_EQ(locator.size(), layer.size());
+
+   std::vector<point_2> pts = uniform_points(20000);
+   for (size_t l = 0; l != 300; ++l)
+      pts.push_back(point_2(l * 0.125, l * 0.25));
+
+   for (size_t l = 0; l != pts.size(); ++l)
+   {
+      point_2 q(pts[l].x / 3 + 15, pts[l].y / 3 + 15);
+
+      std::vector<size_t> expected;
+      for (size_t k = 0; k != layer.size(); ++k)
+         if (cg::contains(layer[k], q))
+            expected.push_back(k);
+
+      std::vector<size_t> found;
+      locator.locate_all(q, std::back_inserter(found));
+      EXPECT_EQ(expected, found);
+
+      boost::optional<size_t> first = locator.locate(q);
+      EXPECT_EQ(!expected.empty(), bool(first));
+      if (first && !expected.empty())
+      {
+         EXPECT_EQ(expected.front(), *first);
+      }
+   }
+}
+
+TEST(spatial, polygon_locator_degenerate)
+{
+   using cg::point_2;
+
+   std::vector<cg::polygon_with_holes_2> layer;
+   EXPECT_FALSE(cg::polygon_locator(layer).locate(point_2(0, 0)));
+
+   layer.push_back(cg::polygon_with_holes_2());
+   layer.push_back(cg::polygon_with_holes_2(square(0, 0, 4, 4, true)));
+
+   cg::polygon_locator locator(layer, 100);
+   EXPECT_EQ(*locator.locate(point_2(4, 4)), 1u);
+   EXPECT_EQ(*locator.locate(point_2(1, 2)), 1u);
+   EXPECT_FALSE(locator.locate(point_2(5, 2)));
+}
+
+TEST(spatial, segment_grid_index)
+{
+   std::vector<cg::segment_2> segments = short_segments(3000, 0.02);
+   std::vector<cg::segment_2> queries = short_segments(300, 0.05);
+
+   // lattice aligned segments run along cell borders
+   for (int l = -10; l != 10; ++l)
+   {
+      segments.push_back(cg::segment_2(cg::point_2(l, -10), cg::point_2(l, 10)));
+      queries.push_back(cg::segment_2(cg::point_2(-10, l), cg::point_2(10, l)));
+      queries.push_back(cg::segment_2(cg::point_2(l, l), cg::point_2(l, l)));
+   }
+
+   cg::segment_grid_index index(segments);
+   ASSERT_EQ(segments.size(), index.size());
+
+   std::vector<size_t> ids(segments.size());
+   for (size_t l = 0; l != ids.size(); ++l)
+      ids[l] = l;
+
+   check_grid_index(index, segments, ids, queries);
+
+   // erase every third segment, insert new ones into the freed ids
+   std::vector<cg::segment_2> live;
+   std::vector<size_t> live_ids;
+   for (size_t l = 0; l != segments.size(); ++l)
+   {
+      if (l % 3 == 0)
+      {
+         index.erase(l);
+         continue;
+      }
+
+      live.push_back(segments[l]);
+      live_ids.push_back(l);
+   }
+
+   std::vector<cg::segment_2> added = short_segments(5000, 0.01);
+   for (size_t l = 0; l != added.size(); ++l)
+   {
+      live_ids.push_back(index.insert(added[l]));
+      live.push_back(added[l]);
+   }
+
+   ASSERT_EQ(live.size(), index.size());
+   check_grid_index(index, live, live_ids, queries);
+
+   for (int l = 0; l != 50; ++l)
+   {
+      cg::rectangle_2 r(cg::range_t<double>(l * 0.1 - 6, l * 0.13 - 5.5), cg::range_t<double>(-l * 0.2, 1 + l * 0.05));
+
+      std::vector<size_t> expected;
+      for (size_t k = 0; k != live.size(); ++k)
+         if (cg::has_intersection(r, live[k]))
+            expected.push_back(live_ids[k]);
+      std::sort(expected.begin(), expected.end());
+
+      std::vector<size_t> found;
+      index.query(r, std::back_inserter(found));
+      EXPECT_EQ(expected, found);
+   }
+
+   for (size_t l = 0; l != live_ids.size(); ++l)
+      index.erase(live_ids[l]);
+
+   EXPECT_EQ(0u, index.size());
+   EXPECT_FALSE(index.intersects(queries.front()));
+}
+
+TEST(spatial, segment_grid_index_long)
+{
+   using cg::point_2;
+
+   // a few segments hundreds of cells long among short ones
+   std::vector<cg::segment_2> segments = short_segments(2000, 0.01);
+   std::vector<cg::segment_2> queries = short_segments(200, 0.05);
+   for (int l = 0; l != 5; ++l)
+   {
+      segments.push_back(cg::segment_2(point_2(-1e4, l - 2.5), point_2(1e4, 2.5 - l)));
+      queries.push_back(cg::segment_2(point_2(l - 2.5, -1e4), point_2(2.5 - l, 1e4)));
+   }
+
+   cg::segment_grid_index index(segments);
+   std::vector<size_t> ids(segments.size());
+   for (size_t l = 0; l != ids.size(); ++l)
+      ids[l] = l;
+
+   check_grid_index(index, segments, ids, queries);
+
+   // inserted and erased long segments between rebuilds
+   segments.push_back(cg::segment_2(point_2(-3e4, 1e4), point_2(3e4, -1e4)));
+   ids.push_back(index.insert(segments.back()));
+   check_grid_index(index, segments, ids, queries);
+
+   index.erase(ids[2000]);
+   segments.erase(segments.begin() + 2000);
+   ids.erase(ids.begin() + 2000);
+   check_grid_index(index, segments, ids, queries);
+
+   cg::rectangle_2 r(cg::range_t<double>(-0.5, 0.5), cg::range_t<double>(-0.5, 0.5));
+   std::vector<size_t> expected, found;
+   for (size_t l = 0; l != segments.size(); ++l)
+      if (cg::has_intersection(r, segments[l]))
+         expected.push_back(ids[l]);
+   std::sort(expected.begin(), expected.end());
+   index.query(r, std::back_inserter(found));
+   EXPECT_EQ(expected, found);
+}
+
+TEST(spatial, packed_rtree)
+{
+   using cg::point_2;
+
+   std::vector<point_2> pts = uniform_points(9000);
+
+   std::vector<cg::segment_2> segments;
+   std::vector<cg::triangle_2> triangles;
+   std::vector<cg::rectangle_2> rectangles;
+   for (size_t l = 0; l + 2 < pts.size(); l += 3)
+   {
+      point_2 a = pts[l];
+      point_2 b(a.x + pts[l + 1].x / 20, a.y + pts[l + 1].y / 20);
+      point_2 c(a.x + pts[l + 2].x / 20, a.y + pts[l + 2].y / 20);
+
+      segments.push_back(cg::segment_2(a, b));
+      triangles.push_back(cg::triangle_2(a, b, c));
+      rectangles.push_back(cg::rectangle_2(cg::range(std::min(a.x, b.x), std::max(a.x, b.x)),
+                                           cg::range(std::min(a.y, c.y), std::max(a.y, c.y))));
+   }
+
+   check_rtree(segments, cg::packed_rtree<cg::segment_2>(segments));
+   check_rtree(triangles, cg::packed_rtree<cg::triangle_2>(triangles, 4, 3));
+   check_rtree(rectangles, cg::packed_rtree<cg::rectangle_2>(rectangles, 9, 1));
+
+   // small and empty trees
+   std::vector<cg::segment_2> few(segments.begin(), segments.begin() + 3);
+   check_rtree(few, cg::packed_rtree<cg::segment_2>(few));
+   check_rtree(std::vector<cg::segment_2>(), cg::packed_rtree<cg::segment_2>(std::vector<cg::segment_2>()));
+}
+
+TEST(spatial, packed_rtree_serialization)
+{
+   std::vector<cg::point_2> pts = uniform_points(3000);
+
+   std::vector<cg::triangle_2> triangles;
+   for (size_t l = 0; l + 2 < pts.size(); l += 3)
+      triangles.push_back(cg::triangle_2(pts[l], cg::point_2(pts[l].x + 1, pts[l].y), pts[l + 1]));
+
+   cg::packed_rtree<cg::triangle_2> tree(triangles, 8);
+
+   std::stringstream buf;
+   tree.save(buf);
+
+   cg::packed_rtree<cg::triangle_2> loaded;
+   ASSERT_TRUE(loaded.load(buf));
+   EXPECT_EQ(tree.size(), loaded.size());
+   check_rtree(triangles, loaded);
+
+   // another primitive type and a truncated image are rejected
+   std::string image = buf.str();
+
+   std::stringstream other(image);
+   cg::packed_rtree<cg::segment_2> wrong;
+   EXPECT_FALSE(wrong.load(other));
+
+   std::stringstream truncated(image.substr(0, image.size() / 2));
+   EXPECT_FALSE(loaded.load(truncated));
+   EXPECT_EQ(0u, loaded.size());
+
+   // the root as its own child, which a search would follow forever
+   size_t const header = 5 * sizeof(uint64_t), root_first = header + sizeof(cg::rectangle_2);
+   std::string cyclic = image;
+   uint32_t zero = 0;
+   cyclic.replace(root_first, sizeof(zero), reinterpret_cast<char const *>(&zero), sizeof(zero));
+   std::stringstream cyclic_in(cyclic);
+   EXPECT_FALSE(loaded.load(cyclic_in));
+   EXPECT_EQ(0u, loaded.size());
+
+   // counts far beyond the stream are rejected before allocating
+   std::string huge = image;
+   uint64_t count = uint64_t(1) << 31;
+   huge.replace(2 * sizeof(uint64_t), sizeof(count), reinterpret_cast<char const *>(&count), sizeof(count));
+   huge.replace(4 * sizeof(uint64_t), sizeof(count), reinterpret_cast<char const *>(&count), sizeof(count));
+   std::stringstream huge_in(huge);
+   EXPECT_FALSE(loaded.load(huge_in));
+   EXPECT_EQ(0u, loaded.size());
+}
+
+TEST(spatial, triangle_bvh)
+{
+   using cg::point_2;
+   using cg::segment_2;
+
+   std::vector<cg::triangle_2> triangles = grid_triangles(40);
+   cg::triangle_bvh bvh(triangles);
+   ASSERT_EQ(triangles.size(), bvh.size());
+
+   std::vector<point_2> pts = uniform_points(2000);
+   std::vector<point_2> queries;
+   std::vector<segment_2> segments;
+   for (size_t l = 0; l + 1 < pts.size(); l += 2)
+   {
+      point_2 a(pts[l].x / 4 + 20, pts[l].y / 4 + 20);
+      point_2 b(pts[l + 1].x / 4 + 20, pts[l + 1].y / 4 + 20);
+      queries.push_back(a);
+      segments.push_back(segment_2(a, b));
+   }
+
+   // lattice points lie on several triangles
+   for (int l = -2; l < 45; l += 3)
+   {
+      queries.push_back(point_2(l, 40 - l));
+      segments.push_back(segment_2(point_2(-5, l), point_2(50, l)));
+      segments.push_back(segment_2(point_2(l + .5, 50), point_2(l + .5, -3)));
+   }
+
+   for (size_t l = 0; l != queries.size(); ++l)
+      EXPECT_TRUE(naive_locate(triangles, queries[l]) == bvh.locate(queries[l]));
+
+   for (size_t l = 0; l != segments.size(); ++l)
+      EXPECT_TRUE(naive_first_hit(triangles, segments[l]) == bvh.first_hit(segments[l]));
+
+   std::vector<boost::optional<size_t> > located, hits;
+   bvh.locate(queries.begin(), queries.end(), std::back_inserter(located));
+   bvh.first_hit(segments.begin(), segments.end(), std::back_inserter(hits));
+
+   ASSERT_EQ(queries.size(), located.size());
+   ASSERT_EQ(segments.size(), hits.size());
+   for (size_t l = 0; l != queries.size(); ++l)
+      EXPECT_TRUE(bvh.locate(queries[l]) == located[l]);
+   for (size_t l = 0; l != segments.size(); ++l)
+      EXPECT_TRUE(bvh.first_hit(segments[l]) == hits[l]);
+
+   cg::triangle_bvh empty((std::vector<cg::triangle_2>()));
+   EXPECT_FALSE(empty.locate(point_2(0, 0)));
+   EXPECT_FALSE(empty.first_hit(segment_2(point_2(0, 0), point_2(1, 1))));
+}
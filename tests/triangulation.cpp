@@ -1,11 +1,24 @@
 #include <vector>
 #include <iostream>
+#include <random>
+#include <cmath>
+#include <map>
+#include <array>
+#include <algorithm>
 #include <gtest/gtest.h>
 
 #include "cg/triangulation/triangulation.h"
+#include "cg/triangulation/constrained_delaunay.h"
+#include "cg/triangulation/delaunay_flip.h"
+#include "cg/triangulation/half_edge_mesh.h"
+#include "cg/triangulation/triangulation_batch.h"
+#include "cg/triangulation/monotone_partition.h"
+#include "cg/triangulation/refinement.h"
+#include "cg/triangulation/triangulation_stream.h"
 #include "cg/operations/contains/triangle_point.h"
 #include "cg/operations/contains/segment_point.h"
 #include "cg/operations/contains/contour_point.h"
+#include "cg/operations/contains/polygon_point.h"
 #include <gmpxx.h>
 
 using namespace std;
@@ -46,12 +59,12 @@ bool inner_intersection(const segment_2 & a, const triangle_2 &t) {
    return false;
 }
 
+// points on a hole boundary are outside, unlike in the closed polygon_with_holes_2
 bool contains(const point_2 &p, polygon &poly) {
-   if (!contains(poly[0], p)) return false;
    for (size_t i = 1; i < poly.size(); i++) {
-      if (contains(poly[i], p)) return false;
+      if (on_boundary(poly[i], p)) return false;
    }
-   return true;
+   return contains(polygon_with_holes_2(poly), p);
 }
 
 mpq_class S(polygon &poly) {
@@ -83,8 +96,9 @@ void check_triangulation(polygon poly, vector<triangle_2> t) {
    size_t count_v = 0;
    for (auto cont : poly) count_v += cont.vertices_num();
    EXPECT_TRUE(t.size() == count_v + 2 * (poly.size() - 2));
+   //ccw, in particular not degenerate
    for (auto tr : t) {
-      EXPECT_FALSE(orientation(tr[0], tr[1], tr[2]) == CG_COLLINEAR);
+      EXPECT_TRUE(orientation(tr[0], tr[1], tr[2]) == CG_LEFT);
    }
    //which not intersect
    //(intersections with touches allowed
@@ -118,12 +132,708 @@ void check_triangulation(polygon poly, vector<triangle_2> t) {
    EXPECT_TRUE(Spoly == Striangles);
 }
 
+// no triangle of the mesh has the apex across one of its edges, except the
+// edges u -> w in fixed, inside its circumcircle
+void check_locally_delaunay(const indexed_mesh &mesh, const vector<pair<uint32_t, uint32_t>> &fixed = {}) {
+   std::map<pair<uint32_t, uint32_t>, uint32_t> apex;
+   for (size_t i = 0; i != mesh.triangles_num(); ++i)
+      for (size_t k = 0; k != 3; ++k)
+         apex[make_pair(mesh.indices[3 * i + k], mesh.indices[3 * i + (k + 1) % 3])] = mesh.indices[3 * i + (k + 2) % 3];
+
+   for (size_t i = 0; i != mesh.triangles_num(); ++i)
+      for (size_t k = 0; k != 3; ++k) {
+         auto it = apex.find(make_pair(mesh.indices[3 * i + (k + 1) % 3], mesh.indices[3 * i + k]));
+         triangle_2 t = mesh.triangle(i);
+         pair<uint32_t, uint32_t> e(mesh.indices[3 * i + k], mesh.indices[3 * i + (k + 1) % 3]);
+         if (std::count(fixed.begin(), fixed.end(), e) || std::count(fixed.begin(), fixed.end(), make_pair(e.second, e.first)))
+            continue;
+         if (it != apex.end()) {
+            EXPECT_NE(CG_INSIDE, in_circle(t[0], t[1], t[2], mesh.vertices[it->second]));
+         }
+      }
+}
+
+// a valid triangulation whose edges off the contours are locally delaunay
+void check_constrained_delaunay(polygon poly) {
+   indexed_mesh mesh = constrained_delaunay_indexed(poly);
+   vector<triangle_2> t = constrained_delaunay(poly);
+   check_triangulation(poly, t);
+
+   ASSERT_EQ(t.size(), mesh.triangles_num());
+   for (size_t i = 0; i != t.size(); ++i)
+      EXPECT_EQ(t[i], mesh.triangle(i));
+   check_locally_delaunay(mesh);
+}
+
+// ccw star shaped polygon around the origin, vertices on the integer
+// lattice unless lattice is false. big lattice stars are not simple.
+contour_2 star_contour(size_t n, unsigned seed, bool lattice = true) {
+   std::mt19937 gen(seed);
+   std::uniform_real_distribution<double> radius(10, 100);
+   vector<point_2> pts;
+   for (size_t i = 0; i != n; ++i) {
+      double a = 2 * M_PI * i / n;
+      double r = radius(gen);
+      if (lattice)
+         pts.push_back(point_2(std::floor(r * std::cos(a)), std::floor(r * std::sin(a))));
+      else
+         pts.push_back(point_2(r * std::cos(a), r * std::sin(a)));
+   }
+   return contour_2(pts);
+}
+
+// ccw comb with its back at x and teeth along x, a split and a merge
+// vertex at every tooth. the sweep line crosses two edges per tooth. bent
+// teeth have a left regular vertex on their upper edge.
+contour_2 comb_contour(size_t teeth, double x = 0, bool bent = false) {
+   vector<point_2> comb = {point_2(x, 0), point_2(x, 2 * double(teeth))};
+   for (size_t i = teeth; i-- != 0;) {
+      if (bent)
+         comb.push_back(point_2(x - 2, 2 * double(i) + 1.6));
+      comb.push_back(point_2(x - 3, 2 * double(i) + 1));
+      comb.push_back(point_2(x - 1, 2 * double(i)));
+   }
+   comb.back() = point_2(x - 3, 0);
+   return contour_2(comb);
+}
+
+vector<const void *> buffers(const triangulation_workspace &ws, const vector<triangle_2> &res) {
+   return {ws.points.data(), ws.prev.data(), ws.next.data(), ws.order.data(), ws.status.entries.data(),
+           ws.status.sizes.data(), ws.status.inners.data(), ws.chains.data(), ws.nodes.data(), res.data()};
+}
+
+TEST(triangulation, workspace) {
+   polygon star = {star_contour(60, 1)};
+   polygon holes = {contour_2({point_2(-200, -200), point_2(200, -200), point_2(200, 200), point_2(-200, 200)}),
+                    contour_2({point_2(-150, 10), point_2(-150, 150), point_2(-10, 150), point_2(-10, 10)}),
+                    contour_2({point_2(10, -150), point_2(10, -10), point_2(150, -10), point_2(150, -150)})};
+
+   triangulation_workspace ws;
+   vector<triangle_2> res;
+   for (polygon *poly : {&star, &holes, &star}) {
+      triangulate(*poly, ws, res);
+      check_triangulation(*poly, res);
+      EXPECT_EQ(triangulate(*poly), res);
+   }
+
+   // warm buffers are not reallocated
+   vector<const void *> warm = buffers(ws, res);
+   triangulate(holes, ws, res);
+   triangulate(star, ws, res);
+   EXPECT_EQ(warm, buffers(ws, res));
+
+   triangulate(polygon(), ws, res);
+   EXPECT_TRUE(res.empty());
+}
+
+TEST(triangulation, wide_status) {
+   // 3000 teeth put 6000 edges in the status at once: leaves and inner
+   // nodes split, the root grows twice and every tooth refreshes the path
+   // to its entry. the status empties between the combs, and the second
+   // one reuses the freed nodes.
+   polygon small = {comb_contour(5, 0, true)},
+           wide = {comb_contour(3000, 0, true), comb_contour(3000, -10, true)};
+   check_triangulation(small, triangulate(small));
+
+   vector<triangle_2> expected = triangulate(wide);
+   ASSERT_EQ(18000u, expected.size());
+   mpq_class area = 0;
+   for (triangle_2 &t : expected) {
+      EXPECT_EQ(CG_LEFT, orientation(t[0], t[1], t[2]));
+      area += S(t);
+   }
+   EXPECT_TRUE(S(wide) == area);
+
+   // a warm workspace gives the same triangles without reallocating
+   triangulation_workspace ws;
+   vector<triangle_2> res;
+   triangulate(wide, ws, res);
+   EXPECT_EQ(expected, res);
+   vector<const void *> warm = buffers(ws, res);
+   triangulate(small, ws, res);
+   triangulate(wide, ws, res);
+   EXPECT_EQ(expected, res);
+   EXPECT_EQ(warm, buffers(ws, res));
+}
+
+TEST(triangulation, indexed_mesh) {
+   polygon poly = {star_contour(40, 2),
+                   contour_2({point_2(-4, -2), point_2(-4, 2), point_2(-1, 2), point_2(-1, -2)}),
+                   contour_2({point_2(1, 0), point_2(2, 2), point_2(3, 0)})};
+
+   triangulation_workspace ws;
+   indexed_mesh mesh;
+   triangulate(poly, ws, mesh, true);
+   vector<triangle_2> t = triangulate(poly);
+
+   ASSERT_EQ(4u, mesh.contour_offsets.size());
+   ASSERT_EQ(47u, mesh.vertices.size());
+   for (size_t k = 0; k != poly.size(); ++k)
+      for (size_t i = 0; i != poly[k].size(); ++i) {
+         EXPECT_EQ(poly[k][i], mesh.vertices[mesh.contour_offsets[k] + i]);
+         EXPECT_EQ(k, mesh.contour(uint32_t(mesh.contour_offsets[k] + i)));
+      }
+
+   ASSERT_EQ(t.size(), mesh.triangles_num());
+   ASSERT_EQ(t.size(), mesh.triangle_contours.size());
+   for (size_t i = 0; i != t.size(); ++i) {
+      EXPECT_EQ(t[i], mesh.triangle(i));
+      EXPECT_EQ(CG_LEFT, orientation(t[i][0], t[i][1], t[i][2]));
+
+      uint32_t least = std::min(std::min(mesh.indices[3 * i], mesh.indices[3 * i + 1]), mesh.indices[3 * i + 2]);
+      uint32_t k = 0;
+      while (mesh.contour_offsets[k + 1] <= least) ++k;
+      EXPECT_EQ(k, mesh.triangle_contours[i]);
+   }
+
+   mesh = triangulate_indexed(poly);
+   EXPECT_EQ(t.size(), mesh.triangles_num());
+   EXPECT_TRUE(mesh.triangle_contours.empty());
+}
+
+TEST(triangulation, constrained_delaunay) {
+   polygon star = {star_contour(200, 3)};
+   polygon holes = {contour_2({point_2(-200, -200), point_2(200, -200), point_2(200, 200), point_2(-200, 200)}),
+                    contour_2({point_2(-150, 10), point_2(-150, 150), point_2(-10, 150), point_2(-10, 10)}),
+                    contour_2({point_2(10, -150), point_2(10, -10), point_2(150, -10), point_2(150, -150)})};
+
+   // collinear runs on the outer contour
+   polygon collinear = {contour_2({point_2(0, 0), point_2(2, 0), point_2(4, 0), point_2(6, 0), point_2(6, 6), point_2(0, 6)}),
+                        contour_2({point_2(3, 3), point_2(2, 4), point_2(4, 4)})};
+
+   for (polygon *poly : {&star, &holes, &collinear})
+      check_constrained_delaunay(*poly);
+
+   indexed_mesh mesh;
+   constrained_delaunay(holes, mesh, true);
+   ASSERT_EQ(mesh.triangles_num(), mesh.triangle_contours.size());
+   EXPECT_EQ(holes[0][0], mesh.vertices[0]);
+   EXPECT_EQ(4u, mesh.contour_offsets[1]);
+
+   constrained_delaunay(polygon(), mesh);
+   EXPECT_EQ(0u, mesh.triangles_num());
+}
+
+// the triangles of a mesh as sorted vertex triples, each starting at its
+// least vertex
+vector<array<uint32_t, 3>> normalized(const indexed_mesh &mesh) {
+   vector<array<uint32_t, 3>> res;
+   for (size_t i = 0; i != mesh.triangles_num(); ++i) {
+      const uint32_t *t = &mesh.indices[3 * i];
+      size_t k = std::min_element(t, t + 3) - t;
+      res.push_back({{t[k], t[(k + 1) % 3], t[(k + 2) % 3]}});
+   }
+   std::sort(res.begin(), res.end());
+   return res;
+}
+
+TEST(triangulation, delaunay_flip) {
+   polygon holes = {contour_2({point_2(-200, -200), point_2(200, -200), point_2(200, 200), point_2(-200, 200)}),
+                    contour_2({point_2(-150, 10), point_2(-150, 150), point_2(-10, 150), point_2(-10, 10)}),
+                    contour_2({point_2(10, -150), point_2(10, -10), point_2(150, -10), point_2(150, -150)})};
+   for (polygon poly : {polygon{star_contour(200, 4)}, holes}) {
+      indexed_mesh mesh = triangulate_indexed(poly, true);
+      size_t n = mesh.triangles_num();
+      delaunay_flip(mesh);
+
+      ASSERT_EQ(n, mesh.triangles_num());
+      vector<triangle_2> t;
+      for (size_t i = 0; i != n; ++i) {
+         t.push_back(mesh.triangle(i));
+         EXPECT_EQ(mesh.contour(*std::min_element(&mesh.indices[3 * i], &mesh.indices[3 * i + 3])), mesh.triangle_contours[i]);
+      }
+      check_triangulation(poly, t);
+      check_locally_delaunay(mesh);
+
+      // the soup version finds the same flips
+      vector<triangle_2> soup = triangulate(poly);
+      delaunay_flip(soup);
+      check_triangulation(poly, soup);
+   }
+
+   // big enough to flip in parallel: the same constrained delaunay
+   // triangulation on any number of threads
+   polygon star = {star_contour(100000, 5, false)};
+   vector<array<uint32_t, 3>> expected = normalized(constrained_delaunay_indexed(star));
+   for (size_t threads : {1, 4}) {
+      indexed_mesh mesh = triangulate_indexed(star);
+      EXPECT_LT(0u, delaunay_flip(mesh, {}, threads));
+      EXPECT_EQ(expected, normalized(mesh));
+   }
+
+   // a fan over a convex polygon with one diagonal kept
+   std::mt19937 gen(5);
+   std::uniform_real_distribution<double> radius(10, 100);
+   vector<point_2> hull;
+   for (size_t i = 0; i != 50; ++i) {
+      double a = 2 * M_PI * i / 50;
+      double r = 100 + radius(gen) / 10;
+      hull.push_back(point_2(r * std::cos(a), r * std::sin(a)));
+   }
+   indexed_mesh fan;
+   fan.vertices = hull;
+   for (uint32_t i = 1; i + 1 != hull.size(); ++i)
+      fan.indices.insert(fan.indices.end(), {0, i, i + 1});
+   vector<pair<uint32_t, uint32_t>> fixed = {{25, 0}};
+   delaunay_flip(fan, fixed);
+
+   vector<triangle_2> t;
+   bool kept = false;
+   for (size_t i = 0; i != fan.triangles_num(); ++i) {
+      t.push_back(fan.triangle(i));
+      for (size_t k = 0; k != 3; ++k)
+         kept |= fan.indices[3 * i + k] == 25 && fan.indices[3 * i + (k + 1) % 3] == 0;
+   }
+   EXPECT_TRUE(kept);
+   check_triangulation({contour_2(hull)}, t);
+   check_locally_delaunay(fan, fixed);
+
+   indexed_mesh empty;
+   EXPECT_EQ(0u, delaunay_flip(empty));
+}
+
+TEST(triangulation, half_edge_mesh) {
+   polygon holes = {contour_2({point_2(-200, -200), point_2(200, -200), point_2(200, 200), point_2(-200, 200)}),
+                    contour_2({point_2(-150, 10), point_2(-150, 150), point_2(-10, 150), point_2(-10, 10)}),
+                    contour_2({point_2(10, -150), point_2(10, -10), point_2(150, -10), point_2(150, -150)})};
+   for (polygon poly : {polygon{star_contour(200, 6)}, holes}) {
+      indexed_mesh mesh = triangulate_indexed(poly);
+      half_edge_mesh hm(mesh);
+      ASSERT_EQ(mesh.triangles_num(), hm.triangles_num());
+      ASSERT_EQ(mesh.vertices.size(), hm.vertices_num());
+
+      std::map<pair<uint32_t, uint32_t>, uint32_t> edges;
+      for (uint32_t e = 0; e != hm.half_edges_num(); ++e)
+         edges[make_pair(hm.origin(e), hm.target(e))] = e;
+
+      // twins are the reversed edges, the boundary is the contours
+      size_t boundary = 0;
+      for (uint32_t e = 0; e != hm.half_edges_num(); ++e) {
+         EXPECT_EQ(mesh.indices[e], hm.origin(e));
+         EXPECT_EQ(e / 3, hm.next(e) / 3);
+         EXPECT_EQ(e, hm.next(hm.prev(e)));
+         auto it = edges.find(make_pair(hm.target(e), hm.origin(e)));
+         if (it == edges.end()) {
+            EXPECT_TRUE(hm.is_boundary(e));
+            ++boundary;
+            EXPECT_TRUE(hm.is_boundary(hm.next_boundary(e)));
+            EXPECT_EQ(hm.target(e), hm.origin(hm.next_boundary(e)));
+         } else {
+            EXPECT_EQ(it->second, hm.twin(e));
+            EXPECT_EQ(hm.twin(e) / 3, hm.neighbor(e / 3, e % 3));
+         }
+      }
+      EXPECT_EQ(mesh.vertices.size(), boundary);
+
+      // the loops of the boundary are the contours
+      vector<bool> seen(hm.half_edges_num());
+      size_t loops = 0;
+      for (uint32_t e = 0; e != hm.half_edges_num(); ++e)
+         if (hm.is_boundary(e) && !seen[e]) {
+            ++loops;
+            uint32_t f = e;
+            do {
+               seen[f] = true;
+               EXPECT_EQ(mesh.contour(hm.origin(e)), mesh.contour(hm.origin(f)));
+               f = hm.next_boundary(f);
+            } while (f != e);
+         }
+      EXPECT_EQ(poly.size(), loops);
+
+      // turning ccw from out(v) passes every triangle at v once
+      vector<size_t> degree(hm.vertices_num());
+      for (uint32_t e = 0; e != hm.half_edges_num(); ++e)
+         ++degree[hm.origin(e)];
+      for (uint32_t v = 0; v != hm.vertices_num(); ++v) {
+         uint32_t e = hm.out(v);
+         ASSERT_EQ(v, hm.origin(e));
+         EXPECT_TRUE(hm.is_boundary(e));
+         EXPECT_EQ(detail::no_twin, hm.turn_cw(e));
+         size_t n = 0;
+         for (; e != detail::no_twin; e = hm.turn_ccw(e), ++n)
+            EXPECT_EQ(v, hm.origin(e));
+         EXPECT_EQ(degree[v], n);
+      }
+   }
+
+   // around an interior vertex the star closes
+   indexed_mesh fan;
+   fan.vertices = {point_2(0, 0), point_2(1, 0), point_2(0, 1), point_2(-1, 0), point_2(0, -1)};
+   fan.indices = {0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 1};
+   half_edge_mesh hm(fan);
+   uint32_t e = hm.out(0);
+   for (size_t l = 0; l != 4; ++l)
+      e = hm.turn_ccw(e);
+   EXPECT_EQ(hm.out(0), e);
+   EXPECT_EQ(hm.out(0), hm.turn_ccw(hm.turn_cw(hm.out(0))));
+   EXPECT_EQ(0u, half_edge_mesh(indexed_mesh()).triangles_num());
+}
+
+TEST(triangulation, small_polygons) {
+   vector<polygon> polys = {
+      {contour_2({point_2(0, 0), point_2(1, 0), point_2(0, 1)})},
+      {contour_2({point_2(0, 0), point_2(2, 0), point_2(3, 2), point_2(0, 1)})},
+      // convex with collinear vertices, no fan from a flat vertex
+      {contour_2({point_2(0, 0), point_2(1, 0), point_2(2, 0), point_2(2, 1), point_2(2, 2), point_2(1, 2), point_2(0, 2), point_2(0, 1)})},
+      {contour_2({point_2(1, 0), point_2(2, 0), point_2(2, 2), point_2(0, 2), point_2(0, 0)})},
+      // reflex vertices, a vertex on the diagonal of the first ear
+      {contour_2({point_2(0, 0), point_2(3, 0), point_2(3, 1), point_2(1, 1), point_2(1, 3), point_2(0, 3)})},
+      {contour_2({point_2(0, 0), point_2(4, 0), point_2(4, 4), point_2(2, 2), point_2(0, 4)})},
+   };
+
+   // a comb, reflex at every other vertex, around the ear clipping limit
+   for (size_t teeth : {3, 7, 8, 15, 16}) {
+      vector<point_2> comb = {point_2(0, 0), point_2(2 * double(teeth), 0)};
+      for (size_t i = teeth; i-- != 0;) {
+         comb.push_back(point_2(2 * double(i) + 1, 3));
+         comb.push_back(point_2(2 * double(i), 1));
+      }
+      comb.back() = point_2(0, 3);
+      polys.push_back({contour_2(comb)});
+   }
+
+   // regular polygons are fanned
+   for (size_t n : {5, 6, 40, 1000}) {
+      vector<point_2> pts;
+      for (size_t i = 0; i != n; ++i)
+         pts.push_back(point_2(std::cos(2 * M_PI * i / n), std::sin(2 * M_PI * i / n)));
+      polys.push_back({contour_2(pts)});
+   }
+
+   for (size_t n : {5, 10, 30, 32, 33})
+      polys.push_back({star_contour(n, unsigned(n))});
+
+   triangulation_workspace ws;
+   vector<triangle_2> res;
+   for (const polygon &poly : polys) {
+      if (poly[0].size() <= 40)
+         check_triangulation(poly, triangulate(poly));
+      triangulate(poly, ws, res);
+      EXPECT_EQ(poly[0].size() - 2, res.size());
+      for (const triangle_2 &t : res)
+         EXPECT_EQ(CG_LEFT, orientation(t[0], t[1], t[2]));
+
+      indexed_mesh mesh = triangulate_indexed(poly);
+      ASSERT_EQ(res.size(), mesh.triangles_num());
+      for (size_t i = 0; i != res.size(); ++i)
+         EXPECT_EQ(res[i], mesh.triangle(i));
+   }
+}
+
+TEST(triangulation, batch) {
+   polygon holes = {contour_2({point_2(-200, -200), point_2(200, -200), point_2(200, 200), point_2(-200, 200)}),
+                    contour_2({point_2(-150, 10), point_2(-150, 150), point_2(-10, 150), point_2(-10, 10)}),
+                    contour_2({point_2(10, -150), point_2(10, -10), point_2(150, -10), point_2(150, -150)})};
+   vector<polygon> polys;
+   for (unsigned k = 0; k != 500; ++k) {
+      switch (k % 5) {
+      case 0: polys.push_back({star_contour(4 + k % 60, k)}); break;
+      case 1: polys.push_back(holes); break;
+      case 2: polys.push_back({contour_2({point_2(k, 0), point_2(k + 1, 0), point_2(k + 1, 1), point_2(k, 1)})}); break;
+      case 3: polys.push_back(polygon()); break;
+      default: polys.push_back({star_contour(200, k, false)});
+      }
+   }
+
+   mesh_batch expected;
+   triangulate_batch(polys.begin(), polys.end(), expected, true, 1);
+   ASSERT_EQ(polys.size(), expected.polygons_num());
+   const indexed_mesh &mesh = expected.mesh;
+   size_t contours = 0;
+   for (size_t k = 0; k != polys.size(); ++k) {
+      indexed_mesh single = triangulate_indexed(polys[k], true);
+      uint32_t base = expected.vertex_offsets[k], first = expected.triangle_offsets[k];
+      ASSERT_EQ(single.vertices.size(), expected.vertex_offsets[k + 1] - base);
+      ASSERT_EQ(single.triangles_num(), expected.triangle_offsets[k + 1] - first);
+      EXPECT_TRUE(std::equal(single.vertices.begin(), single.vertices.end(), mesh.vertices.begin() + base));
+      for (size_t i = 0; i != single.indices.size(); ++i)
+         EXPECT_EQ(base + single.indices[i], mesh.indices[3 * first + i]);
+      for (size_t t = 0; t != single.triangles_num(); ++t)
+         EXPECT_EQ(contours + single.triangle_contours[t], mesh.triangle_contours[first + t]);
+      contours += polys[k].size();
+   }
+   EXPECT_EQ(contours, mesh.contours_num());
+
+   // the same layout on any number of threads, warm workspaces reused
+   vector<triangulation_workspace> workspaces;
+   for (size_t threads : {2, 3, 8, 8}) {
+      mesh_batch res;
+      triangulate_batch(polys.begin(), polys.end(), res, workspaces, true, threads);
+      EXPECT_EQ(expected.vertex_offsets, res.vertex_offsets);
+      EXPECT_EQ(expected.triangle_offsets, res.triangle_offsets);
+      EXPECT_EQ(mesh.vertices, res.mesh.vertices);
+      EXPECT_EQ(mesh.indices, res.mesh.indices);
+      EXPECT_EQ(mesh.contour_offsets, res.mesh.contour_offsets);
+      EXPECT_EQ(mesh.triangle_contours, res.mesh.triangle_contours);
+   }
+   EXPECT_EQ(8u, workspaces.size());
+
+   mesh_batch empty;
+   triangulate_batch(polys.begin(), polys.begin(), empty);
+   EXPECT_EQ(0u, empty.polygons_num());
+   EXPECT_EQ(0u, empty.mesh.triangles_num());
+}
+
+// pieces with one local maximum in sweep order, covering the polygon, and
+// their triangulation the same on any number of threads
+void check_monotone_partition(const polygon &poly) {
+   monotone_pieces pieces = monotone_partition(poly);
+   size_t vertices = 0;
+   for (const contour_2 &c : poly) vertices += c.size();
+   ASSERT_EQ(vertices, pieces.points.size());
+   EXPECT_EQ(vertices + 2 * poly.size() - 4, pieces.triangles_num());
+
+   mpq_class area = 0;
+   for (size_t p = 0; p != pieces.pieces_num(); ++p) {
+      size_t maxima = 0, k = pieces.offsets[p + 1] - pieces.offsets[p];
+      ASSERT_GE(k, 3u);
+      vector<point_2> pts;
+      for (size_t l = 0; l != k; ++l) {
+         const point_2 &a = pieces.points[pieces.vertices[pieces.offsets[p] + (l + k - 1) % k]];
+         const point_2 &b = pieces.points[pieces.vertices[pieces.offsets[p] + l]];
+         const point_2 &c = pieces.points[pieces.vertices[pieces.offsets[p] + (l + 1) % k]];
+         maxima += b > a && b > c;
+         pts.push_back(b);
+      }
+      EXPECT_EQ(1u, maxima);
+      polygon piece = {contour_2(pts)};
+      mpq_class s = S(piece);
+      EXPECT_TRUE(s > 0);
+      area += s;
+   }
+   polygon copy = poly;
+   EXPECT_TRUE(S(copy) == area);
+
+   indexed_mesh expected;
+   triangulate_pieces(pieces, expected, true, 1);
+   ASSERT_EQ(pieces.triangles_num(), expected.triangles_num());
+   vector<triangle_2> tris;
+   for (size_t t = 0; t != expected.triangles_num(); ++t)
+      tris.push_back(expected.triangle(t));
+   if (vertices <= 100)
+      check_triangulation(poly, tris);
+   else
+      for (const triangle_2 &t : tris)
+         EXPECT_EQ(CG_LEFT, orientation(t[0], t[1], t[2]));
+
+   for (size_t threads : {2, 7}) {
+      indexed_mesh mesh;
+      triangulate_pieces(pieces, mesh, true, threads);
+      EXPECT_EQ(expected.indices, mesh.indices);
+      EXPECT_EQ(expected.triangle_contours, mesh.triangle_contours);
+   }
+}
+
+TEST(triangulation, monotone_partition) {
+   polygon holes = {contour_2({point_2(-200, -200), point_2(200, -200), point_2(200, 200), point_2(-200, 200)}),
+                    contour_2({point_2(-150, 10), point_2(-150, 150), point_2(-10, 150), point_2(-10, 10)}),
+                    contour_2({point_2(10, -150), point_2(10, -10), point_2(150, -10), point_2(150, -150)})};
+   vector<polygon> polys = {holes, {star_contour(5, 5)}, {star_contour(40, 40)}, {star_contour(20000, 7, false)}};
+   for (size_t teeth : {1, 5, 3000})
+      polys.push_back({comb_contour(teeth)});
+   for (const polygon &poly : polys)
+      check_monotone_partition(poly);
+
+   // a warm workspace gives the same pieces
+   triangulation_workspace ws;
+   monotone_pieces pieces;
+   for (const polygon &poly : polys) {
+      monotone_partition(poly, ws, pieces);
+      monotone_pieces fresh = monotone_partition(poly);
+      EXPECT_EQ(fresh.vertices, pieces.vertices);
+      EXPECT_EQ(fresh.offsets, pieces.offsets);
+      EXPECT_EQ(fresh.contour_offsets, pieces.contour_offsets);
+   }
+}
+
+// a refined mesh covers the polygon with ccw triangles, keeps its vertices
+// first, has its boundary on the contours and meets the bounds
+void check_refined_delaunay(const polygon &poly, double min_angle, double max_area) {
+   indexed_mesh mesh;
+   EXPECT_TRUE(refined_delaunay(poly, mesh, min_angle, max_area));
+
+   vector<segment_2> contours;
+   double area = 0;
+   size_t v = 0;
+   for (const contour_2 &c : poly)
+      for (size_t i = 0; i != c.size(); ++i) {
+         const point_2 &a = c[i], &b = c[(i + 1) % c.size()];
+         contours.push_back(segment_2(a, b));
+         area += (a.x * b.y - a.y * b.x) / 2;
+         EXPECT_EQ(a, mesh.vertices[v++]);
+      }
+
+   double sum = 0;
+   map<pair<uint32_t, uint32_t>, int> edges;
+   for (size_t t = 0; t != mesh.triangles_num(); ++t) {
+      triangle_2 tr = mesh.triangle(t);
+      ASSERT_EQ(CG_LEFT, orientation(tr[0], tr[1], tr[2]));
+      double cross = (tr[1].x - tr[0].x) * (tr[2].y - tr[0].y) - (tr[1].y - tr[0].y) * (tr[2].x - tr[0].x);
+      sum += cross / 2;
+      if (max_area > 0) {
+         EXPECT_LE(cross / 2, max_area);
+      }
+      for (size_t i = 0; i != 3; ++i) {
+         const point_2 &a = tr[i], &b = tr[(i + 1) % 3], &c = tr[(i + 2) % 3];
+         double ux = b.x - a.x, uy = b.y - a.y, vx = c.x - a.x, vy = c.y - a.y;
+         EXPECT_GE(atan2(fabs(ux * vy - uy * vx), ux * vx + uy * vy) * 180 / M_PI, min_angle - 1e-9);
+         uint32_t u = mesh.indices[3 * t + i], w = mesh.indices[3 * t + (i + 1) % 3];
+         ++edges[make_pair(min(u, w), max(u, w))];
+      }
+   }
+   EXPECT_NEAR(area, sum, 1e-9 * area);
+
+   // edges of one triangle lie on a contour, up to the rounding of splits
+   for (const auto &e : edges) {
+      if (e.second != 1)
+         continue;
+      const point_2 &a = mesh.vertices[e.first.first], &b = mesh.vertices[e.first.second];
+      bool on = false;
+      for (const segment_2 &s : contours) {
+         double dx = s[1].x - s[0].x, dy = s[1].y - s[0].y, len = sqrt(dx * dx + dy * dy);
+         double da = fabs(dx * (a.y - s[0].y) - dy * (a.x - s[0].x)) / len;
+         double db = fabs(dx * (b.y - s[0].y) - dy * (b.x - s[0].x)) / len;
+         on = on || (da < 1e-9 * len && db < 1e-9 * len);
+      }
+      EXPECT_TRUE(on);
+   }
+}
+
+TEST(triangulation, refined_delaunay) {
+   polygon holes = {contour_2({point_2(-200, -200), point_2(200, -200), point_2(200, 200), point_2(-200, 200)}),
+                    contour_2({point_2(-150, 10), point_2(-150, 150), point_2(-10, 150), point_2(-10, 10)}),
+                    contour_2({point_2(10, -150), point_2(10, -10), point_2(150, -10), point_2(150, -150)})};
+   polygon thin = {contour_2({point_2(0, 0), point_2(1000, 0), point_2(1000, 1), point_2(0, 1)})};
+   polygon hexagon;
+   vector<point_2> pts;
+   for (size_t i = 0; i != 6; ++i)
+      pts.push_back(point_2(100 * cos(i * M_PI / 3), 100 * sin(i * M_PI / 3)));
+   hexagon.push_back(contour_2(pts));
+
+   for (const polygon *poly : {&holes, &thin, &hexagon}) {
+      check_refined_delaunay(*poly, 20, 0);
+      check_refined_delaunay(*poly, 30, 0);
+      check_refined_delaunay(*poly, 25, 50);
+   }
+
+   // sharp input angles stay, the rest of the mesh is still refined
+   polygon star = {star_contour(50, 4)};
+   check_refined_delaunay(star, 0, 1);
+   indexed_mesh mesh;
+   EXPECT_FALSE(refined_delaunay(star, mesh, 20, 0, 100));
+   EXPECT_EQ(star[0].size() + 100, mesh.vertices.size());
+
+   // a 1 degree wedge: only the triangles at its tip keep a small angle
+   polygon wedge = {contour_2({point_2(0, 0), point_2(100, 0), point_2(100 * cos(M_PI / 180), 100 * sin(M_PI / 180))})};
+   EXPECT_TRUE(refined_delaunay(wedge, mesh, 30));
+   for (size_t t = 0; t != mesh.triangles_num(); ++t) {
+      triangle_2 tr = mesh.triangle(t);
+      bool tip = tr[0] == point_2(0, 0) || tr[1] == point_2(0, 0) || tr[2] == point_2(0, 0);
+      for (size_t i = 0; i != 3 && !tip; ++i) {
+         const point_2 &a = tr[i], &b = tr[(i + 1) % 3], &c = tr[(i + 2) % 3];
+         double ux = b.x - a.x, uy = b.y - a.y, vx = c.x - a.x, vy = c.y - a.y;
+         EXPECT_GE(atan2(fabs(ux * vy - uy * vx), ux * vx + uy * vy) * 180 / M_PI, 30 - 1e-9);
+      }
+   }
+
+   // angles beyond 33 degrees are clamped to it and reported
+   EXPECT_FALSE(refined_delaunay(hexagon, mesh, 40));
+   for (size_t t = 0; t != mesh.triangles_num(); ++t) {
+      triangle_2 tr = mesh.triangle(t);
+      for (size_t i = 0; i != 3; ++i) {
+         const point_2 &a = tr[i], &b = tr[(i + 1) % 3], &c = tr[(i + 2) % 3];
+         double ux = b.x - a.x, uy = b.y - a.y, vx = c.x - a.x, vy = c.y - a.y;
+         EXPECT_GE(atan2(fabs(ux * vy - uy * vx), ux * vx + uy * vy) * 180 / M_PI, 33 - 1e-9);
+      }
+   }
+
+   EXPECT_EQ(0u, refined_delaunay_indexed(polygon()).triangles_num());
+}
+
+// triangles of the in-memory sweep, which triangulate_stream reproduces
+vector<uint32_t> sweep_indices(const polygon &poly) {
+   triangulation_workspace ws;
+   vector<uint32_t> res;
+   auto emit = [&res](uint32_t a, uint32_t b, uint32_t c) {
+      res.push_back(a);
+      res.push_back(b);
+      res.push_back(c);
+   };
+   detail::load_polygon(poly, ws);
+   detail::monotone_sweep<decltype(emit)>(ws, emit).run();
+   return res;
+}
+
+TEST(triangulation, stream) {
+   polygon holes = {contour_2({point_2(-200, -200), point_2(200, -200), point_2(200, 200), point_2(-200, 200)}),
+                    contour_2({point_2(-150, 10), point_2(-150, 150), point_2(-10, 150), point_2(-10, 10)}),
+                    contour_2({point_2(10, -150), point_2(10, -10), point_2(150, -10), point_2(150, -150)})};
+   vector<point_2> comb = {point_2(0, 0), point_2(0, 6000)};
+   for (size_t i = 3000; i-- != 0;) {
+      comb.push_back(point_2(-3, 2 * double(i) + 1));
+      comb.push_back(point_2(-1, 2 * double(i)));
+   }
+   comb.back() = point_2(-3, 0);
+   vector<polygon> polys = {holes, {star_contour(20000, 7, false)}, {contour_2(comb)}};
+
+   for (const polygon &poly : polys) {
+      FILE *in = tmpfile();
+      ASSERT_TRUE(in != nullptr);
+      ASSERT_TRUE(write_polygon(in, poly));
+
+      // in memory, then in sorted runs on disk
+      vector<uint32_t> expected = sweep_indices(poly);
+      for (size_t run_size : {size_t(1) << 20, size_t(1000)}) {
+         rewind(in);
+         vector<uint32_t> res;
+         EXPECT_TRUE(triangulate_stream(in, [&res](uint32_t a, uint32_t b, uint32_t c) {
+            res.push_back(a);
+            res.push_back(b);
+            res.push_back(c);
+         }, run_size));
+         EXPECT_EQ(expected, res);
+      }
+
+      rewind(in);
+      FILE *out = tmpfile();
+      ASSERT_TRUE(out != nullptr);
+      EXPECT_TRUE(triangulate_stream(in, out, 777));
+      rewind(out);
+      vector<uint32_t> written(expected.size() + 1);
+      EXPECT_EQ(expected.size(), fread(written.data(), sizeof(uint32_t), written.size(), out));
+      written.pop_back();
+      EXPECT_EQ(expected, written);
+      fclose(out);
+      fclose(in);
+   }
+
+   // a contour of two vertices and a cut off file
+   FILE *in = tmpfile();
+   ASSERT_TRUE(in != nullptr);
+   polygon two = {contour_2({point_2(0, 0), point_2(1, 0)})};
+   write_polygon(in, two);
+   rewind(in);
+   EXPECT_FALSE(triangulate_stream(in, [](uint32_t, uint32_t, uint32_t) {}));
+   fclose(in);
+
+   in = tmpfile();
+   ASSERT_TRUE(in != nullptr);
+   uint32_t n = 4;
+   double xy[3] = {0, 0, 1};
+   fwrite(&n, sizeof(n), 1, in);
+   fwrite(xy, sizeof(double), 3, in);
+   rewind(in);
+   EXPECT_FALSE(triangulate_stream(in, [](uint32_t, uint32_t, uint32_t) {}));
+   fclose(in);
+}
+
 TEST(triangulation, custom_00) {
    vector<contour_2> poly;
    contour_2 cur0({point_2(-728, 359), point_2(-828, -211), point_2(-574, -46), point_2(-376, -285), point_2(-328, -95), point_2(-358, -403), point_2(-48, 247), point_2(-707, -47)});
    poly.push_back(cur0);
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, custom_1) {
@@ -138,6 +848,8 @@ TEST(triangulation, custom_1) {
    poly.push_back(cur3);
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
+   check_monotone_partition(poly);
 }
 
 TEST(triangulation, custom_2) {
@@ -154,6 +866,8 @@ TEST(triangulation, custom_2) {
    poly.push_back(cur4);
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
+   check_monotone_partition(poly);
 }
 
 TEST(triangulation, custom_3) {
@@ -172,6 +886,7 @@ TEST(triangulation, custom_0) {
    poly.push_back(cur);
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, simple_test) {
@@ -179,6 +894,7 @@ TEST(triangulation, simple_test) {
    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 
@@ -188,238 +904,278 @@ TEST(triangulation, init_test) {
    auto poly = {outer, hole};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_01) {
    contour_2 outer ({ point_2(0, 0), point_2(-1, -1), point_2(1, 0), point_2(-1, 1)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_02) {
    contour_2 outer ({ point_2(0, 0), point_2(1, 0), point_2(0, 1)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_03) {
    contour_2 outer ({ point_2(-1e+06, -1e+06), point_2(1e+06, 42), point_2(-999999, 1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_04) {
    contour_2 outer ({ point_2(1e+06, 1e+06), point_2(999999, -1e+06), point_2(1e+06, 999999)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_05) {
    contour_2 outer ({ point_2(-1e+06, 0), point_2(0, -1), point_2(1e+06, 0), point_2(0, 1)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_06) {
    contour_2 outer ({ point_2(1, 0), point_2(0, 1e+06), point_2(-1, 0), point_2(0, -1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_07) {
    contour_2 outer ({ point_2(-1e+06, 0), point_2(0, -1e+06), point_2(1e+06, 0), point_2(0, 1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_08) {
    contour_2 outer ({ point_2(-1e+06, 1e+06), point_2(-999999, -999998), point_2(-999998, -999999), point_2(1e+06, -1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_09) {
    contour_2 outer ({ point_2(0, 0), point_2(1, 0), point_2(1, 1), point_2(3, 1), point_2(3, 2), point_2(0, 2)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_10) {
    contour_2 outer ({ point_2(1, 0), point_2(1, 999999), point_2(-1, 999999), point_2(-1, 0), point_2(-1e+06, -999999), point_2(-999999, -1e+06), point_2(0, -1), point_2(999999, -1e+06), point_2(1e+06, -999999)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_11) {
    contour_2 outer ({ point_2(-999999, 1e+06), point_2(-1e+06, 999999), point_2(-1, 0), point_2(-1e+06, -999999), point_2(-999999, -1e+06), point_2(0, -1), point_2(999999, -1), point_2(999999, 1), point_2(0, 1)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_12) {
    contour_2 outer ({ point_2(1e+06, 1e+06), point_2(-1e+06, 1e+06), point_2(-1e+06, 999996), point_2(999994, 999996), point_2(-1e+06, -999998), point_2(-999998, -1e+06), point_2(999996, 999994), point_2(999996, -1e+06), point_2(1e+06, -1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_13) {
    contour_2 outer ({ point_2(-1e+06, 1e+06), point_2(-1e+06, 999996), point_2(999994, 999996), point_2(-1e+06, -999998), point_2(-999998, -1e+06), point_2(999996, 999994), point_2(999996, -1e+06), point_2(1e+06, -1e+06), point_2(1e+06, 1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_14) {
    contour_2 outer ({ point_2(0, 0), point_2(1, 1), point_2(2, 0), point_2(1, 2)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_15) {
    contour_2 outer ({ point_2(2, 1), point_2(0, 2), point_2(1, 1), point_2(0, 0)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_16) {
    contour_2 outer ({ point_2(0, -1), point_2(1, 1), point_2(2, 0), point_2(1, 2)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_17) {
    contour_2 outer ({ point_2(2, 1), point_2(0, 2), point_2(1, 1), point_2(-1, 0)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_18) {
    contour_2 outer ({ point_2(-1, -1e+06), point_2(0, 0), point_2(1, -1e+06), point_2(1, 1e+06), point_2(0, 1), point_2(-1, 1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_19) {
    contour_2 outer ({ point_2(1e+06, -1), point_2(1, 0), point_2(1e+06, 1), point_2(-1e+06, 1), point_2(0, 0), point_2(-1e+06, -1)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_20) {
    contour_2 outer ({ point_2(0, 999999), point_2(1, -1e+06), point_2(2, 999999), point_2(2, 1e+06), point_2(1, -999999), point_2(0, 1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_21) {
    contour_2 outer ({ point_2(1e+06, 0), point_2(-999999, 1), point_2(1e+06, 2), point_2(999999, 2), point_2(-1e+06, 1), point_2(999999, 0)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_22) {
    contour_2 outer ({ point_2(1e+06, 1e+06), point_2(-1275, 49), point_2(-1225, 48), point_2(-1176, 47), point_2(-1128, 46), point_2(-1081, 45), point_2(-1035, 44), point_2(-990, 43), point_2(-946, 42), point_2(-903, 41), point_2(-861, 40), point_2(-820, 39), point_2(-780, 38), point_2(-741, 37), point_2(-703, 36), point_2(-666, 35), point_2(-630, 34), point_2(-595, 33), point_2(-561, 32), point_2(-528, 31), point_2(-496, 30), point_2(-465, 29), point_2(-435, 28), point_2(-406, 27), point_2(-378, 26), point_2(-351, 25), point_2(-325, 24), point_2(-300, 23), point_2(-276, 22), point_2(-253, 21), point_2(-231, 20), point_2(-210, 19), point_2(-190, 18), point_2(-171, 17), point_2(-153, 16), point_2(-136, 15), point_2(-120, 14), point_2(-105, 13), point_2(-91, 12), point_2(-78, 11), point_2(-66, 10), point_2(-55, 9), point_2(-45, 8), point_2(-36, 7), point_2(-28, 6), point_2(-21, 5), point_2(-15, 4), point_2(-10, 3), point_2(-6, 2), point_2(-3, 1), point_2(-1, 0), point_2(0, -1), point_2(1, -3), point_2(2, -6), point_2(3, -10), point_2(4, -15), point_2(5, -21), point_2(6, -28), point_2(7, -36), point_2(8, -45), point_2(9, -55), point_2(10, -66), point_2(11, -78), point_2(12, -91), point_2(13, -105), point_2(14, -120), point_2(15, -136), point_2(16, -153), point_2(17, -171), point_2(18, -190), point_2(19, -210), point_2(20, -231), point_2(21, -253), point_2(22, -276), point_2(23, -300), point_2(24, -325), point_2(25, -351), point_2(26, -378), point_2(27, -406), point_2(28, -435), point_2(29, -465), point_2(30, -496), point_2(31, -528), point_2(32, -561), point_2(33, -595), point_2(34, -630), point_2(35, -666), point_2(36, -703), point_2(37, -741), point_2(38, -780), point_2(39, -820), point_2(40, -861), point_2(41, -903), point_2(42, -946), point_2(43, -990), point_2(44, -1035), point_2(45, -1081), point_2(46, -1128), point_2(47, -1176), point_2(48, -1225), point_2(49, -1275)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_23) {
    contour_2 outer ({ point_2(-1275, 49), point_2(-1225, 48), point_2(-1176, 47), point_2(-1128, 46), point_2(-1081, 45), point_2(-1035, 44), point_2(-990, 43), point_2(-946, 42), point_2(-903, 41), point_2(-861, 40), point_2(-820, 39), point_2(-780, 38), point_2(-741, 37), point_2(-703, 36), point_2(-666, 35), point_2(-630, 34), point_2(-595, 33), point_2(-561, 32), point_2(-528, 31), point_2(-496, 30), point_2(-465, 29), point_2(-435, 28), point_2(-406, 27), point_2(-378, 26), point_2(-351, 25), point_2(-325, 24), point_2(-300, 23), point_2(-276, 22), point_2(-253, 21), point_2(-231, 20), point_2(-210, 19), point_2(-190, 18), point_2(-171, 17), point_2(-153, 16), point_2(-136, 15), point_2(-120, 14), point_2(-105, 13), point_2(-91, 12), point_2(-78, 11), point_2(-66, 10), point_2(-55, 9), point_2(-45, 8), point_2(-36, 7), point_2(-28, 6), point_2(-21, 5), point_2(-15, 4), point_2(-10, 3), point_2(-6, 2), point_2(-3, 1), point_2(-1, 0), point_2(0, -1), point_2(1, -3), point_2(2, -6), point_2(3, -10), point_2(4, -15), point_2(5, -21), point_2(6, -28), point_2(7, -36), point_2(8, -45), point_2(9, -55), point_2(10, -66), point_2(11, -78), point_2(12, -91), point_2(13, -105), point_2(14, -120), point_2(15, -136), point_2(16, -153), point_2(17, -171), point_2(18, -190), point_2(19, -210), point_2(20, -231), point_2(21, -253), point_2(22, -276), point_2(23, -300), point_2(24, -325), point_2(25, -351), point_2(26, -378), point_2(27, -406), point_2(28, -435), point_2(29, -465), point_2(30, -496), point_2(31, -528), point_2(32, -561), point_2(33, -595), point_2(34, -630), point_2(35, -666), point_2(36, -703), point_2(37, -741), point_2(38, -780), point_2(39, -820), point_2(40, -861), point_2(41, -903), point_2(42, -946), point_2(43, -990), point_2(44, -1035), point_2(45, -1081), point_2(46, -1128), point_2(47, -1176), point_2(48, -1225), point_2(49, -1275), point_2(1e+06, 1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_30) {
    contour_2 outer ({ point_2(-1e+06, -1e+06), point_2(-999999, 999999), point_2(-999999, 1e+06), point_2(-1e+06, -999999)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_31) {
    contour_2 outer ({ point_2(-999999, -1e+06), point_2(1e+06, -999999), point_2(999999, -999999), point_2(-1e+06, -1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_32) {
    contour_2 outer ({ point_2(-1e+06, -1e+06), point_2(-999999, 999999), point_2(-999998, -1e+06), point_2(-999998, -999999), point_2(-999999, 1e+06), point_2(-1e+06, -999999)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_33) {
    contour_2 outer ({ point_2(-999999, -1e+06), point_2(1e+06, -999999), point_2(-999999, -999998), point_2(-1e+06, -999998), point_2(999999, -999999), point_2(-1e+06, -1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_34) {
    contour_2 outer ({ point_2(-1e+06, -1e+06), point_2(-999999, 999999), point_2(-999998, -1e+06), point_2(-999997, 999999), point_2(-999996, -1e+06), point_2(-999996, -999999), point_2(-999997, 1e+06), point_2(-999998, -999999), point_2(-999999, 1e+06), point_2(-1e+06, -999999)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_35) {
    contour_2 outer ({ point_2(-999999, -1e+06), point_2(1e+06, -999999), point_2(-999999, -999998), point_2(1e+06, -999997), point_2(-999999, -999996), point_2(-1e+06, -999996), point_2(999999, -999997), point_2(-1e+06, -999998), point_2(999999, -999999), point_2(-1e+06, -1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_36) {
    contour_2 outer ({ point_2(-1e+06, -1e+06), point_2(-999999, 999999), point_2(-999998, -1e+06), point_2(-999997, 999999), point_2(-999996, -1e+06), point_2(-999995, 999999), point_2(-999994, -1e+06), point_2(-999994, -999999), point_2(-999995, 1e+06), point_2(-999996, -999999), point_2(-999997, 1e+06), point_2(-999998, -999999), point_2(-999999, 1e+06), point_2(-1e+06, -999999)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_37) {
    contour_2 outer ({ point_2(-999999, -1e+06), point_2(1e+06, -999999), point_2(-999999, -999998), point_2(1e+06, -999997), point_2(-999999, -999996), point_2(1e+06, -999995), point_2(-999999, -999994), point_2(-1e+06, -999994), point_2(999999, -999995), point_2(-1e+06, -999996), point_2(999999, -999997), point_2(-1e+06, -999998), point_2(999999, -999999), point_2(-1e+06, -1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_38) {
    contour_2 outer ({ point_2(-1e+06, -1e+06), point_2(-999999, 999999), point_2(-999998, -1e+06), point_2(-999997, 999999), point_2(-999996, -1e+06), point_2(-999995, 999999), point_2(-999994, -1e+06), point_2(-999993, 999999), point_2(-999992, -1e+06), point_2(-999992, -999999), point_2(-999993, 1e+06), point_2(-999994, -999999), point_2(-999995, 1e+06), point_2(-999996, -999999), point_2(-999997, 1e+06), point_2(-999998, -999999), point_2(-999999, 1e+06), point_2(-1e+06, -999999)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_39) {
    contour_2 outer ({ point_2(-999999, -1e+06), point_2(1e+06, -999999), point_2(-999999, -999998), point_2(1e+06, -999997), point_2(-999999, -999996), point_2(1e+06, -999995), point_2(-999999, -999994), point_2(1e+06, -999993), point_2(-999999, -999992), point_2(-1e+06, -999992), point_2(999999, -999993), point_2(-1e+06, -999994), point_2(999999, -999995), point_2(-1e+06, -999996), point_2(999999, -999997), point_2(-1e+06, -999998), point_2(999999, -999999), point_2(-1e+06, -1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_40) {
    contour_2 outer ({ point_2(-1e+06, -1e+06), point_2(-999999, 999999), point_2(-999998, -1e+06), point_2(-999997, 999999), point_2(-999996, -1e+06), point_2(-999995, 999999), point_2(-999994, -1e+06), point_2(-999993, 999999), point_2(-999992, -1e+06), point_2(-999991, 999999), point_2(-999990, -1e+06), point_2(-999990, -999999), point_2(-999991, 1e+06), point_2(-999992, -999999), point_2(-999993, 1e+06), point_2(-999994, -999999), point_2(-999995, 1e+06), point_2(-999996, -999999), point_2(-999997, 1e+06), point_2(-999998, -999999), point_2(-999999, 1e+06), point_2(-1e+06, -999999)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_41) {
    contour_2 outer ({ point_2(-999999, -1e+06), point_2(1e+06, -999999), point_2(-999999, -999998), point_2(1e+06, -999997), point_2(-999999, -999996), point_2(1e+06, -999995), point_2(-999999, -999994), point_2(1e+06, -999993), point_2(-999999, -999992), point_2(1e+06, -999991), point_2(-999999, -999990), point_2(-1e+06, -999990), point_2(999999, -999991), point_2(-1e+06, -999992), point_2(999999, -999993), point_2(-1e+06, -999994), point_2(999999, -999995), point_2(-1e+06, -999996), point_2(999999, -999997), point_2(-1e+06, -999998), point_2(999999, -999999), point_2(-1e+06, -1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_42) {
    contour_2 outer ({ point_2(-1e+06, -1e+06), point_2(-999999, 999999), point_2(-999998, -1e+06), point_2(-999997, 999999), point_2(-999996, -1e+06), point_2(-999995, 999999), point_2(-999994, -1e+06), point_2(-999993, 999999), point_2(-999992, -1e+06), point_2(-999991, 999999), point_2(-999990, -1e+06), point_2(-999989, 999999), point_2(-999988, -1e+06), point_2(-999987, 999999), point_2(-999986, -1e+06), point_2(-999985, 999999), point_2(-999984, -1e+06), point_2(-999983, 999999), point_2(-999982, -1e+06), point_2(-999981, 999999), point_2(-999980, -1e+06), point_2(-999980, -999999), point_2(-999981, 1e+06), point_2(-999982, -999999), point_2(-999983, 1e+06), point_2(-999984, -999999), point_2(-999985, 1e+06), point_2(-999986, -999999), point_2(-999987, 1e+06), point_2(-999988, -999999), point_2(-999989, 1e+06), point_2(-999990, -999999), point_2(-999991, 1e+06), point_2(-999992, -999999), point_2(-999993, 1e+06), point_2(-999994, -999999), point_2(-999995, 1e+06), point_2(-999996, -999999), point_2(-999997, 1e+06), point_2(-999998, -999999), point_2(-999999, 1e+06), point_2(-1e+06, -999999)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_43) {
    contour_2 outer ({ point_2(-999999, -1e+06), point_2(1e+06, -999999), point_2(-999999, -999998), point_2(1e+06, -999997), point_2(-999999, -999996), point_2(1e+06, -999995), point_2(-999999, -999994), point_2(1e+06, -999993), point_2(-999999, -999992), point_2(1e+06, -999991), point_2(-999999, -999990), point_2(1e+06, -999989), point_2(-999999, -999988), point_2(1e+06, -999987), point_2(-999999, -999986), point_2(1e+06, -999985), point_2(-999999, -999984), point_2(1e+06, -999983), point_2(-999999, -999982), point_2(1e+06, -999981), point_2(-999999, -999980), point_2(-1e+06, -999980), point_2(999999, -999981), point_2(-1e+06, -999982), point_2(999999, -999983), point_2(-1e+06, -999984), point_2(999999, -999985), point_2(-1e+06, -999986), point_2(999999, -999987), point_2(-1e+06, -999988), point_2(999999, -999989), point_2(-1e+06, -999990), point_2(999999, -999991), point_2(-1e+06, -999992), point_2(999999, -999993), point_2(-1e+06, -999994), point_2(999999, -999995), point_2(-1e+06, -999996), point_2(999999, -999997), point_2(-1e+06, -999998), point_2(999999, -999999), point_2(-1e+06, -1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_44) {
    contour_2 outer ({ point_2(-1e+06, -1e+06), point_2(-999999, 999999), point_2(-999998, -1e+06), point_2(-999997, 999999), point_2(-999996, -1e+06), point_2(-999995, 999999), point_2(-999994, -1e+06), point_2(-999993, 999999), point_2(-999992, -1e+06), point_2(-999991, 999999), point_2(-999990, -1e+06), point_2(-999989, 999999), point_2(-999988, -1e+06), point_2(-999987, 999999), point_2(-999986, -1e+06), point_2(-999985, 999999), point_2(-999984, -1e+06), point_2(-999983, 999999), point_2(-999982, -1e+06), point_2(-999981, 999999), point_2(-999980, -1e+06), point_2(-999979, 999999), point_2(-999978, -1e+06), point_2(-999977, 999999), point_2(-999976, -1e+06), point_2(-999975, 999999), point_2(-999974, -1e+06), point_2(-999973, 999999), point_2(-999972, -1e+06), point_2(-999971, 999999), point_2(-999970, -1e+06), point_2(-999969, 999999), point_2(-999968, -1e+06), point_2(-999967, 999999), point_2(-999966, -1e+06), point_2(-999965, 999999), point_2(-999964, -1e+06), point_2(-999963, 999999), point_2(-999962, -1e+06), point_2(-999961, 999999), point_2(-999960, -1e+06), point_2(-999960, -999999), point_2(-999961, 1e+06), point_2(-999962, -999999), point_2(-999963, 1e+06), point_2(-999964, -999999), point_2(-999965, 1e+06), point_2(-999966, -999999), point_2(-999967, 1e+06), point_2(-999968, -999999), point_2(-999969, 1e+06), point_2(-999970, -999999), point_2(-999971, 1e+06), point_2(-999972, -999999), point_2(-999973, 1e+06), point_2(-999974, -999999), point_2(-999975, 1e+06), point_2(-999976, -999999), point_2(-999977, 1e+06), point_2(-999978, -999999), point_2(-999979, 1e+06), point_2(-999980, -999999), point_2(-999981, 1e+06), point_2(-999982, -999999), point_2(-999983, 1e+06), point_2(-999984, -999999), point_2(-999985, 1e+06), point_2(-999986, -999999), point_2(-999987, 1e+06), point_2(-999988, -999999), point_2(-999989, 1e+06), point_2(-999990, -999999), point_2(-999991, 1e+06), point_2(-999992, -999999), point_2(-999993, 1e+06), point_2(-999994, -999999), point_2(-999995, 1e+06), point_2(-999996, -999999), point_2(-999997, 1e+06), point_2(-999998, -999999), point_2(-999999, 1e+06), point_2(-1e+06, -999999)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }
 
 TEST(triangulation, from_kingdom_subdivision_45) {
    contour_2 outer ({ point_2(-999999, -1e+06), point_2(1e+06, -999999), point_2(-999999, -999998), point_2(1e+06, -999997), point_2(-999999, -999996), point_2(1e+06, -999995), point_2(-999999, -999994), point_2(1e+06, -999993), point_2(-999999, -999992), point_2(1e+06, -999991), point_2(-999999, -999990), point_2(1e+06, -999989), point_2(-999999, -999988), point_2(1e+06, -999987), point_2(-999999, -999986), point_2(1e+06, -999985), point_2(-999999, -999984), point_2(1e+06, -999983), point_2(-999999, -999982), point_2(1e+06, -999981), point_2(-999999, -999980), point_2(1e+06, -999979), point_2(-999999, -999978), point_2(1e+06, -999977), point_2(-999999, -999976), point_2(1e+06, -999975), point_2(-999999, -999974), point_2(1e+06, -999973), point_2(-999999, -999972), point_2(1e+06, -999971), point_2(-999999, -999970), point_2(1e+06, -999969), point_2(-999999, -999968), point_2(1e+06, -999967), point_2(-999999, -999966), point_2(1e+06, -999965), point_2(-999999, -999964), point_2(1e+06, -999963), point_2(-999999, -999962), point_2(1e+06, -999961), point_2(-999999, -999960), point_2(-1e+06, -999960), point_2(999999, -999961), point_2(-1e+06, -999962), point_2(999999, -999963), point_2(-1e+06, -999964), point_2(999999, -999965), point_2(-1e+06, -999966), point_2(999999, -999967), point_2(-1e+06, -999968), point_2(999999, -999969), point_2(-1e+06, -999970), point_2(999999, -999971), point_2(-1e+06, -999972), point_2(999999, -999973), point_2(-1e+06, -999974), point_2(999999, -999975), point_2(-1e+06, -999976), point_2(999999, -999977), point_2(-1e+06, -999978), point_2(999999, -999979), point_2(-1e+06, -999980), point_2(999999, -999981), point_2(-1e+06, -999982), point_2(999999, -999983), point_2(-1e+06, -999984), point_2(999999, -999985), point_2(-1e+06, -999986), point_2(999999, -999987), point_2(-1e+06, -999988), point_2(999999, -999989), point_2(-1e+06, -999990), point_2(999999, -999991), point_2(-1e+06, -999992), point_2(999999, -999993), point_2(-1e+06, -999994), point_2(999999, -999995), point_2(-1e+06, -999996), point_2(999999, -999997), point_2(-1e+06, -999998), point_2(999999, -999999), point_2(-1e+06, -1e+06)});    auto poly = {outer};
    vector<triangle_2> v = triangulate(poly);
    check_triangulation(poly, v);
+   check_constrained_delaunay(poly);
 }